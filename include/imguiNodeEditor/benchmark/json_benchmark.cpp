@@ -0,0 +1,292 @@
+//------------------------------------------------------------------------------
+// crude_json benchmark.
+//
+// Parses, queries and dumps documents shaped like node editor settings and
+// counts heap allocations made while doing so. Dump is measured to a string and
+// streamed to a sink, with peak memory of each, and the same document is
+// encoded to and decoded from CBOR. Document is also parsed in-situ, keeping
+// strings and keys in the input, and lazily, where only structure is indexed
+// and settings are opened the way node editor does it, parsing view and few
+// nodes. Then measures parse throughput, regular, in-situ and lazy index, on
+// a large settings file, compact and indented. Built with flat objects
+// (json_benchmark), with std::map objects (json_benchmark_map) and without
+// SIMD scanning (json_benchmark_scalar), so they can be compared on the same
+// machine.
+//
+//   json_benchmark [max node count, default 100000] [throughput file MB, default 50]
+//------------------------------------------------------------------------------
+# include <crude_json.h>
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <cstdio>
+# include <cstdlib>
+# include <new>
+# include <string>
+
+
+//------------------------------------------------------------------------------
+namespace json = crude_json;
+
+// Every allocation is prefixed with its size, so live memory can be tracked.
+static std::atomic<size_t> s_AllocationCount{0};
+static std::atomic<size_t> s_LiveBytes{0};
+static std::atomic<size_t> s_PeakBytes{0};
+
+static const size_t c_AllocationHeader = alignof(std::max_align_t);
+
+void* operator new(size_t size)
+{
+    auto block = static_cast<char*>(malloc(size + c_AllocationHeader));
+    if (!block)
+        throw std::bad_alloc();
+
+    *reinterpret_cast<size_t*>(block) = size;
+    s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    auto live = s_LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    if (live > s_PeakBytes.load(std::memory_order_relaxed))
+        s_PeakBytes.store(live, std::memory_order_relaxed);
+
+    return block + c_AllocationHeader;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (!pointer)
+        return;
+
+    auto block = static_cast<char*>(pointer) - c_AllocationHeader;
+    s_LiveBytes.fetch_sub(*reinterpret_cast<size_t*>(block), std::memory_order_relaxed);
+    free(block);
+}
+
+void* operator new[](size_t size)                { return operator new(size); }
+void  operator delete[](void* pointer) noexcept  { operator delete(pointer); }
+void  operator delete(void* pointer, size_t) noexcept   { operator delete(pointer); }
+void  operator delete[](void* pointer, size_t) noexcept { operator delete(pointer); }
+
+
+//------------------------------------------------------------------------------
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+static double Measure(F&& f, int repeat = 5)
+{
+    double best = 1e30;
+    for (int i = 0; i < repeat; ++i)
+    {
+        auto start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+// Highest live memory above the starting point while 'f' runs.
+template <typename F>
+static size_t MeasurePeak(F&& f)
+{
+    const auto start = s_LiveBytes.load();
+    s_PeakBytes = start;
+    f();
+    return s_PeakBytes.load() - start;
+}
+
+// Discards written text, stands in for a file.
+struct NullSink final: json::sink
+{
+    size_t m_Size = 0;
+
+    bool write(const char*, size_t size) override { m_Size += size; return true; }
+};
+
+// Same layout as settings written by node editor.
+static std::string MakeSettings(int nodeCount)
+{
+    std::string result = "{\"nodes\":{";
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        if (i > 0)
+            result += ',';
+
+        result += "\"node:" + std::to_string(i + 1) + "\":{\"location\":{\"x\":" + std::to_string(i % 100 * 200) + ",\"y\":" + std::to_string(i / 100 * 150) + "}";
+        if (i % 50 == 0)
+            result += ",\"group_size\":{\"x\":400,\"y\":300}";
+        result += '}';
+    }
+    result += "},\"selection\":[\"node:1\",\"node:2\"],\"view\":{\"scroll\":{\"x\":0,\"y\":0},\"zoom\":1,\"visible_rect\":{\"min\":{\"x\":0,\"y\":0},\"max\":{\"x\":1280,\"y\":720}}}}";
+    return result;
+}
+
+static void Run(int nodeCount)
+{
+    const auto data = MakeSettings(nodeCount);
+
+    auto parse = Measure([&data] { auto document = json::value::parse(data); });
+
+    const auto allocationsBefore = s_AllocationCount.load();
+    const auto bytesBefore       = s_LiveBytes.load();
+    auto document = json::value::parse(data);
+    const auto allocations = s_AllocationCount.load() - allocationsBefore;
+    const auto bytes       = s_LiveBytes.load() - bytesBefore;
+
+    // Look up every node by key, the way settings are matched to nodes.
+    std::vector<std::string> keys;
+    keys.reserve(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+        keys.push_back("node:" + std::to_string(i + 1));
+
+    const auto& nodes = document["nodes"].get<json::object>();
+    double sum = 0.0;
+    auto lookup = Measure([&]
+    {
+        for (auto& key : keys)
+            sum += nodes.find(key)->second["location"]["x"].get<double>();
+    });
+
+    auto dump     = Measure([&document] { auto text = document.dump(); });
+    auto dumpPeak = MeasurePeak([&document] { auto text = document.dump(); });
+
+    // Streaming keeps only writer buffer and nesting stack.
+    NullSink sink;
+    auto stream     = Measure([&] { document.dump_to(sink); });
+    auto streamPeak = MeasurePeak([&] { document.dump_to(sink); });
+
+    printf("%6d nodes  %8.2f MB  parse %8.3f ms  %8zu allocations  %8.2f MB live  lookup %7.3f ms  dump %8.3f ms (peak %8.2f MB)  dump_to %8.3f ms (peak %6.2f KB)  (%g)\n",
+        nodeCount, data.size() / (1024.0 * 1024.0), parse, allocations, bytes / (1024.0 * 1024.0), lookup,
+        dump, dumpPeak / (1024.0 * 1024.0), stream, streamPeak / 1024.0, sum);
+
+    // Same document in CBOR.
+    const auto binary = document.dump_cbor();
+    auto encode = Measure([&document] { auto data = document.dump_cbor(); });
+    auto decode = Measure([&binary]
+    {
+        auto decoded = json::value::parse_cbor(binary);
+        if (decoded.is_discarded())
+            abort();
+    });
+
+    auto decodeInSitu = Measure([&binary]
+    {
+        auto decoded = json::document::parse_cbor(binary.data(), binary.size());
+        if (decoded.is_discarded())
+            abort();
+    });
+
+    printf("%6s cbor   %8.2f MB  parse %8.3f ms  in-situ %8.3f ms  dump %8.3f ms\n", "", binary.size() / (1024.0 * 1024.0), decode, decodeInSitu, encode);
+
+    // Input stays with the caller, like a memory mapped file would.
+    auto inSitu = Measure([&data] { auto document = json::document::parse(data.data(), data.size()); });
+
+    const auto inSituAllocationsBefore = s_AllocationCount.load();
+    const auto inSituBytesBefore       = s_LiveBytes.load();
+    auto inSituDocument = json::document::parse(data.data(), data.size());
+    const auto inSituAllocations = s_AllocationCount.load() - inSituAllocationsBefore;
+    const auto inSituBytes       = s_LiveBytes.load() - inSituBytesBefore;
+
+    printf("%6s in-situ           parse %8.3f ms  %8zu allocations  %8.2f MB live\n", "", inSitu, inSituAllocations, inSituBytes / (1024.0 * 1024.0));
+
+    auto lazyIndex = Measure([&data] { auto document = json::lazy_document::parse(data.data(), data.size()); });
+
+    const auto lazyBytesBefore = s_LiveBytes.load();
+    auto lazyDocument = json::lazy_document::parse(data.data(), data.size());
+    const auto lazyBytes = s_LiveBytes.load() - lazyBytesBefore;
+
+    // View is parsed, every node key is read and one node in a hundred is parsed.
+    auto lazyOpen = Measure([&]
+    {
+        auto root = lazyDocument.root();
+        auto view = root["view"].parse();
+
+        int  index = 0;
+        auto nodes = root["nodes"];
+        for (auto it = nodes.begin(), end = nodes.end(); it != end; ++it)
+            if (!it.key().empty() && index++ % 100 == 0)
+                sum += it->parse()["location"]["x"].get<double>();
+    });
+
+    printf("%6s lazy              index %8.3f ms  %8zu structurals  %8.2f MB live  open with 1%% of nodes %8.3f ms\n", "",
+        lazyIndex, lazyDocument.structural_count(), lazyBytes / (1024.0 * 1024.0), lazyOpen);
+}
+
+// Settings with as many nodes as needed to reach 'size' bytes.
+static std::string MakeLargeSettings(size_t size, int indent)
+{
+    std::string result;
+    int nodeCount = 100000;
+    while (true)
+    {
+        result = MakeSettings(nodeCount);
+        if (indent >= 0)
+            result = json::value::parse(result).dump(indent);
+
+        if (result.size() >= size)
+            return result;
+
+        nodeCount = static_cast<int>(nodeCount * (static_cast<double>(size) / result.size()) * 1.01) + 1;
+    }
+}
+
+static void RunThroughput(const char* name, const std::string& data)
+{
+    auto parse = Measure([&data]
+    {
+        auto document = json::value::parse(data);
+        if (document.is_discarded())
+            abort();
+    }, 3);
+
+    auto inSitu = Measure([&data]
+    {
+        auto document = json::document::parse(data.data(), data.size());
+        if (document.is_discarded())
+            abort();
+    }, 3);
+
+    auto lazy = Measure([&data]
+    {
+        auto document = json::lazy_document::parse(data.data(), data.size());
+        if (document.is_discarded())
+            abort();
+    }, 3);
+
+    const auto megabytes = data.size() / (1024.0 * 1024.0);
+    printf("%-8s %8.2f MB  parse %9.3f ms  %8.1f MB/s  in-situ %9.3f ms  %8.1f MB/s  lazy index %9.3f ms  %8.1f MB/s\n", name, megabytes,
+        parse, megabytes / (parse / 1000.0), inSitu, megabytes / (inSitu / 1000.0), lazy, megabytes / (lazy / 1000.0));
+}
+
+// Malformed inputs must be rejected as a whole, not parsed from the middle.
+static void CheckRejected()
+{
+    for (auto text : { "[\"a\\n1]", "{\"k\":\"x\\n2}", "\"a\\ntrue" })
+    {
+        std::string data = text;
+        if (!json::value::parse(data).is_discarded() || !json::document::parse(data.data(), data.size()).is_discarded())
+        {
+            fprintf(stderr, "accepted malformed input: %s\n", text);
+            abort();
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int    maxNodeCount   = argc > 1 ? atoi(argv[1]) : 100000;
+    const size_t throughputSize = static_cast<size_t>(argc > 2 ? atof(argv[2]) : 50.0) * 1024 * 1024;
+
+    printf("objects: %s, sizeof(value): %d, simd: %s\n", CRUDE_JSON_FLAT_OBJECT ? "flat" : "std::map", static_cast<int>(sizeof(json::value)), CRUDE_JSON_SIMD ? "on" : "off");
+
+    CheckRejected();
+
+    for (auto nodeCount : { 1000, 10000, 100000 })
+        if (nodeCount <= maxNodeCount)
+            Run(nodeCount);
+
+    if (throughputSize > 0)
+    {
+        RunThroughput("compact",  MakeLargeSettings(throughputSize, -1));
+        RunThroughput("indented", MakeLargeSettings(throughputSize,  4));
+    }
+
+    return 0;
+}
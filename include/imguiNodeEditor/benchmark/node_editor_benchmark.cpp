@@ -0,0 +1,464 @@
+//------------------------------------------------------------------------------
+// Headless node editor benchmark.
+//
+// Runs node editor with ImGui context without any window or renderer and
+// measures frame phases on synthetic graphs. Results are written as JSON,
+// so runs can be compared across commits.
+//
+//   node_editor_benchmark [output.json] [max node count, default 50000]
+//------------------------------------------------------------------------------
+# define IMGUI_DEFINE_MATH_OPERATORS
+# include <imgui.h>
+# include <imgui_node_editor.h>
+# include <crude_json.h>
+# include <algorithm>
+# include <cfloat>
+# include <chrono>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <random>
+# include <string>
+# include <vector>
+
+
+//------------------------------------------------------------------------------
+namespace ed = ax::NodeEditor;
+
+using Clock = std::chrono::steady_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+
+//------------------------------------------------------------------------------
+// Null renderer, font atlas textures are accepted but never uploaded.
+static void InitializeImGui()
+{
+    ImGui::CreateContext();
+
+    auto& io = ImGui::GetIO();
+    io.IniFilename   = nullptr;
+    io.LogFilename   = nullptr;
+    io.DisplaySize   = ImVec2(1920, 1080);
+    io.DeltaTime     = 1.0f / 60.0f;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures | ImGuiBackendFlags_RendererHasVtxOffset;
+}
+
+static void UpdateTextures()
+{
+    for (auto texture : ImGui::GetPlatformIO().Textures)
+    {
+        if (texture->Status == ImTextureStatus_WantCreate || texture->Status == ImTextureStatus_WantUpdates)
+        {
+            texture->SetTexID((ImTextureID)(intptr_t)1); // any valid id, nothing is drawn
+            texture->SetStatus(ImTextureStatus_OK);
+        }
+        else if (texture->Status == ImTextureStatus_WantDestroy)
+        {
+            texture->SetTexID(ImTextureID_Invalid);
+            texture->SetStatus(ImTextureStatus_Destroyed);
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+struct Graph
+{
+    struct Link
+    {
+        int From;
+        int To;
+    };
+
+    std::string         Name;
+    std::vector<ImVec2> Positions;
+    std::vector<Link>   Links;
+
+    int NodeCount() const { return static_cast<int>(Positions.size()); }
+
+    // Node, its input and output pin and links use disjoint id ranges.
+    static ed::NodeId NodeId(int node)    { return ed::NodeId(static_cast<uintptr_t>(node) * 3 + 1); }
+    static ed::PinId  InputId(int node)   { return ed::PinId(static_cast<uintptr_t>(node) * 3 + 2); }
+    static ed::PinId  OutputId(int node)  { return ed::PinId(static_cast<uintptr_t>(node) * 3 + 3); }
+    static ed::LinkId LinkId(int link)    { return ed::LinkId(static_cast<uintptr_t>(link) + 1); }
+};
+
+static const ImVec2 c_NodeSpacing = ImVec2(200.0f, 100.0f);
+
+// Nodes on a square grid, each linked to right and bottom neighbour.
+static Graph MakeGrid(int nodeCount)
+{
+    Graph graph;
+    graph.Name = "grid";
+
+    const int columns = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(nodeCount))));
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        const int x = i % columns;
+        const int y = i / columns;
+        graph.Positions.push_back(ImVec2(x * c_NodeSpacing.x, y * c_NodeSpacing.y));
+
+        if (x + 1 < columns && i + 1 < nodeCount)
+            graph.Links.push_back({ i, i + 1 });
+        if (i + columns < nodeCount)
+            graph.Links.push_back({ i, i + columns });
+    }
+
+    return graph;
+}
+
+// Every node links to two random nodes created after it.
+static Graph MakeRandomDag(int nodeCount)
+{
+    Graph graph;
+    graph.Name = "random_dag";
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(0.0f, std::sqrt(static_cast<float>(nodeCount)) * c_NodeSpacing.x);
+
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        graph.Positions.push_back(ImVec2(position(random), position(random)));
+
+        for (int j = 0; j < 2 && i + 1 < nodeCount; ++j)
+        {
+            std::uniform_int_distribution<int> target(i + 1, nodeCount - 1);
+            graph.Links.push_back({ i, target(random) });
+        }
+    }
+
+    return graph;
+}
+
+// Columns of 32 nodes, each node linked to 8 nodes of the next column. Links
+// overlap heavily, which stresses link hit testing and drawing.
+static Graph MakeDenseBundles(int nodeCount)
+{
+    Graph graph;
+    graph.Name = "dense_bundles";
+
+    const int columnSize = 32;
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        const int column = i / columnSize;
+        const int row    = i % columnSize;
+        graph.Positions.push_back(ImVec2(column * c_NodeSpacing.x * 2.0f, row * c_NodeSpacing.y));
+
+        const int next = (column + 1) * columnSize;
+        for (int j = 0; j < 8; ++j)
+        {
+            const int target = next + (row + j * 4) % columnSize;
+            if (target < nodeCount)
+                graph.Links.push_back({ i, target });
+        }
+    }
+
+    return graph;
+}
+
+
+//------------------------------------------------------------------------------
+static const int c_PhaseCount = static_cast<int>(ed::ProfilerPhase::Count);
+
+struct FrameTimes
+{
+    double Begin      = 0.0;
+    double Submission = 0.0;
+    double End        = 0.0;
+    double Frame      = 0.0;
+    double Phases[c_PhaseCount] = {}; // as reported by editor profiler
+};
+
+struct Benchmark
+{
+    const Graph&       m_Graph;
+    ed::EditorContext* m_Editor = nullptr;
+    Clock::time_point  m_SaveStart;
+    double             m_SaveMs = 0.0;
+    size_t             m_SaveSize = 0;
+    bool               m_ShowMinimap = false;
+
+    explicit Benchmark(const Graph& graph)
+        : m_Graph(graph)
+    {
+        ed::Config config;
+        config.SettingsFile     = nullptr;
+        config.UserPointer      = this;
+        config.BeginSaveSession = [](void* userPointer)
+        {
+            static_cast<Benchmark*>(userPointer)->m_SaveStart = Clock::now();
+        };
+        config.EndSaveSession   = [](void* userPointer)
+        {
+            auto self = static_cast<Benchmark*>(userPointer);
+            self->m_SaveMs += ElapsedMs(self->m_SaveStart);
+        };
+        config.SaveSettings     = [](const char*, size_t size, ed::SaveReasonFlags, void* userPointer)
+        {
+            static_cast<Benchmark*>(userPointer)->m_SaveSize = size;
+            return true;
+        };
+        config.LoadSettings     = [](char*, void*) -> size_t { return 0; };
+
+        m_Editor = ed::CreateEditor(&config);
+
+        ed::SetCurrentEditor(m_Editor);
+        for (int i = 0; i < m_Graph.NodeCount(); ++i)
+            ed::SetNodePosition(Graph::NodeId(i), m_Graph.Positions[i]);
+        ed::SetCurrentEditor(nullptr);
+    }
+
+    ~Benchmark()
+    {
+        ed::DestroyEditor(m_Editor);
+    }
+
+    FrameTimes Frame()
+    {
+        FrameTimes times;
+
+        const auto frameStart = Clock::now();
+
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0, 0));
+        ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+        ImGui::Begin("Benchmark", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+
+        ed::SetCurrentEditor(m_Editor);
+
+        auto start = Clock::now();
+        ed::Begin("Editor");
+        times.Begin = ElapsedMs(start);
+
+        start = Clock::now();
+        for (int i = 0; i < m_Graph.NodeCount(); ++i)
+        {
+            ed::BeginNode(Graph::NodeId(i));
+            ImGui::TextUnformatted("Node");
+            ed::BeginPin(Graph::InputId(i), ed::PinKind::Input);
+            ImGui::TextUnformatted("->");
+            ed::EndPin();
+            ImGui::SameLine();
+            ed::BeginPin(Graph::OutputId(i), ed::PinKind::Output);
+            ImGui::TextUnformatted("->");
+            ed::EndPin();
+            ed::EndNode();
+        }
+
+        for (int i = 0; i < static_cast<int>(m_Graph.Links.size()); ++i)
+        {
+            auto& link = m_Graph.Links[i];
+            ed::Link(Graph::LinkId(i), Graph::OutputId(link.From), Graph::InputId(link.To));
+        }
+        if (m_ShowMinimap)
+            ed::ShowMinimap();
+        times.Submission = ElapsedMs(start);
+
+        start = Clock::now();
+        ed::End();
+        times.End = ElapsedMs(start);
+
+        const auto stats = ed::GetProfilerStats();
+        for (int i = 0; i < c_PhaseCount; ++i)
+            times.Phases[i] = stats.Phases[i].Last;
+
+        ed::SetCurrentEditor(nullptr);
+
+        ImGui::End();
+        ImGui::Render();
+        UpdateTextures();
+
+        times.Frame = ElapsedMs(frameStart);
+
+        return times;
+    }
+
+    FrameTimes Frames(int count)
+    {
+        FrameTimes total;
+        for (int i = 0; i < count; ++i)
+        {
+            auto times = Frame();
+            total.Begin      += times.Begin;
+            total.Submission += times.Submission;
+            total.End        += times.End;
+            total.Frame      += times.Frame;
+            for (int j = 0; j < c_PhaseCount; ++j)
+                total.Phases[j] += times.Phases[j];
+        }
+
+        total.Begin      /= count;
+        total.Submission /= count;
+        total.End        /= count;
+        total.Frame      /= count;
+        for (int j = 0; j < c_PhaseCount; ++j)
+            total.Phases[j] /= count;
+        return total;
+    }
+
+    template <typename F>
+    void WithEditor(F&& f)
+    {
+        ed::SetCurrentEditor(m_Editor);
+        f();
+        ed::SetCurrentEditor(nullptr);
+    }
+};
+
+static crude_json::value ToJson(const FrameTimes& times)
+{
+    crude_json::value result;
+    result["begin_ms"]      = times.Begin;
+    result["submission_ms"] = times.Submission;
+    result["end_ms"]        = times.End;
+    result["frame_ms"]      = times.Frame;
+
+    auto& phases = result["phases_ms"];
+    for (int i = 0; i < c_PhaseCount; ++i)
+        phases[ed::GetProfilerPhaseName(static_cast<ed::ProfilerPhase>(i))] = times.Phases[i];
+
+    return result;
+}
+
+static crude_json::value Run(const Graph& graph)
+{
+    const int frameCount = 8;
+
+    crude_json::value result;
+    result["graph"] = graph.Name;
+    result["nodes"] = static_cast<double>(graph.NodeCount());
+    result["links"] = static_cast<double>(graph.Links.size());
+
+    Benchmark benchmark(graph);
+
+    // First frames create nodes and pins and measure their sizes.
+    auto start = Clock::now();
+    benchmark.Frame();
+    benchmark.Frame();
+    result["creation_ms"] = ElapsedMs(start);
+
+    result["frame"] = ToJson(benchmark.Frames(frameCount));
+
+    // Selection of every node.
+    start = Clock::now();
+    benchmark.WithEditor([&graph]
+    {
+        for (int i = 0; i < graph.NodeCount(); ++i)
+            ed::SelectNode(Graph::NodeId(i), true);
+    });
+    result["select_all_ms"] = ElapsedMs(start);
+    result["frame_all_selected"] = ToJson(benchmark.Frames(frameCount));
+    benchmark.WithEditor([] { ed::ClearSelection(); });
+    benchmark.Frame();
+
+    // Drag first node with fake mouse input.
+    {
+        ImVec2 from;
+        benchmark.WithEditor([&from]
+        {
+            from = ed::CanvasToScreen(ed::GetNodePosition(Graph::NodeId(0)) + ed::GetNodeSize(Graph::NodeId(0)) * 0.5f);
+        });
+
+        auto& io = ImGui::GetIO();
+        io.AddMousePosEvent(from.x, from.y);
+        benchmark.Frame();
+        io.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
+        benchmark.Frame();
+
+        FrameTimes total;
+        for (int i = 1; i <= frameCount; ++i)
+        {
+            io.AddMousePosEvent(from.x + i * 8.0f, from.y + i * 4.0f);
+            auto times = benchmark.Frame();
+            total.Begin      += times.Begin      / frameCount;
+            total.Submission += times.Submission / frameCount;
+            total.End        += times.End        / frameCount;
+            total.Frame      += times.Frame      / frameCount;
+            for (int j = 0; j < c_PhaseCount; ++j)
+                total.Phases[j] += times.Phases[j] / frameCount;
+        }
+
+        io.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+        benchmark.Frame();
+        io.AddMousePosEvent(-FLT_MAX, -FLT_MAX);
+        benchmark.Frame();
+
+        result["frame_dragging"] = ToJson(total);
+    }
+
+    // Settings save with every node dirty.
+    benchmark.WithEditor([&graph]
+    {
+        for (int i = 0; i < graph.NodeCount(); ++i)
+            ed::SetNodePosition(Graph::NodeId(i), graph.Positions[i] + ImVec2(1.0f, 1.0f));
+    });
+    benchmark.m_SaveMs = 0.0;
+    benchmark.Frame();
+    result["save_all_ms"]    = benchmark.m_SaveMs;
+    result["settings_bytes"] = static_cast<double>(benchmark.m_SaveSize);
+
+    // Whole graph in view, nothing is culled by clipping.
+    benchmark.WithEditor([] { ed::NavigateToContent(0.0f); });
+    benchmark.Frames(2);
+    result["frame_all_visible"] = ToJson(benchmark.Frames(frameCount));
+
+    // Minimap over the same view, first frame builds its cache.
+    benchmark.m_ShowMinimap = true;
+    start = Clock::now();
+    benchmark.Frame();
+    result["minimap_build_ms"] = ElapsedMs(start);
+    result["frame_minimap"]    = ToJson(benchmark.Frames(frameCount));
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const char* outputPath   = argc > 1 ? argv[1] : "node_editor_benchmark.json";
+    const int   maxNodeCount = argc > 2 ? atoi(argv[2]) : 50000;
+
+    InitializeImGui();
+
+    crude_json::value results{crude_json::type_t::array};
+
+    for (auto nodeCount : { 1000, 10000, 50000 })
+    {
+        if (nodeCount > maxNodeCount)
+            continue;
+
+        for (auto make : { MakeGrid, MakeRandomDag, MakeDenseBundles })
+        {
+            auto graph  = make(nodeCount);
+            auto result = Run(graph);
+
+            printf("%-14s %6d nodes  creation %9.2f ms  frame %8.2f ms  all visible %8.2f ms  dragging %8.2f ms  save %8.2f ms\n",
+                graph.Name.c_str(), graph.NodeCount(),
+                result["creation_ms"].get<double>(),
+                result["frame"]["frame_ms"].get<double>(),
+                result["frame_all_visible"]["frame_ms"].get<double>(),
+                result["frame_dragging"]["frame_ms"].get<double>(),
+                result["save_all_ms"].get<double>());
+
+            results.push_back(std::move(result));
+        }
+    }
+
+    ImGui::DestroyContext();
+
+    crude_json::value document;
+    document["imgui"]   = IMGUI_VERSION;
+    document["editor"]  = IMGUI_NODE_EDITOR_VERSION;
+    document["results"] = std::move(results);
+
+    if (!document.save(outputPath, 4))
+    {
+        fprintf(stderr, "Failed to write '%s'.\n", outputPath);
+        return 1;
+    }
+
+    return 0;
+}
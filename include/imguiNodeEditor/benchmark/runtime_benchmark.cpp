@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+// Runtime::Graph execution benchmark.
+//
+// Builds synthetic wide (many independent branches) and deep (long chains)
+// graphs and measures full and incremental execution, serial and on a pool.
+//
+//   node_runtime_benchmark [work per node, default 2000] [workers, default hardware threads]
+//------------------------------------------------------------------------------
+# include <imgui_node_editor_runtime.h>
+# include <algorithm>
+# include <chrono>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+
+
+//------------------------------------------------------------------------------
+namespace ed = ax::NodeEditor;
+namespace rt = ax::NodeEditor::Runtime;
+
+static int s_WorkPerNode = 2000;
+
+
+//------------------------------------------------------------------------------
+// Sums inputs and burns some cycles, so scheduling overhead is not all we measure.
+static void Work(rt::ExecutionContext& context)
+{
+    double sum = 0.0;
+    for (int i = 0; i < context.GetInputCount(); ++i)
+        for (int j = 0; j < context.GetInputLinkCount(i); ++j)
+            sum += std::any_cast<double>(*context.GetInput(i, j));
+
+    double x = sum;
+    for (int i = 0; i < s_WorkPerNode; ++i)
+        x = std::sin(x + i);
+
+    for (int i = 0; i < context.GetOutputCount(); ++i)
+        context.GetOutput(i) = sum + x;
+}
+
+struct GraphBuilder
+{
+    rt::Graph& Graph;
+    uintptr_t  NextId = 1;
+
+    // Node with single input and single output, returns output pin.
+    ed::PinId AddNode(ed::PinId source, ed::NodeId* nodeId = nullptr, ed::PinId* input = nullptr)
+    {
+        ed::NodeId node    = NextId++;
+        ed::PinId  inPin   = NextId++;
+        ed::PinId  outPin  = NextId++;
+
+        Graph.AddNode(node, Work);
+        Graph.AddPin(node, inPin, ed::PinKind::Input);
+        Graph.AddPin(node, outPin, ed::PinKind::Output);
+        if (source)
+            Graph.AddLink(ed::LinkId(NextId++), source, inPin);
+
+        if (nodeId) *nodeId = node;
+        if (input)  *input  = inPin;
+        return outPin;
+    }
+};
+
+// One source fanning out to 'width' chains of 'depth' nodes, joined by one sink.
+static void BuildGraph(rt::Graph& graph, int width, int depth, ed::NodeId& source)
+{
+    GraphBuilder builder{ graph };
+
+    auto sourcePin = builder.AddNode(ed::PinId(), &source);
+
+    ed::PinId sinkInput;
+    builder.AddNode(ed::PinId(), nullptr, &sinkInput);
+
+    for (int i = 0; i < width; ++i)
+    {
+        auto pin = sourcePin;
+        for (int j = 0; j < depth; ++j)
+            pin = builder.AddNode(pin);
+
+        graph.AddLink(ed::LinkId(builder.NextId++), pin, sinkInput);
+    }
+}
+
+template <typename F>
+static double Measure(F&& f, int repeat = 5)
+{
+    double best = 1e30;
+    for (int i = 0; i < repeat; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+static void Run(const char* name, int width, int depth, rt::ThreadPool& pool)
+{
+    rt::Graph  graph;
+    ed::NodeId source;
+    BuildGraph(graph, width, depth, source);
+
+    auto compile = Measure([&]
+    {
+        graph.MarkAllDirty();
+        graph.AddNode(ed::NodeId(~uintptr_t(0)), nullptr); // force recompilation
+        graph.RemoveNode(ed::NodeId(~uintptr_t(0)));
+        graph.Compile();
+    });
+
+    auto serial = Measure([&]
+    {
+        graph.MarkAllDirty();
+        graph.Execute();
+    });
+
+    auto parallel = Measure([&]
+    {
+        graph.MarkAllDirty();
+        graph.Execute(&pool);
+    });
+
+    // Touch one node in the middle of first chain, only its chain tail and sink run.
+    const auto& order = graph.GetOrder();
+    auto edited = order[order.size() / 2];
+    int executed = 0;
+    auto incremental = Measure([&]
+    {
+        graph.MarkDirty(edited);
+        executed = graph.Execute(&pool);
+    });
+
+    printf("%-6s %6d nodes  compile %8.3f ms  serial %9.3f ms  parallel %9.3f ms (x%.2f)  incremental %8.3f ms (%d nodes)\n",
+        name, graph.GetNodeCount(), compile, serial, parallel, serial / parallel, incremental, executed);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+        s_WorkPerNode = std::max(0, atoi(argv[1]));
+
+    rt::ThreadPool pool(argc > 2 ? atoi(argv[2]) : 0);
+    printf("workers: %d, work per node: %d\n", pool.GetWorkerCount(), s_WorkPerNode);
+
+    Run("wide",   10000,     1, pool);
+    Run("wide",    1000,    10, pool);
+    Run("deep",       4,  2500, pool);
+    Run("deep",       1, 10000, pool);
+
+    return 0;
+}
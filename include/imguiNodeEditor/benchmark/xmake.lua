@@ -0,0 +1,25 @@
+
+target("node_runtime_benchmark")
+    set_kind("binary")
+    add_deps("imguiNodeEditor")
+    add_files("runtime_benchmark.cpp")
+
+target("node_editor_benchmark")
+    set_kind("binary")
+    add_deps("imguiNodeEditor")
+    add_files("node_editor_benchmark.cpp")
+
+-- crude_json is compiled into each target, so its configurations can be compared.
+target("json_benchmark")
+    set_kind("binary")
+    add_files("json_benchmark.cpp", "../crude_json.cpp")
+
+target("json_benchmark_map")
+    set_kind("binary")
+    add_defines("CRUDE_JSON_FLAT_OBJECT=0")
+    add_files("json_benchmark.cpp", "../crude_json.cpp")
+
+target("json_benchmark_scalar")
+    set_kind("binary")
+    add_defines("CRUDE_JSON_SIMD=0")
+    add_files("json_benchmark.cpp", "../crude_json.cpp")
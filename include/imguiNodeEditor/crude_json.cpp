@@ -16,6 +16,29 @@
 # include <clocale>
 # include <cmath>
 # include <cstring>
+# include <deque>
+# include <new>
+# include <bit>
+# include <charconv>
+
+# if CRUDE_JSON_SIMD
+#     if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#         define CRUDE_JSON_SSE2 1
+#         include <emmintrin.h>
+#     elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#         define CRUDE_JSON_NEON 1
+#         include <arm_neon.h>
+#     endif
+# endif
+
+// Floating point std::from_chars is locale independent. Standard libraries
+// missing it fall back to strtod, parsing is then done in "C" locale.
+# if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#     define CRUDE_JSON_FROM_CHARS 1
+# else
+#     define CRUDE_JSON_FROM_CHARS 0
+# endif
+
 # if CRUDE_JSON_IO
 #     include <stdio.h>
 #     include <memory>
@@ -23,9 +46,367 @@
 
 namespace crude_json {
 
+arena* arena::create()
+{
+    return new arena();
+}
+
+arena::~arena()
+{
+    while (m_Blocks)
+    {
+        auto next = m_Blocks->m_Next;
+        ::operator delete(m_Blocks);
+        m_Blocks = next;
+    }
+
+    if (m_Release)
+        m_Release(m_User);
+}
+
+void arena::retain()
+{
+    m_RefCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void arena::release()
+{
+    if (m_RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+void* arena::allocate(size_t size, size_t alignment)
+{
+    auto align = [alignment](char* pointer)
+    {
+        auto address = reinterpret_cast<uintptr_t>(pointer);
+        return reinterpret_cast<char*>((address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+    };
+
+    auto result = m_Cursor ? align(m_Cursor) : nullptr;
+    if (!result || result + size > m_End)
+    {
+        // Blocks grow with the document, so large documents need few of them.
+        static const size_t min_block_size = 4 * 1024;
+        static const size_t max_block_size = 1024 * 1024;
+
+        auto block_size = std::min(std::max(m_Reserved, min_block_size), max_block_size);
+        block_size = std::max(block_size, size + alignment + sizeof(block));
+
+        auto new_block = static_cast<block*>(::operator new(block_size));
+        new_block->m_Next = m_Blocks;
+        m_Blocks    = new_block;
+        m_Cursor    = reinterpret_cast<char*>(new_block) + sizeof(block);
+        m_End       = reinterpret_cast<char*>(new_block) + block_size;
+        m_Reserved += block_size;
+
+        result = align(m_Cursor);
+    }
+
+    m_Cursor = result + size;
+
+    return result;
+}
+
+void arena::adopt(string&& text)
+{
+    CRUDE_ASSERT(!m_Input);
+    m_Text      = std::move(text);
+    m_Input     = m_Text.data();
+    m_InputSize = m_Text.size();
+}
+
+void arena::adopt(const char* data, size_t size, void (*release)(void* user), void* user)
+{
+    CRUDE_ASSERT(!m_Input);
+    m_Input     = data;
+    m_InputSize = size;
+    m_Release   = release;
+    m_User      = user;
+}
+
+# if CRUDE_JSON_FLAT_OBJECT
+uint32_t object_key::hash(std::string_view key)
+{
+    // FNV-1a
+    uint32_t result = 2166136261u;
+    for (auto c : key)
+    {
+        result ^= static_cast<uint8_t>(c);
+        result *= 16777619u;
+    }
+    return result;
+}
+
+object::object(arena* memory)
+    : m_Arena(memory)
+{
+    if (m_Arena)
+        m_Arena->retain();
+}
+
+object::object(const object& other)
+{
+    reserve(other.m_Size);
+    for (auto& entry : other)
+        append(entry.first, entry.first.hash(), value(entry.second));
+}
+
+object::object(object&& other) noexcept
+    : m_Data(other.m_Data)
+    , m_Size(other.m_Size)
+    , m_Capacity(other.m_Capacity)
+    , m_Index(other.m_Index)
+    , m_Arena(other.m_Arena)
+{
+    other.m_Data     = nullptr;
+    other.m_Size     = 0;
+    other.m_Capacity = 0;
+    other.m_Index    = nullptr;
+    other.m_Arena    = nullptr;
+}
+
+object::~object()
+{
+    clear();
+    deallocate(m_Data);
+    deallocate(m_Index);
+
+    if (m_Arena)
+        m_Arena->release();
+}
+
+object& object::operator=(const object& other)
+{
+    if (this != &other)
+        object(other).swap(*this);
+    return *this;
+}
+
+object& object::operator=(object&& other) noexcept
+{
+    if (this != &other)
+        object(std::move(other)).swap(*this);
+    return *this;
+}
+
+object::iterator object::find(std::string_view key)
+{
+    auto index = find_index(key, object_key::hash(key));
+    return index != npos ? m_Data + index : end();
+}
+
+object::const_iterator object::find(std::string_view key) const
+{
+    auto index = find_index(key, object_key::hash(key));
+    return index != npos ? m_Data + index : end();
+}
+
+value& object::operator[](std::string_view key)
+{
+    auto hash  = object_key::hash(key);
+    auto index = find_index(key, hash);
+    if (index != npos)
+        return m_Data[index].second;
+
+    return append(key, hash, value())->second;
+}
+
+std::pair<object::iterator, bool> object::emplace(std::string_view key, value&& v)
+{
+    auto hash  = object_key::hash(key);
+    auto index = find_index(key, hash);
+    if (index != npos)
+        return { m_Data + index, false };
+
+    return { append(key, hash, std::move(v)), true };
+}
+
+object::iterator object::erase(const_iterator position)
+{
+    auto index = static_cast<uint32_t>(position - m_Data);
+    CRUDE_ASSERT(index < m_Size);
+
+    deallocate(const_cast<char*>(m_Data[index].first.m_Data));
+
+    // Keep insertion order of remaining members.
+    for (auto i = index + 1; i < m_Size; ++i)
+        m_Data[i - 1] = std::move(m_Data[i]);
+
+    m_Data[--m_Size].~value_type();
+
+    if (m_Index)
+        rebuild_index();
+
+    return m_Data + index;
+}
+
+size_t object::erase(std::string_view key)
+{
+    auto it = find(key);
+    if (it == end())
+        return 0;
+
+    erase(it);
+
+    return 1;
+}
+
+void object::clear()
+{
+    for (uint32_t i = 0; i < m_Size; ++i)
+    {
+        deallocate(const_cast<char*>(m_Data[i].first.m_Data));
+        m_Data[i].~value_type();
+    }
+
+    m_Size = 0;
+
+    if (m_Index)
+        rebuild_index();
+}
+
+void object::reserve(size_t capacity)
+{
+    if (capacity <= m_Capacity)
+        return;
+
+    auto new_capacity = capacity;
+
+    auto data = static_cast<value_type*>(allocate(new_capacity * sizeof(value_type), alignof(value_type)));
+    for (uint32_t i = 0; i < m_Size; ++i)
+    {
+        new (data + i) value_type(std::move(m_Data[i]));
+        m_Data[i].~value_type();
+    }
+
+    deallocate(m_Data);
+    m_Data     = data;
+    m_Capacity = static_cast<uint32_t>(new_capacity);
+
+    if (m_Capacity > hash_threshold)
+    {
+        deallocate(m_Index);
+        m_Index = static_cast<uint32_t*>(allocate(index_size() * sizeof(uint32_t), alignof(uint32_t)));
+        rebuild_index();
+    }
+}
+
+void object::swap(object& other) noexcept
+{
+    std::swap(m_Data,     other.m_Data);
+    std::swap(m_Size,     other.m_Size);
+    std::swap(m_Capacity, other.m_Capacity);
+    std::swap(m_Index,    other.m_Index);
+    std::swap(m_Arena,    other.m_Arena);
+}
+
+void* object::allocate(size_t size, size_t alignment)
+{
+    if (m_Arena)
+        return m_Arena->allocate(size, alignment);
+    else
+        return ::operator new(size);
+}
+
+void object::deallocate(void* pointer)
+{
+    // Arena memory is released with the arena.
+    if (!m_Arena)
+        ::operator delete(pointer);
+}
+
+object::iterator object::append(std::string_view key, uint32_t hash, value&& v)
+{
+    if (m_Size == m_Capacity)
+        reserve(m_Capacity ? 2 * m_Capacity : 4);
+
+    // Keys from input of in-situ parsed document are kept as they are.
+    auto data = key.data();
+    if (!m_Arena || !m_Arena->in_input(data))
+    {
+        auto copy = static_cast<char*>(allocate(key.size(), 1));
+        memcpy(copy, key.data(), key.size());
+        data = copy;
+    }
+
+    object_key new_key;
+    new_key.m_Data = data;
+    new_key.m_Size = static_cast<uint32_t>(key.size());
+    new_key.m_Hash = hash;
+
+    auto result = new (m_Data + m_Size) value_type(new_key, std::move(v));
+    ++m_Size;
+
+    if (m_Index)
+        insert_index(m_Size - 1);
+
+    return result;
+}
+
+size_t object::find_index(std::string_view key, uint32_t hash) const
+{
+    if (m_Index)
+    {
+        const auto mask = index_size() - 1;
+        for (auto slot = hash & mask; m_Index[slot]; slot = (slot + 1) & mask)
+        {
+            auto& entry = m_Data[m_Index[slot] - 1];
+            if (entry.first.m_Hash == hash && entry.first == key)
+                return m_Index[slot] - 1;
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < m_Size; ++i)
+            if (m_Data[i].first.m_Hash == hash && m_Data[i].first == key)
+                return i;
+    }
+
+    return npos;
+}
+
+void object::insert_index(uint32_t index)
+{
+    const auto mask = index_size() - 1;
+
+    auto slot = m_Data[index].first.m_Hash & mask;
+    while (m_Index[slot])
+        slot = (slot + 1) & mask;
+
+    m_Index[slot] = index + 1;
+}
+
+uint32_t object::index_size() const
+{
+    // Power of two with at least half of the slots empty.
+    uint32_t result = 1;
+    while (result < 2 * m_Capacity)
+        result *= 2;
+    return result;
+}
+
+void object::rebuild_index()
+{
+    memset(m_Index, 0, index_size() * sizeof(uint32_t));
+    for (uint32_t i = 0; i < m_Size; ++i)
+        insert_index(i);
+}
+# endif
+
 value::value(value&& other)
     : m_Type(other.m_Type)
+    , m_IsView(other.m_IsView)
 {
+    if (m_IsView)
+    {
+        // Reference to the input changes hands.
+        *string_ref_ptr(m_Storage) = *string_ref_ptr(other.m_Storage);
+        other.m_Type   = type_t::null;
+        other.m_IsView = false;
+        return;
+    }
+
     switch (m_Type)
     {
         case type_t::object:    construct(m_Storage, std::move( *object_ptr(other.m_Storage))); break;
@@ -35,13 +416,21 @@ value::value(value&& other)
         case type_t::number:    construct(m_Storage, std::move( *number_ptr(other.m_Storage))); break;
         default: break;
     }
-    destruct(other.m_Storage, other.m_Type);
+    destruct(other.m_Storage, other.m_Type, false);
     other.m_Type = type_t::null;
 }
 
 value::value(const value& other)
     : m_Type(other.m_Type)
+    , m_IsView(other.m_IsView)
 {
+    if (m_IsView)
+    {
+        *string_ref_ptr(m_Storage) = *string_ref_ptr(other.m_Storage);
+        string_ref_ptr(m_Storage)->m_Owner->retain();
+        return;
+    }
+
     switch (m_Type)
     {
         case type_t::object:    construct(m_Storage,  *object_ptr(other.m_Storage)); break;
@@ -172,7 +561,7 @@ void value::swap(value& other)
 {
     using std::swap;
 
-    if (m_Type == other.m_Type)
+    if (m_Type == other.m_Type && !m_IsView && !other.m_IsView)
     {
         switch (m_Type)
         {
@@ -194,174 +583,545 @@ void value::swap(value& other)
     }
 }
 
+std::string_view value::view() const
+{
+    CRUDE_ASSERT(m_Type == type_t::string);
+
+    if (m_IsView)
+    {
+        auto ref = string_ref_ptr(m_Storage);
+        if (!ref->m_Escaped)
+            return std::string_view(ref->m_Data, ref->m_Size);
+
+        const_cast<value*>(this)->own_string();
+    }
+
+    return *string_ptr(m_Storage);
+}
+
 string value::dump(const int indent, const char indent_char) const
 {
-    dump_context_t context(indent, indent_char);
+    string result;
+    buffer_sink out(result);
+    dump_to(out, indent, indent_char);
+    return result;
+}
 
-    context.out.precision(std::numeric_limits<double>::max_digits10 + 1);
-    context.out << std::defaultfloat;
+bool value::dump_to(sink& out, const int indent, const char indent_char) const
+{
+    writer w(out, indent, indent_char);
+    w.value(*this);
+    return w.flush();
+}
 
-    dump(context, 0);
-    return context.out.str();
+# if CRUDE_JSON_IO
+bool file_sink::write(const char* data, size_t size)
+{
+    return fwrite(data, 1, size, m_File) == size;
 }
+# endif
 
-void value::dump_context_t::write_indent(int level)
+void buffered_sink::write(const char* data, size_t size)
 {
-    if (indent <= 0 || level == 0)
-        return;
+    if (m_Size + size > sizeof(m_Buffer))
+    {
+        flush();
+
+        // Large chunks go straight to the sink.
+        if (size > sizeof(m_Buffer))
+        {
+            if (m_Good)
+                m_Good = m_Sink.write(data, size);
+            return;
+        }
+    }
 
-    out.fill(indent_char);
-    out.width(indent * level);
-    out << indent_char;
-    out.width(0);
+    memcpy(m_Buffer + m_Size, data, size);
+    m_Size += size;
 }
 
-void value::dump_context_t::write_separator()
+bool buffered_sink::flush()
 {
-    if (indent < 0)
-        return;
+    if (m_Size > 0 && m_Good)
+        m_Good = m_Sink.write(m_Buffer, m_Size);
+
+    m_Size = 0;
 
-    out.put(' ');
+    return m_Good;
 }
 
-void value::dump_context_t::write_newline()
+writer::writer(sink& out, const int indent, const char indent_char)
+    : m_Out(out)
+    , m_Indent(indent)
+    , m_IndentChar(indent_char)
 {
-    if (indent < 0)
-        return;
+}
+
+writer& writer::begin_object(size_t)
+{
+    begin_structure(true, '{');
+    return *this;
+}
 
-    out.put('\n');
+writer& writer::end_object()
+{
+    end_structure(true, '}');
+    return *this;
 }
 
-void value::dump(dump_context_t& context, int level) const
+writer& writer::begin_array(size_t)
 {
-    context.write_indent(level);
+    begin_structure(false, '[');
+    return *this;
+}
 
-    switch (m_Type)
+writer& writer::end_array()
+{
+    end_structure(false, ']');
+    return *this;
+}
+
+writer& writer::key(std::string_view name)
+{
+    CRUDE_ASSERT(!m_Stack.empty() && m_Stack.back().m_IsObject && !m_HasKey);
+
+    auto& top = m_Stack.back();
+    if (top.m_HasMembers)
+    {
+        m_Out.write(',');
+        write_newline();
+    }
+    top.m_HasMembers = true;
+
+    write_indent(m_Stack.size());
+    write_string(name);
+    m_Out.write(':');
+    m_HasKey = true;
+
+    return *this;
+}
+
+writer& writer::value(null)
+{
+    begin_value();
+    m_Out.write("null", 4);
+    return *this;
+}
+
+writer& writer::value(boolean v)
+{
+    begin_value();
+    if (v)
+        m_Out.write("true", 4);
+    else
+        m_Out.write("false", 5);
+    return *this;
+}
+
+writer& writer::value(number v)
+{
+    begin_value();
+
+    // Same as std::ostream with precision of max_digits10 + 1 and default
+    // float format, but independent of locale.
+    const int precision = std::numeric_limits<double>::max_digits10 + 1;
+    char buffer[32];
+# if CRUDE_JSON_FROM_CHARS
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), v, std::chars_format::general, precision);
+    m_Out.write(buffer, static_cast<size_t>(result.ptr - buffer));
+# else
+    auto size = snprintf(buffer, sizeof(buffer), "%.*g", precision, v);
+    if (auto point = strchr(buffer, *localeconv()->decimal_point); point && *point != '.')
+        *point = '.';
+    m_Out.write(buffer, static_cast<size_t>(size));
+# endif
+
+    return *this;
+}
+
+writer& writer::value(std::string_view v)
+{
+    begin_value();
+    write_string(v);
+    return *this;
+}
+
+writer& writer::value(const crude_json::value& v)
+{
+    switch (v.type())
     {
         case type_t::null:
-            context.out << "null";
-            break;
+            return value(nullptr);
 
         case type_t::object:
-            context.out << '{';
+            begin_object();
+            for (auto& entry : v.get<object>())
             {
-                context.write_newline();
-                bool first = true;
-                for (auto& entry : *object_ptr(m_Storage))
-                {
-                    if (!first) { context.out << ','; context.write_newline(); } else first = false;
-                    context.write_indent(level + 1);
-                    context.out << '\"' << entry.first << "\":";
-                    if (!entry.second.is_structured())
-                    {
-                        context.write_separator();
-                        entry.second.dump(context, 0);
-                    }
-                    else
-                    {
-                        context.write_newline();
-                        entry.second.dump(context, level + 1);
-                    }
-                }
-                if (!first)
-                    context.write_newline();
+                key(entry.first);
+                value(entry.second);
             }
-            context.write_indent(level);
-            context.out << '}';
-            break;
+            return end_object();
 
         case type_t::array:
-            context.out << '[';
-            {
-                context.write_newline();
-                bool first = true;
-                for (auto& entry : *array_ptr(m_Storage))
-                {
-                    if (!first) { context.out << ','; context.write_newline(); } else first = false;
-                    if (!entry.is_structured())
-                    {
-                        context.write_indent(level + 1);
-                        entry.dump(context, 0);
-                    }
-                    else
-                    {
-                        entry.dump(context, level + 1);
-                    }
-                }
-                if (!first)
-                    context.write_newline();
-            }
-            context.write_indent(level);
-            context.out << ']';
-            break;
+            begin_array();
+            for (auto& entry : v.get<array>())
+                value(entry);
+            return end_array();
 
         case type_t::string:
-            context.out << '\"';
-
-            if (string_ptr(m_Storage)->find_first_of("\"\\/\b\f\n\r") != string::npos || string_ptr(m_Storage)->find('\0') != string::npos)
-            {
-                for (auto c : *string_ptr(m_Storage))
-                {
-                         if (c == '\"')  context.out << "\\\"";
-                    else if (c == '\\')  context.out << "\\\\";
-                    else if (c == '/')   context.out << "\\/";
-                    else if (c == '\b')  context.out << "\\b";
-                    else if (c == '\f')  context.out << "\\f";
-                    else if (c == '\n')  context.out << "\\n";
-                    else if (c == '\r')  context.out << "\\r";
-                    else if (c == '\t')  context.out << "\\t";
-                    else if (c == 0)     context.out << "\\u0000";
-                    else                 context.out << c;
-                }
-            }
-            else
-                context.out << *string_ptr(m_Storage);
-            context.out << '\"';
-            break;
-
+            return value(v.view());
 
         case type_t::boolean:
-            if (*boolean_ptr(m_Storage))
-                context.out << "true";
-            else
-                context.out << "false";
-            break;
+            return value(v.get<boolean>());
 
         case type_t::number:
-            context.out << *number_ptr(m_Storage);
-            break;
+            return value(v.get<number>());
 
         default:
-            break;
+            // Discarded value has no text, only separators around it are written.
+            begin_value();
+            return *this;
     }
 }
 
-struct value::parser
+writer& writer::raw_value(std::string_view json)
 {
-    parser(const char* begin, const char* end)
-        : m_Cursor(begin)
-        , m_End(end)
-    {
-    }
+    begin_value();
+    m_Out.write(json.data(), json.size());
+    return *this;
+}
 
-    value parse()
+void writer::begin_value(bool structured)
+{
+    if (m_Stack.empty())
+        return;
+
+    auto& top = m_Stack.back();
+    if (top.m_IsObject)
     {
-        value v;
+        CRUDE_ASSERT(m_HasKey);
+        m_HasKey = false;
 
-        // Switch to C locale to make strtod and strtol work as expected
-        auto previous_locale = std::setlocale(LC_NUMERIC, "C");
+        // Structured member value starts on its own line, others follow the key.
+        if (structured)
+        {
+            write_newline();
+            write_indent(m_Stack.size());
+        }
+        else if (m_Indent >= 0)
+            m_Out.write(' ');
 
-        // Accept single value only when end of the stream is reached.
+        return;
+    }
+
+    if (top.m_HasMembers)
+    {
+        m_Out.write(',');
+        write_newline();
+    }
+    top.m_HasMembers = true;
+
+    write_indent(m_Stack.size());
+}
+
+void writer::begin_structure(bool is_object, char c)
+{
+    begin_value(true);
+
+    m_Out.write(c);
+    write_newline();
+
+    m_Stack.push_back({ is_object, false });
+}
+
+void writer::end_structure(bool is_object, char c)
+{
+    CRUDE_ASSERT(!m_Stack.empty() && m_Stack.back().m_IsObject == is_object && !m_HasKey);
+    (void)is_object;
+
+    const bool has_members = m_Stack.back().m_HasMembers;
+    m_Stack.pop_back();
+
+    if (has_members)
+        write_newline();
+    write_indent(m_Stack.size());
+    m_Out.write(c);
+}
+
+void writer::write_string(std::string_view s)
+{
+    m_Out.write('\"');
+
+    // Runs of characters which do not need escaping are written at once.
+    auto run = s.data();
+    auto end = s.data() + s.size();
+    for (auto p = run; p != end; ++p)
+    {
+        const char* escape = nullptr;
+        switch (*p)
+        {
+            case '\"': escape = "\\\""; break;
+            case '\\': escape = "\\\\"; break;
+            case '/':  escape = "\\/";  break;
+            case '\b': escape = "\\b";  break;
+            case '\f': escape = "\\f";  break;
+            case '\n': escape = "\\n";  break;
+            case '\r': escape = "\\r";  break;
+            case '\t': escape = "\\t";  break;
+            case '\0': escape = "\\u0000"; break;
+            default: continue;
+        }
+
+        m_Out.write(run, static_cast<size_t>(p - run));
+        m_Out.write(escape, strlen(escape));
+        run = p + 1;
+    }
+    m_Out.write(run, static_cast<size_t>(end - run));
+
+    m_Out.write('\"');
+}
+
+void writer::write_indent(size_t level)
+{
+    if (m_Indent <= 0 || level == 0)
+        return;
+
+    for (size_t i = 0, count = m_Indent * level; i < count; ++i)
+        m_Out.write(m_IndentChar);
+}
+
+void writer::write_newline()
+{
+    if (m_Indent < 0)
+        return;
+
+    m_Out.write('\n');
+}
+
+//------------------------------------------------------------------------------
+// Scanning helpers used by parser. Vector paths only load whole 16 byte blocks
+// that lie inside [p, end), remaining tail is handled one character at a time.
+static inline bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+# if CRUDE_JSON_NEON
+// One nibble per lane of comparison result, NEON has no movemask.
+static inline uint64_t nibble_mask(uint8x16_t v)
+{
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(v), 4)), 0);
+}
+
+// One bit per byte of comparison result, like _mm_movemask_epi8.
+static inline uint64_t byte_mask(uint8x16_t v)
+{
+    static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    auto sum = vandq_u8(v, vld1q_u8(bits));
+    auto low = vpadd_u8(vget_low_u8(sum), vget_high_u8(sum));
+    low = vpadd_u8(low, low);
+    low = vpadd_u8(low, low);
+    return vget_lane_u16(vreinterpret_u16_u8(low), 0);
+}
+# endif
+
+static const char* skip_whitespace(const char* p, const char* end)
+{
+    // Compact documents have no whitespace between tokens at all.
+    if (p == end || !is_whitespace(*p))
+        return p;
+
+# if CRUDE_JSON_SSE2
+    const __m128i space   = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i cr      = _mm_set1_epi8('\r');
+    const __m128i tab     = _mm_set1_epi8('\t');
+    while (end - p >= 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i ws    = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, newline)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr),    _mm_cmpeq_epi8(chunk, tab)));
+        const auto mask = ~static_cast<unsigned int>(_mm_movemask_epi8(ws)) & 0xFFFFu;
+        if (mask)
+            return p + std::countr_zero(mask);
+        p += 16;
+    }
+# elif CRUDE_JSON_NEON
+    const uint8x16_t space   = vdupq_n_u8(' ');
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const uint8x16_t cr      = vdupq_n_u8('\r');
+    const uint8x16_t tab     = vdupq_n_u8('\t');
+    while (end - p >= 16)
+    {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        const uint8x16_t ws    = vorrq_u8(
+            vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, newline)),
+            vorrq_u8(vceqq_u8(chunk, cr),    vceqq_u8(chunk, tab)));
+        const auto mask = ~nibble_mask(ws);
+        if (mask)
+            return p + std::countr_zero(mask) / 4;
+        p += 16;
+    }
+# endif
+
+    while (p != end && is_whitespace(*p))
+        ++p;
+
+    return p;
+}
+
+// Returns first quote or backslash, everything before it is copied verbatim.
+static const char* find_string_special(const char* p, const char* end)
+{
+# if CRUDE_JSON_SSE2
+    const __m128i quote     = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while (end - p >= 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto    mask  = static_cast<unsigned int>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))));
+        if (mask)
+            return p + std::countr_zero(mask);
+        p += 16;
+    }
+# elif CRUDE_JSON_NEON
+    const uint8x16_t quote     = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    while (end - p >= 16)
+    {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        const auto       mask  = nibble_mask(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)));
+        if (mask)
+            return p + std::countr_zero(mask) / 4;
+        p += 16;
+    }
+# endif
+
+    while (p != end && *p != '\"' && *p != '\\')
+        ++p;
+
+    return p;
+}
+
+// Text of string token with escapes replaced by characters they stand for.
+// Escapes are expected to be valid, parser checks them.
+static void decode_string(std::string_view text, string& result)
+{
+    result.reserve(result.size() + text.size());
+
+    auto p   = text.data();
+    auto end = p + text.size();
+    while (true)
+    {
+        auto run_end = std::find(p, end, '\\');
+        result.append(p, run_end);
+        if (run_end == end)
+            break;
+
+        p = run_end + 1;
+
+        int c = 0;
+        switch (*p++)
+        {
+            case '\"': c = '\"';  break;
+            case '\\': c = '\\'; break;
+            case '/':  c = '/';  break;
+            case 'b':  c = '\b'; break;
+            case 'f':  c = '\f'; break;
+            case 'n':  c = '\n'; break;
+            case 'r':  c = '\r'; break;
+            case 't':  c = '\t'; break;
+            case 'u':
+                std::from_chars(p, p + 4, c, 16);
+                p += 4;
+                break;
+            default:
+                CRUDE_ASSERT(false && "invalid escape");
+                break;
+        }
+
+        CRUDE_ASSERT(c < 128); // #todo: convert characters > 127 to UTF-8
+        result.push_back(static_cast<char>(c));
+    }
+}
+
+struct value::parser
+{
+    // With 'input' arena document is parsed in-situ, strings are views into
+    // the input owned by the arena.
+    parser(const char* begin, const char* end, arena* input = nullptr)
+        : m_Cursor(begin)
+        , m_End(end)
+        , m_Arena(input)
+        , m_InSitu(input != nullptr)
+    {
+    }
+
+    // Accepts text made of exactly one string, with escapes decoded.
+    bool parse_string(string& result)
+    {
+        std::string_view text;
+        bool             escaped;
+        if (!scan_string(text, escaped) || !eof())
+            return false;
+
+        result.clear();
+        decode_string(text, result);
+        return true;
+    }
+
+    value parse()
+    {
+        value v;
+
+        // Objects of the document share one arena, it lives as long as any of them.
+        if (m_Arena)
+            m_Arena->retain();
+# if CRUDE_JSON_FLAT_OBJECT
+        else
+            m_Arena = arena::create();
+# endif
+
+# if !CRUDE_JSON_FROM_CHARS
+        // Switch to C locale to make strtod work as expected
+        auto previous_locale = std::setlocale(LC_NUMERIC, "C");
+# endif
+
+        // Accept single value only when end of the stream is reached.
         if (!accept_element(v) || !eof())
             v = value(type_t::discarded);
 
+# if !CRUDE_JSON_FROM_CHARS
         if (previous_locale && strcmp(previous_locale, "C") != 0)
             std::setlocale(LC_NUMERIC, previous_locale);
+# endif
+
+        if (m_Arena)
+        {
+            m_Arena->release();
+            m_Arena = nullptr;
+        }
 
         return v;
     }
 
 private:
+    object make_object()
+    {
+# if CRUDE_JSON_FLAT_OBJECT
+        return object(m_Arena);
+# else
+        return object();
+# endif
+    }
+
     struct cursor_state
     {
         cursor_state(parser* p)
@@ -408,45 +1168,58 @@ private:
     {
         auto s = state();
 
-        object o;
         if (s(accept('{') && accept_ws() && accept('}')))
         {
-            result = o;
+            result = make_object();
             return true;
         }
-        else if (s(accept('{') && accept_members(o) && accept('}')))
+
+        // Members are collected first, so object is allocated once with its final size.
+        const auto first = m_Members.size();
+        if (s(accept('{') && accept_members() && accept('}')))
         {
+            object o = make_object();
+# if CRUDE_JSON_FLAT_OBJECT
+            o.reserve(m_Members.size() - first);
+# endif
+            for (auto i = first; i < m_Members.size(); ++i)
+                o.emplace(m_Members[i].first, std::move(m_Members[i].second));
+
+            m_Members.resize(first);
+
             result = std::move(o);
             return true;
         }
 
+        m_Members.resize(first);
+
         return false;
     }
 
-    bool accept_members(object& o)
+    bool accept_members()
     {
-        if (!accept_member(o))
+        if (!accept_member())
             return false;
 
         while (true)
         {
             auto s = state();
-            if (!s(accept(',') && accept_member(o)))
+            if (!s(accept(',') && accept_member()))
                 break;
         }
 
         return true;
     }
 
-    bool accept_member(object& o)
+    bool accept_member()
     {
         auto s = state();
 
-        value key;
-        value v;
-        if (s(accept_ws() && accept_string(key) && accept_ws() && accept(':') && accept_element(v)))
+        std::string_view key;
+        value            v;
+        if (s(accept_ws() && accept_key(key) && accept_ws() && accept(':') && accept_element(v)))
         {
-            o.emplace(std::move(key.get<string>()), std::move(v));
+            m_Members.emplace_back(key, std::move(v));
             return true;
         }
 
@@ -500,43 +1273,74 @@ private:
 
     bool accept_string(value& result)
     {
-        auto s = state();
+        std::string_view text;
+        bool             escaped;
+        if (!scan_string(text, escaped))
+            return false;
 
-        string v;
-        if (s(accept('\"') && accept_characters(v) && accept('\"')))
+        if (m_InSitu)
+            result = make_view(text, escaped, m_Arena);
+        else if (escaped)
         {
+            string v;
+            decode_string(text, v);
             result = std::move(v);
-            return true;
         }
         else
-            return false;
+            result = string(text);
+
+        return true;
     }
 
-    bool accept_characters(string& result)
+    // Keys without escapes are views into the input, others are decoded.
+    bool accept_key(std::string_view& result)
     {
-        int c;
-        while (accept_character(c))
+        bool escaped;
+        if (!scan_string(result, escaped))
+            return false;
+
+        if (escaped)
         {
-            CRUDE_ASSERT(c < 128); // #todo: convert characters > 127 to UTF-8
-            result.push_back(static_cast<char>(c));
+            m_DecodedKeys.emplace_back();
+            decode_string(result, m_DecodedKeys.back());
+            result = m_DecodedKeys.back();
         }
 
         return true;
     }
 
-    bool accept_character(int& c)
+    // Accepts string, 'text' is everything between the quotes. Escapes are
+    // checked, but left as they are.
+    bool scan_string(std::string_view& text, bool& escaped)
     {
-        auto s = state();
+        if (!accept('\"'))
+            return false;
 
-        if (accept('\\'))
+        // Skip runs of plain characters at once, stop only at quotes and escapes.
+        // #todo: Validate UTF-8 sequences, they are accepted as is.
+        const auto start = m_Cursor - 1;
+        const auto begin = m_Cursor;
+        escaped = false;
+        while (true)
         {
-            return accept_escape(c);
-        }
-        else if (expect('\"'))
-            return false;
+            m_Cursor = find_string_special(m_Cursor, m_End);
+
+            if (accept('\"'))
+            {
+                text = std::string_view(begin, static_cast<size_t>(m_Cursor - 1 - begin));
+                return true;
+            }
+
+            // Unterminated string or invalid escape, nothing is consumed.
+            int c;
+            if (!accept('\\') || !accept_escape(c))
+            {
+                m_Cursor = start;
+                return false;
+            }
 
-        // #todo: Handle UTF-8 sequences.
-        return s((c = peek()) >= 0) && advance();
+            escaped = true;
+        }
     }
 
     bool accept_escape(int& c)
@@ -586,75 +1390,97 @@ private:
 
     bool accept_number(value& result)
     {
-        auto s = state();
+        // Grammar is checked in place: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        // Fraction or exponent not followed by digits is left for the caller,
+        // like any other unexpected character.
+        const auto begin    = m_Cursor;
+        auto       p        = m_Cursor;
+        const bool negative = p != m_End && *p == '-';
+        if (negative)
+            ++p;
+
+        if (p == m_End || !is_digit(*p))
+            return false;
 
-        string n;
-        if (s(accept_int(n) && accept_frac(n) && accept_exp(n)))
+        // Integers with up to 15 digits are exact in double and do not need
+        // general conversion, most numbers in node editor settings are such.
+        uint64_t integer = 0;
+        int      digits  = 0;
+        if (*p == '0')
+            ++p;
+        else
         {
-            char* end = nullptr;
-            auto v = std::strtod(n.c_str(), &end);
-            if (end != n.c_str() + n.size())
-                return false;
-
-            if (v != 0 && !std::isnormal(v))
-                return false;
-
-            result = v;
-            return true;
+            for (; p != m_End && is_digit(*p); ++p, ++digits)
+                if (digits < 16)
+                    integer = integer * 10 + static_cast<uint64_t>(*p - '0');
         }
 
-        return false;
-    }
-
-    bool accept_int(string& result)
-    {
-        auto s = state();
-
-        string part;
-        if (s(accept_onenine(part) && accept_digits(part)))
+        bool is_integer = true;
+        if (m_End - p >= 2 && p[0] == '.' && is_digit(p[1]))
         {
-            result += std::move(part);
-            return true;
+            p += 2;
+            while (p != m_End && is_digit(*p))
+                ++p;
+            is_integer = false;
         }
 
-        part.resize(0);
-        if (accept_digit(part))
+        if (p != m_End && (*p == 'e' || *p == 'E'))
         {
-            result += std::move(part);
-            return true;
-        }
+            auto e = p + 1;
+            if (e != m_End && (*e == '+' || *e == '-'))
+                ++e;
 
-        part.resize(0);
-        if (s(accept('-') && accept_onenine(part) && accept_digits(part)))
-        {
-            result += '-';
-            result += std::move(part);
-            return true;
+            if (e != m_End && is_digit(*e))
+            {
+                while (e != m_End && is_digit(*e))
+                    ++e;
+                p = e;
+                is_integer = false;
+            }
         }
 
-        part.resize(0);
-        if (s(accept('-') && accept_digit(part)))
+        double v;
+        if (is_integer && digits <= 15)
         {
-            result += '-';
-            result += std::move(part);
-            return true;
+            v = static_cast<double>(integer);
+            if (negative)
+                v = -v;
         }
+        else if (!convert_number(begin, p, v))
+            return false;
 
-        return false;
+        if (v != 0 && !std::isnormal(v))
+            return false;
+
+        m_Cursor = p;
+        result = v;
+        return true;
     }
 
-    bool accept_digits(string& result)
+    static bool convert_number(const char* begin, const char* end, double& result)
     {
-        string part;
-        if (!accept_digit(part))
-            return false;
+# if CRUDE_JSON_FROM_CHARS
+        auto [last, error] = std::from_chars(begin, end, result);
+        if (error == std::errc::result_out_of_range)
+        {
+            // strtod returns zero on underflow and such numbers were accepted.
+            auto exponent = std::find_if(begin, end, [](char c) { return c == 'e' || c == 'E'; });
+            if (exponent == end || std::find(exponent, end, '-') == end)
+                return false;
+
+            result = *begin == '-' ? -0.0 : 0.0;
+            return true;
+        }
 
-        while (accept_digit(part))
-            ;
+        return error == std::errc() && last == end;
+# else
+        string n(begin, end);
 
-        result += std::move(part);
+        char* last = nullptr;
+        result = std::strtod(n.c_str(), &last);
 
-        return true;
+        return last == n.c_str() + n.size();
+# endif
     }
 
     bool accept_digit(string& result)
@@ -682,55 +1508,9 @@ private:
         return false;
     }
 
-    bool accept_frac(string& result)
-    {
-        auto s = state();
-
-        string part;
-        if (s(accept('.') && accept_digits(part)))
-        {
-            result += '.';
-            result += std::move(part);
-        }
-
-        return true;
-    }
-
-    bool accept_exp(string& result)
-    {
-        auto s = state();
-
-        string part;
-        if (s(accept('e') && accept_sign(part) && accept_digits(part)))
-        {
-            result += 'e';
-            result += std::move(part);
-            return true;
-        }
-        part.resize(0);
-        if (s(accept('E') && accept_sign(part) && accept_digits(part)))
-        {
-            result += 'E';
-            result += std::move(part);
-        }
-
-        return true;
-    }
-
-    bool accept_sign(string& result)
-    {
-        if (accept('+'))
-            result.push_back('+');
-        else if (accept('-'))
-            result.push_back('-');
-
-        return true;
-    }
-
     bool accept_ws()
     {
-        while (expect('\x09') || expect('\x0A') || expect('\x0D') || expect('\x20'))
-            advance();
+        m_Cursor = skip_whitespace(m_Cursor, m_End);
         return true;
     }
 
@@ -821,6 +1601,13 @@ private:
 
     const char* m_Cursor;
     const char* m_End;
+
+    // Stack of members of objects being parsed, shared by nested objects.
+    // Deque does not relocate members when it grows.
+    std::deque<std::pair<std::string_view, value>> m_Members;
+    std::deque<string>                             m_DecodedKeys; // keys with escapes
+    arena*                                         m_Arena  = nullptr;
+    bool                                           m_InSitu = false;
 };
 
 value value::parse(const string& data)
@@ -832,59 +1619,1262 @@ value value::parse(const string& data)
     return v;
 }
 
-# if CRUDE_JSON_IO
-std::pair<value, bool> value::load(const string& path)
+value value::make_view(std::string_view data, bool escaped, arena* owner)
 {
-    // Modern C++, so beautiful...
-    std::unique_ptr<FILE, void(*)(FILE*)> file{nullptr, [](FILE* file) { if (file) fclose(file); }};
-# if defined(_MSC_VER) || (defined(__STDC_LIB_EXT1__) && __STDC_WANT_LIB_EXT1__)
-    FILE* handle = nullptr;
-    if (fopen_s(&handle, path.c_str(), "rb") != 0)
-        return {value{}, false};
-    file.reset(handle);
-# else
-    file.reset(fopen(path.c_str(), "rb"));
-# endif
+    value result;
+    new (result.m_Storage.data) string_ref{ data.data(), data.size(), owner, escaped };
+    owner->retain();
+    result.m_Type   = type_t::string;
+    result.m_IsView = true;
+    return result;
+}
 
-    if (!file)
-        return {value{}, false};
+void value::own_string()
+{
+    CRUDE_ASSERT(m_IsView);
 
-    fseek(file.get(), 0, SEEK_END);
-    auto size = static_cast<size_t>(ftell(file.get()));
-    fseek(file.get(), 0, SEEK_SET);
+    const auto ref = *string_ref_ptr(m_Storage);
 
-    string data;
-    data.resize(size);
-    if (fread(const_cast<char*>(data.data()), size, 1, file.get()) != 1)
-        return {value{}, false};
+    string result;
+    if (ref.m_Escaped)
+        decode_string(std::string_view(ref.m_Data, ref.m_Size), result);
+    else
+        result.assign(ref.m_Data, ref.m_Size);
 
-    return {parse(data), true};
+    new (m_Storage.data) string(std::move(result));
+    m_IsView = false;
+
+    ref.m_Owner->release();
 }
 
-bool value::save(const string& path, const int indent, const char indent_char) const
+document::document(document&& other) noexcept
+    : m_Root(std::move(other.m_Root))
+    , m_Arena(other.m_Arena)
 {
-    // Modern C++, so beautiful...
-    std::unique_ptr<FILE, void(*)(FILE*)> file{nullptr, [](FILE* file) { if (file) fclose(file); }};
-# if defined(_MSC_VER) || (defined(__STDC_LIB_EXT1__) && __STDC_WANT_LIB_EXT1__)
-    FILE* handle = nullptr;
-    if (fopen_s(&handle, path.c_str(), "wb") != 0)
-        return false;
-    file.reset(handle);
-# else
-    file.reset(fopen(path.c_str(), "wb"));
-# endif
-
-    if (!file)
-        return false;
+    other.m_Arena = nullptr;
+}
 
-    auto data = dump(indent, indent_char);
+document::~document()
+{
+    if (m_Arena)
+        m_Arena->release();
+}
 
-    if (fwrite(data.data(), data.size(), 1, file.get()) != 1)
-        return false;
+document& document::operator=(document&& other) noexcept
+{
+    if (this != &other)
+    {
+        m_Root = std::move(other.m_Root);
+        if (m_Arena)
+            m_Arena->release();
+        m_Arena = other.m_Arena;
+        other.m_Arena = nullptr;
+    }
+    return *this;
+}
+
+document document::parse(string&& text)
+{
+    auto memory = arena::create();
+    memory->adopt(std::move(text));
+    return parse(memory);
+}
+
+document document::parse(const char* data, size_t size, void (*release)(void* user), void* user)
+{
+    auto memory = arena::create();
+    memory->adopt(data, size, release, user);
+    return parse(memory);
+}
+
+document document::parse(arena* memory)
+{
+    document result;
+    result.m_Arena = memory;
+
+    auto input = memory->input();
+    auto p = value::parser(input.data(), input.data() + input.size(), memory);
+    result.m_Root = p.parse();
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// Lazy document
+//------------------------------------------------------------------------------
+// Sets bits of quotes, backslashes and structural characters of 64 byte block.
+static void classify_block(const char* p, uint64_t& quotes, uint64_t& backslashes, uint64_t& structurals)
+{
+    quotes = backslashes = structurals = 0;
+
+# if CRUDE_JSON_SSE2
+    // '[' and ']' differ from '{' and '}' only by 0x20 bit.
+    const __m128i quote     = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i open      = _mm_set1_epi8('{');
+    const __m128i close     = _mm_set1_epi8('}');
+    const __m128i colon     = _mm_set1_epi8(':');
+    const __m128i comma     = _mm_set1_epi8(',');
+    const __m128i fold      = _mm_set1_epi8(0x20);
+    for (int i = 0; i < 4; ++i)
+    {
+        const __m128i chunk  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        const __m128i folded = _mm_or_si128(chunk, fold);
+        const __m128i brackets   = _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close));
+        const __m128i separators = _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma));
+
+        quotes      |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))))     << (16 * i);
+        backslashes |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)))) << (16 * i);
+        structurals |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_or_si128(brackets, separators)))) << (16 * i);
+    }
+# elif CRUDE_JSON_NEON
+    const uint8x16_t quote     = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t open      = vdupq_n_u8('{');
+    const uint8x16_t close     = vdupq_n_u8('}');
+    const uint8x16_t colon     = vdupq_n_u8(':');
+    const uint8x16_t comma     = vdupq_n_u8(',');
+    const uint8x16_t fold      = vdupq_n_u8(0x20);
+    for (int i = 0; i < 4; ++i)
+    {
+        const uint8x16_t chunk  = vld1q_u8(reinterpret_cast<const uint8_t*>(p + 16 * i));
+        const uint8x16_t folded = vorrq_u8(chunk, fold);
+        const uint8x16_t brackets   = vorrq_u8(vceqq_u8(folded, open), vceqq_u8(folded, close));
+        const uint8x16_t separators = vorrq_u8(vceqq_u8(chunk, colon), vceqq_u8(chunk, comma));
+
+        quotes      |= byte_mask(vceqq_u8(chunk, quote))          << (16 * i);
+        backslashes |= byte_mask(vceqq_u8(chunk, backslash))      << (16 * i);
+        structurals |= byte_mask(vorrq_u8(brackets, separators)) << (16 * i);
+    }
+# else
+    for (int i = 0; i < 64; ++i)
+    {
+        const auto bit = static_cast<uint64_t>(1) << i;
+        switch (p[i])
+        {
+            case '\"': quotes      |= bit; break;
+            case '\\': backslashes |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',':
+                       structurals |= bit; break;
+            default: break;
+        }
+    }
+# endif
+}
+
+// Bits of characters preceded by escaping backslash. 'carry' is set when
+// block ends with such backslash, it escapes first character of next block.
+static uint64_t find_escaped(uint64_t backslashes, uint64_t& carry)
+{
+    auto escaped = carry;
+    carry = 0;
+
+    // Backslashes are rare, they are visited one by one.
+    while (backslashes)
+    {
+        const auto bit = std::countr_zero(backslashes);
+        backslashes &= backslashes - 1;
+
+        if ((escaped >> bit) & 1)
+            continue; // escaped backslash
+
+        if (bit == 63)
+            carry = 1;
+        else
+            escaped |= static_cast<uint64_t>(1) << (bit + 1);
+    }
+
+    return escaped;
+}
+
+// Every bit is xor of itself and all lower bits. For quote bits result has
+// bits set from opening quote up to, but not including, closing quote.
+static uint64_t prefix_xor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+static bool is_blank(const char* begin, const char* end)
+{
+    return skip_whitespace(begin, end) == end;
+}
+
+type_t lazy_value::type() const
+{
+    if (!m_Document || m_Begin == m_End)
+        return type_t::discarded;
+
+    switch (m_Document->text()[m_Begin])
+    {
+        case '{': return type_t::object;
+        case '[': return type_t::array;
+        case '\"': return type_t::string;
+        case 't':
+        case 'f': return type_t::boolean;
+        case 'n': return type_t::null;
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return type_t::number;
+        default:
+            return type_t::discarded;
+    }
+}
+
+lazy_value lazy_value::operator[](std::string_view key) const
+{
+    if (!is_object())
+        return lazy_value();
+
+    for (auto it = begin(), last = end(); it != last; ++it)
+        if (it.key() == key)
+            return *it;
+
+    return lazy_value();
+}
+
+lazy_value lazy_value::operator[](size_t index) const
+{
+    if (!is_array())
+        return lazy_value();
+
+    for (auto it = begin(), last = end(); it != last; ++it, --index)
+        if (index == 0)
+            return *it;
+
+    return lazy_value();
+}
+
+size_t lazy_value::size() const
+{
+    size_t result = 0;
+    for (auto it = begin(), last = end(); it != last; ++it)
+        ++result;
+    return result;
+}
+
+lazy_iterator lazy_value::begin() const
+{
+    lazy_iterator result;
+
+    const auto t = type();
+    if (t != type_t::object && t != type_t::array)
+        return result;
+
+    const auto& open = m_Document->m_Structurals[m_Entry];
+    const auto  data = m_Document->text().data();
+
+    result.m_Document  = m_Document;
+    result.m_Separator = m_Entry;
+    result.m_Close     = open.m_Match;
+    result.m_IsObject  = t == type_t::object;
+
+    // Brackets with nothing between them. Array with single element also has
+    // no structural inside.
+    if (m_Entry + 1 == open.m_Match && is_blank(data + open.m_Position + 1, data + m_End - 1))
+        result.m_Separator = open.m_Match;
+    else
+        result.read();
+
+    return result;
+}
+
+lazy_iterator lazy_value::end() const
+{
+    lazy_iterator result;
+
+    const auto t = type();
+    if (t != type_t::object && t != type_t::array)
+        return result;
+
+    result.m_Document  = m_Document;
+    result.m_Close     = m_Document->m_Structurals[m_Entry].m_Match;
+    result.m_Separator = result.m_Close;
+    result.m_IsObject  = t == type_t::object;
+
+    return result;
+}
+
+std::string_view lazy_value::text() const
+{
+    if (!m_Document)
+        return std::string_view();
+
+    return m_Document->text().substr(m_Begin, m_End - m_Begin);
+}
+
+value lazy_value::parse() const
+{
+    if (!m_Document || m_Begin == m_End)
+        return value(type_t::discarded);
+
+    return lazy_document::parse_text(text());
+}
+
+bool lazy_value::is_valid() const
+{
+    if (!m_Document || m_Begin == m_End)
+        return false;
+
+    const auto  data        = m_Document->text().data();
+    const auto& structurals = m_Document->m_Structurals;
+
+    const auto c = data[m_Begin];
+    if (c != '{' && c != '[')
+        return !lazy_document::parse_text(text()).is_discarded();
+
+    // Every item between structurals is a scalar, keys have to be strings.
+    for (auto i = m_Entry, last = structurals[m_Entry].m_Match; i < last; ++i)
+    {
+        const auto next = data + structurals[i + 1].m_Position;
+
+        auto begin = skip_whitespace(data + structurals[i].m_Position + 1, next);
+        auto end   = next;
+        while (end > begin && is_whitespace(end[-1]))
+            --end;
+
+        if (begin == end)
+            continue;
+
+        const auto item = lazy_document::parse_text(std::string_view(begin, static_cast<size_t>(end - begin)));
+        if (item.is_discarded() || (*next == ':' && !item.is_string()))
+            return false;
+    }
+
+    return true;
+}
+
+lazy_iterator& lazy_iterator::operator++()
+{
+    m_Separator = m_Next;
+    if (m_Separator != m_Close)
+        read();
+
+    return *this;
+}
+
+void lazy_iterator::read()
+{
+    m_Key        = std::string_view();
+    m_KeyEscaped = false;
+
+    if (!m_IsObject)
+    {
+        m_Value = m_Document->item_after(m_Separator, m_Next);
+        return;
+    }
+
+    // Index guarantees colon after bracket or comma in objects.
+    const auto  colon = m_Separator + 1;
+    const auto  data  = m_Document->text().data();
+    const auto& from  = m_Document->m_Structurals[m_Separator];
+    const auto& to    = m_Document->m_Structurals[colon];
+
+    auto begin = skip_whitespace(data + from.m_Position + 1, data + to.m_Position);
+    auto end   = data + to.m_Position;
+    while (end > begin && is_whitespace(end[-1]))
+        --end;
+
+    m_Value = m_Document->item_after(colon, m_Next);
+
+    const auto token = std::string_view(begin, static_cast<size_t>(end - begin));
+    if (token.size() >= 2 && token.front() == '\"' && token.back() == '\"' && token.find_first_of("\"\\", 1) == token.size() - 1)
+        m_Key = token.substr(1, token.size() - 2);
+    else if (lazy_document::read_string(token, m_DecodedKey))
+        m_KeyEscaped = true;
+    else
+        m_Value = lazy_value(); // key is not a string
+}
+
+lazy_document::lazy_document(lazy_document&& other) noexcept
+    : m_Structurals(std::move(other.m_Structurals))
+    , m_Arena(other.m_Arena)
+    , m_Valid(other.m_Valid)
+{
+    other.m_Arena = nullptr;
+    other.m_Valid = false;
+}
+
+lazy_document::~lazy_document()
+{
+    if (m_Arena)
+        m_Arena->release();
+}
+
+lazy_document& lazy_document::operator=(lazy_document&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_Arena)
+            m_Arena->release();
+
+        m_Structurals = std::move(other.m_Structurals);
+        m_Arena       = other.m_Arena;
+        m_Valid       = other.m_Valid;
+        other.m_Arena = nullptr;
+        other.m_Valid = false;
+    }
+    return *this;
+}
+
+lazy_document lazy_document::parse(string&& text)
+{
+    auto memory = arena::create();
+    memory->adopt(std::move(text));
+    return parse(memory);
+}
+
+lazy_document lazy_document::parse(const char* data, size_t size, void (*release)(void* user), void* user)
+{
+    auto memory = arena::create();
+    memory->adopt(data, size, release, user);
+    return parse(memory);
+}
+
+lazy_document lazy_document::parse(arena* memory)
+{
+    lazy_document result;
+    result.m_Arena = memory;
+    result.m_Valid = result.index();
+    if (!result.m_Valid)
+        result.m_Structurals = std::vector<structural>();
+
+    return result;
+}
+
+value lazy_document::parse_text(std::string_view text)
+{
+    auto p = value::parser(text.data(), text.data() + text.size());
+    return p.parse();
+}
+
+bool lazy_document::read_string(std::string_view text, string& result)
+{
+    auto p = value::parser(text.data(), text.data() + text.size());
+    return p.parse_string(result);
+}
+
+lazy_value lazy_document::root() const
+{
+    lazy_value result;
+    if (!m_Valid)
+        return result;
+
+    const auto input = text();
+    const auto data  = input.data();
+
+    result.m_Document = this;
+    if (m_Structurals.empty())
+    {
+        // Scalar, checked when parsed.
+        auto begin = skip_whitespace(data, data + input.size());
+        auto end   = data + input.size();
+        while (end > begin && is_whitespace(end[-1]))
+            --end;
+
+        result.m_Begin = static_cast<uint32_t>(begin - data);
+        result.m_End   = static_cast<uint32_t>(end - data);
+    }
+    else
+    {
+        result.m_Begin = m_Structurals.front().m_Position;
+        result.m_End   = m_Structurals.back().m_Position + 1;
+        result.m_Entry = 0;
+    }
+
+    return result;
+}
+
+lazy_value lazy_document::item_after(uint32_t separator, uint32_t& next) const
+{
+    const auto  data   = text().data();
+    const auto& from   = m_Structurals[separator];
+    const auto& after  = m_Structurals[separator + 1];
+
+    lazy_value result;
+    result.m_Document = this;
+
+    auto begin = skip_whitespace(data + from.m_Position + 1, data + after.m_Position);
+    result.m_Begin = static_cast<uint32_t>(begin - data);
+
+    const auto c = data[after.m_Position];
+    if (begin == data + after.m_Position && (c == '{' || c == '['))
+    {
+        result.m_Entry = separator + 1;
+        result.m_End   = m_Structurals[after.m_Match].m_Position + 1;
+        next           = after.m_Match + 1;
+    }
+    else
+    {
+        auto end = data + after.m_Position;
+        while (end > begin && is_whitespace(end[-1]))
+            --end;
+
+        result.m_End = static_cast<uint32_t>(end - data);
+        next         = separator + 1;
+    }
+
+    return result;
+}
+
+bool lazy_document::index()
+{
+    const auto input = text();
+    const auto data  = input.data();
+    const auto size  = input.size();
+
+    if (size >= static_cast<size_t>(UINT32_MAX))
+        return false;
+
+    uint64_t in_string = 0; // all bits set while previous block ended inside of a string
+    uint64_t carry     = 0;
+    for (size_t offset = 0; offset < size; offset += 64)
+    {
+        // Last block is padded with spaces.
+        char padded[64];
+        auto block = data + offset;
+        if (size - offset < 64)
+        {
+            memset(padded, ' ', sizeof(padded));
+            memcpy(padded, block, size - offset);
+            block = padded;
+        }
+
+        uint64_t quotes, backslashes, structurals;
+        classify_block(block, quotes, backslashes, structurals);
+
+        if (backslashes | carry)
+            quotes &= ~find_escaped(backslashes, carry);
+
+        const auto string_mask = prefix_xor(quotes) ^ in_string;
+        in_string = static_cast<uint64_t>(static_cast<int64_t>(string_mask) >> 63);
+
+        structurals &= ~string_mask;
+        while (structurals)
+        {
+            m_Structurals.push_back({ static_cast<uint32_t>(offset + std::countr_zero(structurals)), 0 });
+            structurals &= structurals - 1;
+        }
+    }
+
+    return !in_string && pair_brackets();
+}
+
+// Pairs brackets and checks that separators are where grammar expects them.
+// Text between structurals is checked only to be blank, or not, where that
+// decides if a value is there.
+bool lazy_document::pair_brackets()
+{
+    enum class expect_t: uint8_t
+    {
+        key,        // after '{' or ',' in object
+        value,      // after ':' in object, '[' or ',' in array
+        separator   // after nested object or array
+    };
+
+    struct frame
+    {
+        uint32_t m_Open;
+        bool     m_IsObject;
+        expect_t m_Expect;
+    };
+
+    const auto input = text();
+    const auto data  = input.data();
+    const auto count = static_cast<uint32_t>(m_Structurals.size());
+
+    // Scalar top level value is checked when parsed.
+    if (count == 0)
+        return true;
+
+    std::vector<frame> stack;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto&      entry = m_Structurals[i];
+        const auto c     = data[entry.m_Position];
+        const auto blank = is_blank(i > 0 ? data + m_Structurals[i - 1].m_Position + 1 : data, data + entry.m_Position);
+
+        if (c == '{' || c == '[')
+        {
+            if (!blank || (stack.empty() ? i != 0 : stack.back().m_Expect != expect_t::value))
+                return false;
+
+            stack.push_back({ i, c == '{', c == '{' ? expect_t::key : expect_t::value });
+            continue;
+        }
+
+        // Anything after top level value closed.
+        if (stack.empty())
+            return false;
+
+        auto& top = stack.back();
+
+        if (c == '}' || c == ']')
+        {
+            if (top.m_IsObject != (c == '}'))
+                return false;
+
+            const bool empty = i == top.m_Open + 1;
+            switch (top.m_Expect)
+            {
+                case expect_t::key:       if (!empty || !blank)                             return false; break;
+                case expect_t::value:     if (blank && (top.m_IsObject || !empty))           return false; break;
+                case expect_t::separator: if (!blank)                                       return false; break;
+            }
+
+            entry.m_Match = top.m_Open;
+            m_Structurals[top.m_Open].m_Match = i;
+            stack.pop_back();
+
+            if (!stack.empty())
+                stack.back().m_Expect = expect_t::separator;
+            else if (!is_blank(data + entry.m_Position + 1, data + input.size()))
+                return false;
+
+            continue;
+        }
+
+        if (c == ':')
+        {
+            if (!top.m_IsObject || top.m_Expect != expect_t::key || blank)
+                return false;
+
+            top.m_Expect = expect_t::value;
+            continue;
+        }
+
+        // ','
+        switch (top.m_Expect)
+        {
+            case expect_t::key:       return false;
+            case expect_t::value:     if (blank)  return false; break;
+            case expect_t::separator: if (!blank) return false; break;
+        }
+
+        top.m_Expect = top.m_IsObject ? expect_t::key : expect_t::value;
+    }
+
+    return stack.empty();
+}
+
+//------------------------------------------------------------------------------
+// CBOR
+//------------------------------------------------------------------------------
+// Major types, high 3 bits of initial byte of an item (RFC 8949, 3.1).
+enum cbor_major_t: uint8_t
+{
+    cbor_unsigned = 0,
+    cbor_negative = 1,
+    cbor_bytes    = 2,
+    cbor_text     = 3,
+    cbor_array    = 4,
+    cbor_map      = 5,
+    cbor_tag      = 6,
+    cbor_simple   = 7
+};
+
+static const uint8_t cbor_indefinite = 31; // additional information of indefinite length item
+static const uint8_t cbor_break      = 0xFF;
+static const uint8_t cbor_false      = 0xF4;
+static const uint8_t cbor_true       = 0xF5;
+static const uint8_t cbor_null       = 0xF6;
+static const uint8_t cbor_float      = 0xFA;
+static const uint8_t cbor_double     = 0xFB;
+
+// Tag 55799, self-described CBOR. No JSON text starts with these bytes.
+static const char cbor_self_describe[3] = { '\xD9', '\xD9', '\xF7' };
+
+static number half_to_number(uint16_t half)
+{
+    // RFC 8949, appendix D
+    const int exponent = (half >> 10) & 0x1F;
+    const int mantissa = half & 0x3FF;
+
+    number result;
+    if (exponent == 0)
+        result = std::ldexp(mantissa, -24);
+    else if (exponent != 31)
+        result = std::ldexp(mantissa + 1024, exponent - 25);
+    else
+        result = mantissa == 0 ? std::numeric_limits<number>::infinity() : std::numeric_limits<number>::quiet_NaN();
+
+    return (half & 0x8000) ? -result : result;
+}
+
+cbor_writer::cbor_writer(sink& out)
+    : m_Out(out)
+{
+}
+
+cbor_writer& cbor_writer::begin_object(size_t size)
+{
+    if (size == unknown_size)
+        m_Out.write(static_cast<char>(cbor_map << 5 | cbor_indefinite));
+    else
+        write_head(cbor_map, size);
+
+    m_Stack.push_back(size == unknown_size);
+
+    return *this;
+}
+
+cbor_writer& cbor_writer::end_object()
+{
+    end_structure();
+    return *this;
+}
+
+cbor_writer& cbor_writer::begin_array(size_t size)
+{
+    if (size == unknown_size)
+        m_Out.write(static_cast<char>(cbor_array << 5 | cbor_indefinite));
+    else
+        write_head(cbor_array, size);
+
+    m_Stack.push_back(size == unknown_size);
+
+    return *this;
+}
+
+cbor_writer& cbor_writer::end_array()
+{
+    end_structure();
+    return *this;
+}
+
+cbor_writer& cbor_writer::key(std::string_view name)
+{
+    return value(name);
+}
+
+cbor_writer& cbor_writer::value(null)
+{
+    m_Out.write(static_cast<char>(cbor_null));
+    return *this;
+}
+
+cbor_writer& cbor_writer::value(boolean v)
+{
+    m_Out.write(static_cast<char>(v ? cbor_true : cbor_false));
+    return *this;
+}
+
+cbor_writer& cbor_writer::value(number v)
+{
+    // Integers take as few bytes as their magnitude needs. Other numbers
+    // are written in single precision if that does not change them.
+    const number c_2_64 = 18446744073709551616.0;
+    if (std::isfinite(v) && std::trunc(v) == v && !(v == 0 && std::signbit(v)) && v > -c_2_64 && v < c_2_64)
+    {
+        if (v >= 0)
+            write_head(cbor_unsigned, static_cast<uint64_t>(v));
+        else
+            write_head(cbor_negative, static_cast<uint64_t>(-v) - 1);
+
+        return *this;
+    }
+
+    char bytes[9];
+    if (!(std::fabs(v) <= std::numeric_limits<float>::max()) || static_cast<double>(static_cast<float>(v)) != v)
+    {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        bytes[0] = static_cast<char>(cbor_double);
+        for (int i = 0; i < 8; ++i)
+            bytes[1 + i] = static_cast<char>(bits >> (56 - i * 8));
+        m_Out.write(bytes, 9);
+    }
+    else
+    {
+        const float single = static_cast<float>(v);
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        bytes[0] = static_cast<char>(cbor_float);
+        for (int i = 0; i < 4; ++i)
+            bytes[1 + i] = static_cast<char>(bits >> (24 - i * 8));
+        m_Out.write(bytes, 5);
+    }
+
+    return *this;
+}
+
+cbor_writer& cbor_writer::value(std::string_view v)
+{
+    write_head(cbor_text, v.size());
+    m_Out.write(v.data(), v.size());
+    return *this;
+}
+
+cbor_writer& cbor_writer::value(const crude_json::value& v)
+{
+    switch (v.type())
+    {
+        case type_t::object:
+            begin_object(v.get<object>().size());
+            for (auto& entry : v.get<object>())
+            {
+                key(entry.first);
+                value(entry.second);
+            }
+            return end_object();
+
+        case type_t::array:
+            begin_array(v.get<array>().size());
+            for (auto& entry : v.get<array>())
+                value(entry);
+            return end_array();
+
+        case type_t::string:
+            return value(v.view());
+
+        case type_t::boolean:
+            return value(v.get<boolean>());
+
+        case type_t::number:
+            return value(v.get<number>());
+
+        default:
+            // Discarded value still has to take its place in containers.
+            return value(nullptr);
+    }
+}
+
+cbor_writer& cbor_writer::self_describe()
+{
+    m_Out.write(cbor_self_describe, sizeof(cbor_self_describe));
+    return *this;
+}
+
+void cbor_writer::write_head(uint8_t major, uint64_t argument)
+{
+    // Argument follows initial byte in big endian order, unless it fits in it.
+    char bytes[9];
+    int  size = 0;
+    if (argument < 24)
+        bytes[0] = static_cast<char>(major << 5 | argument);
+    else if (argument <= 0xFF)
+        bytes[0] = static_cast<char>(major << 5 | 24), size = 1;
+    else if (argument <= 0xFFFF)
+        bytes[0] = static_cast<char>(major << 5 | 25), size = 2;
+    else if (argument <= 0xFFFFFFFF)
+        bytes[0] = static_cast<char>(major << 5 | 26), size = 4;
+    else
+        bytes[0] = static_cast<char>(major << 5 | 27), size = 8;
+
+    for (int i = 0; i < size; ++i)
+        bytes[1 + i] = static_cast<char>(argument >> ((size - 1 - i) * 8));
+
+    m_Out.write(bytes, static_cast<size_t>(1 + size));
+}
+
+void cbor_writer::end_structure()
+{
+    CRUDE_ASSERT(!m_Stack.empty());
+
+    if (m_Stack.back())
+        m_Out.write(static_cast<char>(cbor_break));
+
+    m_Stack.pop_back();
+}
+
+cbor_reader::cbor_reader(std::string_view data)
+    : m_Cursor(reinterpret_cast<const uint8_t*>(data.data()))
+    , m_End(m_Cursor + data.size())
+{
+}
+
+cbor_reader::token_t cbor_reader::next()
+{
+    if (!m_Stack.empty())
+    {
+        if (!m_Stack.back().m_Indefinite && m_Stack.back().m_Remaining == 0)
+        {
+            m_Stack.pop_back();
+            return token_t::end;
+        }
+    }
+    else if (m_Started)
+        return token_t::error;
+
+    if (m_Cursor == m_End)
+        return token_t::error;
+
+    auto initial = *m_Cursor++;
+    if (initial == cbor_break)
+    {
+        // Object cannot end between key and value.
+        if (m_Stack.empty() || !m_Stack.back().m_Indefinite || m_Stack.back().m_HasKey)
+            return token_t::error;
+
+        m_Stack.pop_back();
+        return token_t::end;
+    }
+
+    // Tags only annotate item which follows them.
+    while ((initial >> 5) == cbor_tag)
+    {
+        uint64_t tag;
+        if (!read_argument(initial & 0x1F, tag) || m_Cursor == m_End)
+            return token_t::error;
+
+        initial = *m_Cursor++;
+    }
+
+    m_Started = true;
+    if (!m_Stack.empty())
+    {
+        auto& top = m_Stack.back();
+        if (!top.m_Indefinite)
+            --top.m_Remaining;
+        if (top.m_IsObject)
+            top.m_HasKey = !top.m_HasKey;
+    }
+
+    const uint8_t info = initial & 0x1F;
+    uint64_t argument = 0;
+    switch (initial >> 5)
+    {
+        case cbor_unsigned:
+            if (!read_argument(info, argument))
+                return token_t::error;
+            m_Number = static_cast<number>(argument);
+            return token_t::number;
+
+        case cbor_negative:
+            if (!read_argument(info, argument))
+                return token_t::error;
+            m_Number = -1.0 - static_cast<number>(argument);
+            return token_t::number;
+
+        case cbor_bytes:
+        case cbor_text:
+            if (!read_argument(info, argument) || argument > remaining())
+                return token_t::error;
+            m_String = std::string_view(reinterpret_cast<const char*>(m_Cursor), static_cast<size_t>(argument));
+            m_Cursor += argument;
+            return token_t::string;
+
+        case cbor_array:
+            return begin_structure(false, info);
+
+        case cbor_map:
+            return begin_structure(true, info);
+
+        case cbor_simple:
+            switch (info)
+            {
+                case 20: m_Boolean = false; return token_t::boolean;
+                case 21: m_Boolean = true;  return token_t::boolean;
+                case 22: // null
+                case 23: // undefined
+                    return token_t::null;
+
+                case 25:
+                    if (!read_argument(info, argument))
+                        return token_t::error;
+                    m_Number = half_to_number(static_cast<uint16_t>(argument));
+                    return token_t::number;
+
+                case 26:
+                {
+                    if (!read_argument(info, argument))
+                        return token_t::error;
+                    const auto bits = static_cast<uint32_t>(argument);
+                    float single;
+                    memcpy(&single, &bits, sizeof(single));
+                    m_Number = single;
+                    return token_t::number;
+                }
+
+                case 27:
+                    if (!read_argument(info, argument))
+                        return token_t::error;
+                    memcpy(&m_Number, &argument, sizeof(m_Number));
+                    return token_t::number;
+
+                default:
+                    return token_t::error;
+            }
+
+        default:
+            return token_t::error;
+    }
+}
+
+cbor_reader::token_t cbor_reader::begin_structure(bool is_object, uint8_t info)
+{
+    uint64_t size = 0;
+
+    const bool indefinite = info == cbor_indefinite;
+    if (!indefinite)
+    {
+        // Every item takes at least one byte, larger sizes cannot be valid.
+        if (!read_argument(info, size) || size > remaining() / (is_object ? 2 : 1))
+            return token_t::error;
+    }
+
+    m_Size = indefinite ? unknown_size : static_cast<size_t>(size);
+    m_Stack.push_back({ is_object ? size * 2 : size, indefinite, is_object, false });
+
+    return is_object ? token_t::begin_object : token_t::begin_array;
+}
+
+bool cbor_reader::read_argument(uint8_t info, uint64_t& result)
+{
+    if (info < 24)
+    {
+        result = info;
+        return true;
+    }
+
+    if (info > 27)
+        return false;
+
+    const size_t size = size_t(1) << (info - 24);
+    if (remaining() < size)
+        return false;
+
+    result = 0;
+    for (size_t i = 0; i < size; ++i)
+        result = (result << 8) | *m_Cursor++;
 
     return true;
 }
 
+struct value::cbor_parser
+{
+    using token_t = cbor_reader::token_t;
+
+    // With 'input' arena strings are views into the input owned by the arena.
+    cbor_parser(std::string_view data, arena* input = nullptr)
+        : m_Reader(data)
+        , m_Arena(input)
+        , m_InSitu(input != nullptr)
+    {
+    }
+
+    value parse()
+    {
+        value v;
+
+        if (m_Arena)
+            m_Arena->retain();
+# if CRUDE_JSON_FLAT_OBJECT
+        else
+            m_Arena = arena::create();
+# endif
+
+        // Self-described CBOR tag is skipped by reader, like any other tag.
+        if (!accept_value(m_Reader.next(), v) || !m_Reader.done() || m_Reader.remaining() > 0)
+            v = value(type_t::discarded);
+
+        if (m_Arena)
+        {
+            m_Arena->release();
+            m_Arena = nullptr;
+        }
+
+        return v;
+    }
+
+private:
+    bool accept_value(token_t token, value& result)
+    {
+        switch (token)
+        {
+            case token_t::begin_object: return accept_object(result);
+            case token_t::begin_array:  return accept_array(result);
+            case token_t::string:       accept_string(result);                    return true;
+            case token_t::number:       result = m_Reader.number_value();         return true;
+            case token_t::boolean:      result = m_Reader.boolean_value();        return true;
+            case token_t::null:         result = nullptr;                         return true;
+            default:                    return false;
+        }
+    }
+
+    void accept_string(value& result)
+    {
+        // CBOR strings have no escapes, view is used as it is.
+        if (m_InSitu)
+            result = make_view(m_Reader.string_value(), false, m_Arena);
+        else
+            result = string(m_Reader.string_value());
+    }
+
+    bool accept_object(value& result)
+    {
+# if CRUDE_JSON_FLAT_OBJECT
+        object o(m_Arena);
+        if (m_Reader.size() != unknown_size)
+            o.reserve(m_Reader.size());
+# else
+        object o;
+# endif
+
+        while (true)
+        {
+            auto token = m_Reader.next();
+            if (token == token_t::end)
+                break;
+
+            // Keys have to be strings. They are copied straight from the input,
+            // unless object arena owns the input.
+            if (token != token_t::string)
+                return false;
+
+            auto key = m_Reader.string_value();
+
+            value v;
+            if (!accept_value(m_Reader.next(), v))
+                return false;
+
+# if CRUDE_JSON_FLAT_OBJECT
+            o.emplace(key, std::move(v));
+# else
+            o.emplace(string(key), std::move(v));
+# endif
+        }
+
+        result = std::move(o);
+        return true;
+    }
+
+    bool accept_array(value& result)
+    {
+        array a;
+        if (m_Reader.size() != unknown_size)
+            a.reserve(m_Reader.size());
+
+        while (true)
+        {
+            auto token = m_Reader.next();
+            if (token == token_t::end)
+                break;
+
+            value v;
+            if (!accept_value(token, v))
+                return false;
+
+            a.emplace_back(std::move(v));
+        }
+
+        result = std::move(a);
+        return true;
+    }
+
+    cbor_reader m_Reader;
+    arena*      m_Arena  = nullptr;
+    bool        m_InSitu = false;
+};
+
+string value::dump_cbor() const
+{
+    string result;
+    buffer_sink out(result);
+    dump_cbor_to(out);
+    return result;
+}
+
+bool value::dump_cbor_to(sink& out) const
+{
+    cbor_writer w(out);
+    w.self_describe();
+    w.value(*this);
+    return w.flush();
+}
+
+value value::parse_cbor(std::string_view data)
+{
+    return cbor_parser(data).parse();
+}
+
+document document::parse_cbor(string&& data)
+{
+    auto memory = arena::create();
+    memory->adopt(std::move(data));
+    return parse_cbor(memory);
+}
+
+document document::parse_cbor(const char* data, size_t size, void (*release)(void* user), void* user)
+{
+    auto memory = arena::create();
+    memory->adopt(data, size, release, user);
+    return parse_cbor(memory);
+}
+
+document document::parse_cbor(arena* memory)
+{
+    document result;
+    result.m_Arena = memory;
+
+    auto input = memory->input();
+    auto p = value::cbor_parser(input, memory);
+    result.m_Root = p.parse();
+
+    return result;
+}
+
+bool value::is_cbor(std::string_view data)
+{
+    return data.size() >= sizeof(cbor_self_describe) && memcmp(data.data(), cbor_self_describe, sizeof(cbor_self_describe)) == 0;
+}
+
+# if CRUDE_JSON_IO
+std::pair<value, bool> value::load(const string& path)
+{
+    // Modern C++, so beautiful...
+    std::unique_ptr<FILE, void(*)(FILE*)> file{nullptr, [](FILE* file) { if (file) fclose(file); }};
+# if defined(_MSC_VER) || (defined(__STDC_LIB_EXT1__) && __STDC_WANT_LIB_EXT1__)
+    FILE* handle = nullptr;
+    if (fopen_s(&handle, path.c_str(), "rb") != 0)
+        return {value{}, false};
+    file.reset(handle);
+# else
+    file.reset(fopen(path.c_str(), "rb"));
+# endif
+
+    if (!file)
+        return {value{}, false};
+
+    fseek(file.get(), 0, SEEK_END);
+    auto size = static_cast<size_t>(ftell(file.get()));
+    fseek(file.get(), 0, SEEK_SET);
+
+    string data;
+    data.resize(size);
+    if (fread(const_cast<char*>(data.data()), size, 1, file.get()) != 1)
+        return {value{}, false};
+
+    return {parse(data), true};
+}
+
+bool value::save(const string& path, const int indent, const char indent_char) const
+{
+    // Modern C++, so beautiful...
+    std::unique_ptr<FILE, void(*)(FILE*)> file{nullptr, [](FILE* file) { if (file) fclose(file); }};
+# if defined(_MSC_VER) || (defined(__STDC_LIB_EXT1__) && __STDC_WANT_LIB_EXT1__)
+    FILE* handle = nullptr;
+    if (fopen_s(&handle, path.c_str(), "wb") != 0)
+        return false;
+    file.reset(handle);
+# else
+    file.reset(fopen(path.c_str(), "wb"));
+# endif
+
+    if (!file)
+        return false;
+
+    file_sink out(file.get());
+
+    return dump_to(out, indent, indent_char);
+}
+
 # endif
 
 } // namespace crude_json
@@ -15,9 +15,13 @@
 
 # include <type_traits>
 # include <string>
+# include <string_view>
 # include <vector>
 # include <map>
+# include <atomic>
+# include <utility>
 # include <cstddef>
+# include <cstdint>
 # include <algorithm>
 # include <sstream>
 
@@ -30,17 +34,240 @@
 #     define CRUDE_JSON_IO 1
 # endif
 
+// When enabled objects keep members in insertion order in contiguous storage
+// allocated from arena of parsed document, otherwise std::map is used.
+# ifndef CRUDE_JSON_FLAT_OBJECT
+#     define CRUDE_JSON_FLAT_OBJECT 1
+# endif
+
+// When enabled io_stream_sink writes to SDL_IOStream.
+# ifndef CRUDE_JSON_SDL
+#     if __has_include(<SDL3/SDL_iostream.h>)
+#         define CRUDE_JSON_SDL 1
+#     else
+#         define CRUDE_JSON_SDL 0
+#     endif
+# endif
+
+# if CRUDE_JSON_IO
+#     include <cstdio>
+# endif
+
+# if CRUDE_JSON_SDL
+#     include <SDL3/SDL_iostream.h>
+# endif
+
+// When enabled parser skips whitespace and scans strings 16 bytes at a time
+// using SSE2 or NEON, if target supports one of them.
+# ifndef CRUDE_JSON_SIMD
+#     define CRUDE_JSON_SIMD 1
+# endif
+
 namespace crude_json {
 
 struct value;
 
 using string  = std::string;
+
+// Bump allocator shared by objects of one parsed document. Nothing is freed
+// until last object referencing the arena is destroyed. Not thread safe,
+// objects sharing an arena should be modified from one thread at a time.
+//
+// Arena of a document parsed in-situ also owns its input, see document.
+struct arena
+{
+    static arena* create();
+
+    void retain();
+    void release();
+
+    void* allocate(size_t size, size_t alignment);
+
+    size_t reserved() const { return m_Reserved; } // bytes taken from the heap
+
+    // Input is released with the arena.
+    void adopt(string&& text);
+    void adopt(const char* data, size_t size, void (*release)(void* user), void* user);
+
+    std::string_view input() const { return std::string_view(m_Input, m_InputSize); }
+
+    bool in_input(const char* pointer) const
+    {
+        return static_cast<size_t>(reinterpret_cast<uintptr_t>(pointer) - reinterpret_cast<uintptr_t>(m_Input)) < m_InputSize;
+    }
+
+private:
+    struct block
+    {
+        block* m_Next;
+    };
+
+    arena() = default;
+    ~arena();
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    std::atomic<int> m_RefCount{1};
+    block*           m_Blocks    = nullptr;
+    char*            m_Cursor    = nullptr;
+    char*            m_End       = nullptr;
+    size_t           m_Reserved  = 0;
+    string           m_Text;
+    const char*      m_Input     = nullptr;
+    size_t           m_InputSize = 0;
+    void           (*m_Release)(void* user) = nullptr;
+    void*            m_User      = nullptr;
+};
+
+# if CRUDE_JSON_FLAT_OBJECT
+// Key owned by the object it belongs to. Keys of documents parsed in-situ are
+// views into the input, so they are not null terminated.
+struct object_key
+{
+    const char* data()  const { return m_Data; }
+    size_t      size()  const { return m_Size; }
+    bool        empty() const { return m_Size == 0; }
+    uint32_t    hash()  const { return m_Hash; }
+
+    operator std::string_view() const { return std::string_view(m_Data, m_Size); }
+    operator string() const { return string(m_Data, m_Size); }
+
+    friend bool operator==(const object_key& lhs, std::string_view rhs) { return std::string_view(lhs) == rhs; }
+    friend bool operator!=(const object_key& lhs, std::string_view rhs) { return std::string_view(lhs) != rhs; }
+    friend bool operator< (const object_key& lhs, const object_key& rhs) { return std::string_view(lhs) < std::string_view(rhs); }
+
+    friend std::ostream& operator<<(std::ostream& out, const object_key& key) { return out.write(key.m_Data, key.m_Size); }
+
+    static uint32_t hash(std::string_view key);
+
+    const char* m_Data;
+    uint32_t    m_Size;
+    uint32_t    m_Hash;
+};
+
+// Members are kept in insertion order in one block of memory. Objects with
+// more than hash_threshold members are indexed by open addressing hash table,
+// smaller ones are scanned comparing key hashes first.
+//
+// Unlike std::map, inserting or erasing a member invalidates references and
+// iterators to other members of the same object.
+struct object
+{
+    using key_type       = object_key;
+    using mapped_type    = value;
+    using value_type     = std::pair<object_key, value>;
+    using iterator       =       value_type*;
+    using const_iterator = const value_type*;
+
+    static const size_t hash_threshold = 16;
+
+    object() = default;
+    explicit object(arena* memory);
+    object(const object& other); // copy is allocated from the heap
+    object(object&& other) noexcept;
+    ~object();
+
+    object& operator=(const object& other);
+    object& operator=(object&& other) noexcept;
+
+    iterator       begin()       { return m_Data; }
+    const_iterator begin() const { return m_Data; }
+    iterator       end();
+    const_iterator end()   const;
+
+    size_t size()  const { return m_Size; }
+    bool   empty() const { return m_Size == 0; }
+
+    iterator       find(std::string_view key);
+    const_iterator find(std::string_view key) const;
+    size_t         count(std::string_view key) const { return contains(key) ? 1 : 0; }
+    bool           contains(std::string_view key) const { return find_index(key, object_key::hash(key)) != npos; }
+
+    value& operator[](std::string_view key);
+
+    std::pair<iterator, bool> emplace(std::string_view key, value&& v);
+
+    iterator erase(const_iterator position);
+    size_t   erase(std::string_view key);
+    void     clear();
+
+    void reserve(size_t capacity);
+
+    void swap(object& other) noexcept;
+    inline friend void swap(object& lhs, object& rhs) noexcept { lhs.swap(rhs); }
+
+    arena* get_arena() const { return m_Arena; }
+
+private:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    void* allocate(size_t size, size_t alignment);
+    void  deallocate(void* pointer);
+
+    iterator append(std::string_view key, uint32_t hash, value&& v);
+    size_t   find_index(std::string_view key, uint32_t hash) const;
+    void     insert_index(uint32_t index);
+    void     rebuild_index();
+    uint32_t index_size() const;
+
+    value_type* m_Data     = nullptr;
+    uint32_t    m_Size     = 0;
+    uint32_t    m_Capacity = 0;
+    uint32_t*   m_Index    = nullptr; // index_size() slots of member index + 1, 0 for empty slot
+    arena*      m_Arena    = nullptr;
+};
+# else
 using object  = std::map<string, value>;
+# endif
+
 using array   = std::vector<value>;
 using number  = double;
 using boolean = bool;
 using null    = std::nullptr_t;
 
+// Destination of serialized text, see writer and value::dump_to().
+struct sink
+{
+    virtual ~sink() = default;
+
+    // Returns false when data could not be written.
+    virtual bool write(const char* data, size_t size) = 0;
+};
+
+// Appends to a string, which grows as needed.
+struct buffer_sink final: sink
+{
+    buffer_sink(string& buffer): m_Buffer(buffer) {}
+
+    bool write(const char* data, size_t size) override { m_Buffer.append(data, size); return true; }
+
+    string& m_Buffer;
+};
+
+# if CRUDE_JSON_IO
+// Writes to a file opened by the caller.
+struct file_sink final: sink
+{
+    file_sink(FILE* file): m_File(file) {}
+
+    bool write(const char* data, size_t size) override;
+
+    FILE* m_File;
+};
+# endif
+
+# if CRUDE_JSON_SDL
+// Writes to a stream opened by the caller.
+struct io_stream_sink final: sink
+{
+    io_stream_sink(SDL_IOStream* stream): m_Stream(stream) {}
+
+    bool write(const char* data, size_t size) override { return SDL_WriteIO(m_Stream, data, size) == size; }
+
+    SDL_IOStream* m_Stream;
+};
+# endif
+
 enum class type_t
 {
     null,
@@ -68,7 +295,7 @@ struct value
     value(const char*    v): m_Type(construct(m_Storage,           v))  {}
     value(      boolean  v): m_Type(construct(m_Storage,           v))  {}
     value(      number   v): m_Type(construct(m_Storage,           v))  {}
-    ~value() { destruct(m_Storage, m_Type); }
+    ~value() { destruct(m_Storage, m_Type, m_IsView); }
 
     value& operator=(value&& other)      { if (this != &other) { value(std::move(other)).swap(*this); } return *this; }
     value& operator=(const value& other) { if (this != &other) { value(          other).swap(*this);  } return *this; }
@@ -116,8 +343,16 @@ struct value
     template <typename T> const T* get_ptr() const;
     template <typename T>       T* get_ptr();
 
+    // String without copying it. Strings of document parsed in-situ are
+    // converted to std::string by get<string>(), but not by view().
+    std::string_view view() const;
+
     string dump(const int indent = -1, const char indent_char = ' ') const;
 
+    // Same as dump() but text is written to the sink as it is produced.
+    // Returns false if sink failed.
+    bool dump_to(sink& out, const int indent = -1, const char indent_char = ' ') const;
+
     void swap(value& other);
 
     inline friend void swap(value& lhs, value& rhs) { lhs.swap(rhs); }
@@ -125,6 +360,17 @@ struct value
     // Returns discarded value for invalid inputs.
     static value parse(const string& data);
 
+    // CBOR (RFC 8949) encoding. Output starts with self-described CBOR tag,
+    // so it can be told apart from JSON text by is_cbor().
+    string dump_cbor() const;
+    bool dump_cbor_to(sink& out) const;
+
+    // Returns discarded value for invalid inputs. Accepts data with or
+    // without self-described CBOR tag.
+    static value parse_cbor(std::string_view data);
+
+    static bool is_cbor(std::string_view data);
+
 # if CRUDE_JSON_IO
     static std::pair<value, bool> load(const string& path);
     bool save(const string& path, const int indent = -1, const char indent_char = ' ') const;
@@ -132,17 +378,36 @@ struct value
 
 private:
     struct parser;
+    struct cbor_parser;
+    friend struct document;
+    friend struct lazy_document;
+
+    // String of document parsed in-situ, view into its input.
+    struct string_ref
+    {
+        const char* m_Data;
+        size_t      m_Size;
+        arena*      m_Owner;    // retained, keeps input alive
+        bool        m_Escaped;  // decoded on first access
+    };
+
+    static value make_view(std::string_view data, bool escaped, arena* owner);
+
+    // Replaces string_ref by decoded std::string.
+    void own_string();
 
     // VS2015: std::max() is not constexpr yet.
 # define CRUDE_MAX2(a, b)           ((a) < (b) ? (b) : (a))
 # define CRUDE_MAX3(a, b, c)        CRUDE_MAX2(CRUDE_MAX2(a, b), c)
 # define CRUDE_MAX4(a, b, c, d)     CRUDE_MAX2(CRUDE_MAX3(a, b, c), d)
 # define CRUDE_MAX5(a, b, c, d, e)  CRUDE_MAX2(CRUDE_MAX4(a, b, c, d), e)
+# define CRUDE_MAX6(a, b, c, d, e, f) CRUDE_MAX2(CRUDE_MAX5(a, b, c, d, e), f)
     enum
     {
-        max_size  = CRUDE_MAX5( sizeof(string),  sizeof(object),  sizeof(array),  sizeof(number),  sizeof(boolean)),
-        max_align = CRUDE_MAX5(alignof(string), alignof(object), alignof(array), alignof(number), alignof(boolean))
+        max_size  = CRUDE_MAX6( sizeof(string),  sizeof(object),  sizeof(array),  sizeof(number),  sizeof(boolean),  sizeof(string_ref)),
+        max_align = CRUDE_MAX6(alignof(string), alignof(object), alignof(array), alignof(number), alignof(boolean), alignof(string_ref))
     };
+# undef CRUDE_MAX6
 # undef CRUDE_MAX5
 # undef CRUDE_MAX4
 # undef CRUDE_MAX3
@@ -159,6 +424,8 @@ private:
     static const boolean* boolean_ptr(const storage_t& storage) { return reinterpret_cast<const boolean*>(storage.data); }
     static       number*   number_ptr(      storage_t& storage) { return reinterpret_cast<       number*>(storage.data); }
     static const number*   number_ptr(const storage_t& storage) { return reinterpret_cast<const  number*>(storage.data); }
+    static       string_ref* string_ref_ptr(      storage_t& storage) { return reinterpret_cast<      string_ref*>(storage.data); }
+    static const string_ref* string_ref_ptr(const storage_t& storage) { return reinterpret_cast<const string_ref*>(storage.data); }
 
     static type_t construct(storage_t& storage, type_t type)
     {
@@ -186,65 +453,443 @@ private:
     static type_t construct(storage_t& storage,       boolean  value) { new (storage.data) boolean(value);                        return type_t::boolean; }
     static type_t construct(storage_t& storage,       number   value) { new (storage.data)  number(value);                        return type_t::number;  }
 
-    static void destruct(storage_t& storage, type_t type)
+    static void destruct(storage_t& storage, type_t type, bool is_view)
     {
         switch (type)
         {
             case type_t::object: object_ptr(storage)->~object(); break;
             case type_t::array:   array_ptr(storage)->~array();  break;
-            case type_t::string: string_ptr(storage)->~string(); break;
+            case type_t::string:
+                if (is_view)
+                    string_ref_ptr(storage)->m_Owner->release();
+                else
+                    string_ptr(storage)->~string();
+                break;
             default: break;
         }
     }
 
-    struct dump_context_t
-    {
-        std::ostringstream out;
-        const int  indent = -1;
-        const char indent_char = ' ';
-
-        // VS2015: Aggregate initialization isn't a thing yet.
-        dump_context_t(const int indent, const char indent_char)
-            : indent(indent)
-            , indent_char(indent_char)
-        {
-        }
-
-        void write_indent(int level);
-        void write_separator();
-        void write_newline();
-    };
-
-    void dump(dump_context_t& context, int level) const;
-
     storage_t m_Storage;
     type_t    m_Type;
+    bool      m_IsView = false; // string is string_ref
 };
 
 template <> inline const object&  value::get<object>()  const { CRUDE_ASSERT(m_Type == type_t::object);  return *object_ptr(m_Storage);  }
 template <> inline const array&   value::get<array>()   const { CRUDE_ASSERT(m_Type == type_t::array);   return *array_ptr(m_Storage);   }
-template <> inline const string&  value::get<string>()  const { CRUDE_ASSERT(m_Type == type_t::string);  return *string_ptr(m_Storage);  }
+template <> inline const string&  value::get<string>()  const { CRUDE_ASSERT(m_Type == type_t::string);  if (m_IsView) const_cast<value*>(this)->own_string(); return *string_ptr(m_Storage); }
 template <> inline const boolean& value::get<boolean>() const { CRUDE_ASSERT(m_Type == type_t::boolean); return *boolean_ptr(m_Storage); }
 template <> inline const number&  value::get<number>()  const { CRUDE_ASSERT(m_Type == type_t::number);  return *number_ptr(m_Storage);  }
 
 template <> inline       object&  value::get<object>()        { CRUDE_ASSERT(m_Type == type_t::object);  return *object_ptr(m_Storage);  }
 template <> inline       array&   value::get<array>()         { CRUDE_ASSERT(m_Type == type_t::array);   return *array_ptr(m_Storage);   }
-template <> inline       string&  value::get<string>()        { CRUDE_ASSERT(m_Type == type_t::string);  return *string_ptr(m_Storage);  }
+template <> inline       string&  value::get<string>()        { CRUDE_ASSERT(m_Type == type_t::string);  if (m_IsView) own_string(); return *string_ptr(m_Storage); }
 template <> inline       boolean& value::get<boolean>()       { CRUDE_ASSERT(m_Type == type_t::boolean); return *boolean_ptr(m_Storage); }
 template <> inline       number&  value::get<number>()        { CRUDE_ASSERT(m_Type == type_t::number);  return *number_ptr(m_Storage);  }
 
 template <> inline const object*  value::get_ptr<object>()  const { if (m_Type == type_t::object)  return object_ptr(m_Storage);  else return nullptr; }
 template <> inline const array*   value::get_ptr<array>()   const { if (m_Type == type_t::array)   return array_ptr(m_Storage);   else return nullptr; }
-template <> inline const string*  value::get_ptr<string>()  const { if (m_Type == type_t::string)  return string_ptr(m_Storage);  else return nullptr; }
+template <> inline const string*  value::get_ptr<string>()  const { if (m_Type == type_t::string)  return &get<string>();         else return nullptr; }
 template <> inline const boolean* value::get_ptr<boolean>() const { if (m_Type == type_t::boolean) return boolean_ptr(m_Storage); else return nullptr; }
 template <> inline const number*  value::get_ptr<number>()  const { if (m_Type == type_t::number)  return number_ptr(m_Storage);  else return nullptr; }
 
 template <> inline       object*  value::get_ptr<object>()        { if (m_Type == type_t::object)  return object_ptr(m_Storage);  else return nullptr; }
 template <> inline       array*   value::get_ptr<array>()         { if (m_Type == type_t::array)   return array_ptr(m_Storage);   else return nullptr; }
-template <> inline       string*  value::get_ptr<string>()        { if (m_Type == type_t::string)  return string_ptr(m_Storage);  else return nullptr; }
+template <> inline       string*  value::get_ptr<string>()        { if (m_Type == type_t::string)  return &get<string>();         else return nullptr; }
 template <> inline       boolean* value::get_ptr<boolean>()       { if (m_Type == type_t::boolean) return boolean_ptr(m_Storage); else return nullptr; }
 template <> inline       number*  value::get_ptr<number>()        { if (m_Type == type_t::number)  return number_ptr(m_Storage);  else return nullptr; }
 
+// Document parsed in-situ. Strings and member keys are not copied out of the
+// input, they are views into it. Document owns the input, which is released
+// when the document and every value referencing the input are destroyed, so
+// values may be moved or copied out of the document and outlive it.
+//
+// Strings containing escapes are decoded on first access. Decoding modifies
+// the value, so reading such string from many threads at once is not safe.
+// Keys with escapes are decoded while parsing. Copied objects own their keys.
+//
+// CBOR input is parsed the same way, strings and keys are views into it.
+//
+//   auto doc = document::parse(std::move(text));
+//   auto name = doc.root()["name"].view();
+struct document
+{
+    document() = default;
+    document(document&& other) noexcept;
+    ~document();
+
+    document& operator=(document&& other) noexcept;
+
+    document(const document&) = delete;
+    document& operator=(const document&) = delete;
+
+    // Text is moved into the document. Returns discarded root for invalid inputs.
+    static document parse(string&& text);
+
+    // Input owned by the caller, like memory mapped file. It must stay unchanged
+    // until 'release' is called with 'user', which happens when nothing
+    // references the input anymore. Without 'release' input has to outlive
+    // everything parsed from it.
+    static document parse(const char* data, size_t size, void (*release)(void* user) = nullptr, void* user = nullptr);
+
+    // Same for CBOR, see value::parse_cbor().
+    static document parse_cbor(string&& data);
+    static document parse_cbor(const char* data, size_t size, void (*release)(void* user) = nullptr, void* user = nullptr);
+
+          value& root()       { return m_Root; }
+    const value& root() const { return m_Root; }
+
+    bool is_discarded() const { return m_Root.is_discarded(); }
+
+    std::string_view text() const { return m_Arena ? m_Arena->input() : std::string_view(); }
+
+private:
+    static document parse(arena* memory);
+    static document parse_cbor(arena* memory);
+
+    value  m_Root;
+    arena* m_Arena = nullptr;
+};
+
+struct lazy_document;
+struct lazy_iterator;
+
+// Value of lazy_document, not parsed until parse() is called. Small handle,
+// valid as long as the document it came from is not moved or destroyed.
+// Default constructed handle is discarded.
+struct lazy_value
+{
+    type_t type() const; // guessed from first character, discarded when value is missing
+
+    bool is_null()      const { return type() == type_t::null;      }
+    bool is_object()    const { return type() == type_t::object;    }
+    bool is_array()     const { return type() == type_t::array;     }
+    bool is_string()    const { return type() == type_t::string;    }
+    bool is_boolean()   const { return type() == type_t::boolean;   }
+    bool is_number()    const { return type() == type_t::number;    }
+    bool is_discarded() const { return type() == type_t::discarded; }
+
+    // Member of object or element of array, discarded if there is none.
+    // Members are searched linearly, iterate once to index large objects.
+    lazy_value operator[](std::string_view key) const;
+    lazy_value operator[](size_t index) const;
+
+    bool contains(std::string_view key) const { return !(*this)[key].is_discarded(); }
+
+    // Number of members or elements, they are counted on every call.
+    size_t size() const;
+
+    lazy_iterator begin() const;
+    lazy_iterator end() const;
+
+    // JSON text of the value.
+    std::string_view text() const;
+
+    // Parses value with everything in it. Result does not reference the
+    // document. Returns discarded value for invalid text.
+    value parse() const;
+
+    // True if parse() would succeed. Only scalars are checked, the rest was
+    // checked by the index, so no values are built for objects and arrays.
+    bool is_valid() const;
+
+private:
+    friend struct lazy_document;
+    friend struct lazy_iterator;
+
+    const lazy_document* m_Document = nullptr;
+    uint32_t             m_Begin    = 0; // text of the value
+    uint32_t             m_End      = 0;
+    uint32_t             m_Entry    = 0; // opening bracket of object or array in structural index
+};
+
+// Iterates members of object or elements of array.
+struct lazy_iterator
+{
+    const lazy_value& operator*()  const { return  m_Value; }
+    const lazy_value* operator->() const { return &m_Value; }
+
+    lazy_iterator& operator++();
+
+    // Key of current member with escapes decoded, empty for array elements.
+    std::string_view key() const { return m_KeyEscaped ? std::string_view(m_DecodedKey) : m_Key; }
+
+    friend bool operator==(const lazy_iterator& lhs, const lazy_iterator& rhs) { return lhs.m_Separator == rhs.m_Separator; }
+    friend bool operator!=(const lazy_iterator& lhs, const lazy_iterator& rhs) { return lhs.m_Separator != rhs.m_Separator; }
+
+private:
+    friend struct lazy_value;
+
+    void read();
+
+    const lazy_document* m_Document  = nullptr;
+    uint32_t             m_Separator = 0; // bracket or comma before current item in structural index
+    uint32_t             m_Next      = 0; // comma or bracket after current item
+    uint32_t             m_Close     = 0; // closing bracket
+    bool                 m_IsObject  = false;
+    bool                 m_KeyEscaped = false;
+    lazy_value           m_Value;
+    std::string_view     m_Key;
+    string               m_DecodedKey;
+};
+
+// Document parsed on demand. parse() only indexes structure of the text,
+// the way stage 1 of simdjson does: positions of brackets, colons and commas
+// outside of strings are collected 64 bytes at a time and brackets are paired.
+// Values are parsed when asked for, opening a large document of which small
+// part is used does not pay for the rest.
+//
+// Brackets, strings and separators are checked by parse(), values are checked
+// only when they are parsed. Document is not modified after parse(), so it may
+// be read from many threads.
+//
+//   auto doc  = lazy_document::parse(std::move(text));
+//   auto zoom = doc.root()["view"]["zoom"].parse();
+struct lazy_document
+{
+    lazy_document() = default;
+    lazy_document(lazy_document&& other) noexcept;
+    ~lazy_document();
+
+    lazy_document& operator=(lazy_document&& other) noexcept;
+
+    lazy_document(const lazy_document&) = delete;
+    lazy_document& operator=(const lazy_document&) = delete;
+
+    // Same ownership of input as document::parse().
+    static lazy_document parse(string&& text);
+    static lazy_document parse(const char* data, size_t size, void (*release)(void* user) = nullptr, void* user = nullptr);
+
+    // Discarded for unbalanced brackets, unterminated strings, misplaced
+    // separators and inputs of 4GB or more.
+    bool is_discarded() const { return !m_Valid; }
+
+    lazy_value root() const;
+
+    std::string_view text() const { return m_Arena ? m_Arena->input() : std::string_view(); }
+
+    size_t structural_count() const { return m_Structurals.size(); }
+
+private:
+    friend struct lazy_value;
+    friend struct lazy_iterator;
+
+    struct structural
+    {
+        uint32_t m_Position;    // in text
+        uint32_t m_Match;       // matching bracket in index, for brackets only
+    };
+
+    static lazy_document parse(arena* memory);
+
+    static value parse_text(std::string_view text);
+    static bool  read_string(std::string_view text, string& result);
+
+    bool index();
+    bool pair_brackets();
+
+    // Item between structural 'separator' and the next one, 'next' is set to
+    // structural following the item.
+    lazy_value item_after(uint32_t separator, uint32_t& next) const;
+
+    std::vector<structural> m_Structurals;
+    arena*                  m_Arena = nullptr;
+    bool                    m_Valid = false;
+};
+
+// Size of objects and arrays of indefinite length.
+const size_t unknown_size = static_cast<size_t>(-1);
+
+// Collects small writes and passes them to a sink in larger chunks.
+struct buffered_sink
+{
+    explicit buffered_sink(sink& out): m_Sink(out) {}
+    ~buffered_sink() { flush(); }
+
+    buffered_sink(const buffered_sink&) = delete;
+    buffered_sink& operator=(const buffered_sink&) = delete;
+
+    void write(char c)
+    {
+        if (m_Size == sizeof(m_Buffer))
+            flush();
+
+        m_Buffer[m_Size++] = c;
+    }
+
+    void write(const char* data, size_t size);
+
+    // Returns false if any write failed.
+    bool flush();
+
+    bool good() const { return m_Good; }
+
+private:
+    sink&  m_Sink;
+    bool   m_Good = true;
+    size_t m_Size = 0;
+    char   m_Buffer[4096];
+};
+
+// Writes JSON text token by token, without building a document first.
+// Output is buffered and passed to the sink in chunks, memory used by
+// writer depends only on nesting depth. Formatting matches value::dump().
+//
+//   writer out(sink);
+//   out.begin_object();
+//   out.key("zoom").value(1.0);
+//   out.end_object();
+//   bool ok = out.flush();
+struct writer
+{
+    writer(sink& out, const int indent = -1, const char indent_char = ' ');
+
+    // Size is not needed for JSON, it is accepted so code can be shared with cbor_writer.
+    writer& begin_object(size_t size = unknown_size);
+    writer& end_object();
+    writer& begin_array(size_t size = unknown_size);
+    writer& end_array();
+
+    // Name of next member of current object.
+    writer& key(std::string_view name);
+
+    writer& value(null);
+    writer& value(boolean v);
+    writer& value(number v);
+    writer& value(int v)                 { return value(static_cast<number>(v)); }
+    writer& value(std::string_view v);
+    writer& value(const char* v)         { return value(std::string_view(v)); }
+    writer& value(const string& v)       { return value(std::string_view(v)); }
+    writer& value(const crude_json::value& v);
+
+    // Already serialized JSON value, written as is.
+    writer& raw_value(std::string_view json);
+
+    // Passes buffered output to the sink. Returns false if any write failed.
+    bool flush() { return m_Out.flush(); }
+
+    bool good() const { return m_Out.good(); }
+
+private:
+    struct frame
+    {
+        bool m_IsObject;
+        bool m_HasMembers;
+    };
+
+    void begin_value(bool structured = false);
+    void begin_structure(bool is_object, char c);
+    void end_structure(bool is_object, char c);
+
+    void write_string(std::string_view s);
+    void write_indent(size_t level);
+    void write_newline();
+
+    buffered_sink      m_Out;
+    const int          m_Indent;
+    const char         m_IndentChar;
+    bool               m_HasKey = false;
+    std::vector<frame> m_Stack;
+};
+
+// Writes CBOR items with the same interface as writer. Objects and arrays
+// begun without size are encoded with indefinite length.
+struct cbor_writer
+{
+    explicit cbor_writer(sink& out);
+
+    cbor_writer& begin_object(size_t size = unknown_size); // size is number of members
+    cbor_writer& end_object();
+    cbor_writer& begin_array(size_t size = unknown_size);
+    cbor_writer& end_array();
+
+    cbor_writer& key(std::string_view name);
+
+    cbor_writer& value(null);
+    cbor_writer& value(boolean v);
+    cbor_writer& value(number v);
+    cbor_writer& value(int v)                 { return value(static_cast<number>(v)); }
+    cbor_writer& value(std::string_view v);
+    cbor_writer& value(const char* v)         { return value(std::string_view(v)); }
+    cbor_writer& value(const string& v)       { return value(std::string_view(v)); }
+    cbor_writer& value(const crude_json::value& v);
+
+    // Self-described CBOR tag, should precede top level item.
+    cbor_writer& self_describe();
+
+    bool flush() { return m_Out.flush(); }
+
+    bool good() const { return m_Out.good(); }
+
+private:
+    void write_head(uint8_t major, uint64_t argument);
+    void end_structure();
+
+    buffered_sink     m_Out;
+    std::vector<bool> m_Stack; // true for containers of indefinite length
+};
+
+// Reads CBOR items one by one. Strings are views into the input, which has
+// to outlive them. Indefinite length strings are not supported, tags are
+// skipped and integers are read as numbers.
+struct cbor_reader
+{
+    enum class token_t
+    {
+        begin_object,
+        begin_array,
+        end,            // closes last object or array, of definite length or not
+        string,         // text and byte strings
+        number,
+        boolean,
+        null,
+        error           // malformed or unsupported input, or read past the top level item
+    };
+
+    explicit cbor_reader(std::string_view data);
+
+    token_t next();
+
+    // Size of object or array just begun, number of members for objects.
+    // unknown_size for indefinite length.
+    size_t size() const { return m_Size; }
+
+    std::string_view string_value()  const { return m_String; }
+    number           number_value()  const { return m_Number; }
+    boolean          boolean_value() const { return m_Boolean; }
+
+    // True when top level item was read completely.
+    bool done() const { return m_Started && m_Stack.empty(); }
+
+    // Input left after top level item.
+    size_t remaining() const { return static_cast<size_t>(m_End - m_Cursor); }
+
+private:
+    struct frame
+    {
+        uint64_t m_Remaining;   // items left, both keys and values are counted for objects
+        bool     m_Indefinite;
+        bool     m_IsObject;
+        bool     m_HasKey;      // odd number of items read from object so far
+    };
+
+    token_t begin_structure(bool is_object, uint8_t info);
+    bool    read_argument(uint8_t info, uint64_t& result);
+
+    const uint8_t*     m_Cursor;
+    const uint8_t*     m_End;
+    std::vector<frame> m_Stack;
+    bool               m_Started = false;
+    size_t             m_Size    = 0;
+    std::string_view   m_String;
+    number             m_Number  = 0.0;
+    boolean            m_Boolean = false;
+};
+
+# if CRUDE_JSON_FLAT_OBJECT
+inline object::iterator       object::end()       { return m_Data + m_Size; }
+inline object::const_iterator object::end() const { return m_Data + m_Size; }
+# endif
+
 } // namespace crude_json
 
 # endif // __CRUDE_JSON_H__
\ No newline at end of file
@@ -3,6 +3,27 @@
 # endif
 # include "imgui_canvas.h"
 # include <type_traits>
+# include <cstddef> // offsetof
+
+# if !defined(IMGUI_EX_CANVAS_NO_SIMD)
+#     if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#         define IMGUI_EX_CANVAS_SSE2 1
+#         include <emmintrin.h>
+#         if defined(_MSC_VER) && !defined(__clang__)
+#             define IMGUI_EX_CANVAS_AVX2 1
+#             define IMGUI_EX_CANVAS_TARGET_AVX2
+#             include <immintrin.h>
+#             include <intrin.h>
+#         elif defined(__GNUC__) || defined(__clang__)
+#             define IMGUI_EX_CANVAS_AVX2 1
+#             define IMGUI_EX_CANVAS_TARGET_AVX2 __attribute__((target("avx2")))
+#             include <immintrin.h>
+#         endif
+#     elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#         define IMGUI_EX_CANVAS_NEON 1
+#         include <arm_neon.h>
+#     endif
+# endif
 
 // https://stackoverflow.com/a/36079786
 # define DECLARE_HAS_MEMBER(__trait_name__, __member_name__)                         \
@@ -73,6 +94,187 @@ struct VtxCurrentOffsetRef
     }
 };
 
+// Vertex transform kernels used to move canvas content to screen space.
+//
+// Vector variants process few vertices at once and treat them as an array
+// of floats. Only 'pos' lanes are transformed, 'uv' and 'col' lanes are
+// copied back bit exact with a mask. This depends on default ImDrawVert
+// layout, custom layouts always use scalar variant.
+static constexpr bool c_DefaultVertexLayout =
+    sizeof(ImDrawVert) == 5 * sizeof(float) && offsetof(ImDrawVert, pos) == 0;
+
+using TransformVerticesFn = void (*)(ImDrawVert* vertex, ImDrawVert* vertexEnd, float scale, const ImVec2& offset);
+
+static void TransformVerticesScalar(ImDrawVert* vertex, ImDrawVert* vertexEnd, float scale, const ImVec2& offset)
+{
+    while (vertex < vertexEnd)
+    {
+        vertex->pos.x = vertex->pos.x * scale + offset.x;
+        vertex->pos.y = vertex->pos.y * scale + offset.y;
+        ++vertex;
+    }
+}
+
+// Fills scale, offset and mask pattern for 'count' floats of vertex data.
+static void BuildTransformPattern(float* scales, float* offsets, unsigned int* masks, int count, float scale, const ImVec2& offset)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const int lane = i % 5;
+        scales[i]  = lane < 2 ? scale : 1.0f;
+        offsets[i] = lane == 0 ? offset.x : (lane == 1 ? offset.y : 0.0f);
+        masks[i]   = lane < 2 ? 0xFFFFFFFFu : 0u;
+    }
+}
+
+# if IMGUI_EX_CANVAS_SSE2
+static void TransformVerticesSSE2(ImDrawVert* vertex, ImDrawVert* vertexEnd, float scale, const ImVec2& offset)
+{
+    // 4 vertices = 20 floats = 5 registers
+    alignas(16) float        scales[20];
+    alignas(16) float        offsets[20];
+    alignas(16) unsigned int masks[20];
+    BuildTransformPattern(scales, offsets, masks, 20, scale, offset);
+
+    __m128 s[5], o[5], m[5];
+    for (int i = 0; i < 5; ++i)
+    {
+        s[i] = _mm_load_ps(scales + i * 4);
+        o[i] = _mm_load_ps(offsets + i * 4);
+        m[i] = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(masks + i * 4)));
+    }
+
+    while (vertexEnd - vertex >= 4)
+    {
+        auto data = reinterpret_cast<float*>(vertex);
+        for (int i = 0; i < 5; ++i)
+        {
+            const __m128 v = _mm_loadu_ps(data + i * 4);
+            const __m128 r = _mm_add_ps(_mm_mul_ps(v, s[i]), o[i]);
+            _mm_storeu_ps(data + i * 4, _mm_or_ps(_mm_and_ps(m[i], r), _mm_andnot_ps(m[i], v)));
+        }
+        vertex += 4;
+    }
+
+    TransformVerticesScalar(vertex, vertexEnd, scale, offset);
+}
+# endif
+
+# if IMGUI_EX_CANVAS_AVX2
+IMGUI_EX_CANVAS_TARGET_AVX2
+static void TransformVerticesAVX2(ImDrawVert* vertex, ImDrawVert* vertexEnd, float scale, const ImVec2& offset)
+{
+    // 8 vertices = 40 floats = 5 registers
+    alignas(32) float        scales[40];
+    alignas(32) float        offsets[40];
+    alignas(32) unsigned int masks[40];
+    BuildTransformPattern(scales, offsets, masks, 40, scale, offset);
+
+    __m256 s[5], o[5], m[5];
+    for (int i = 0; i < 5; ++i)
+    {
+        s[i] = _mm256_load_ps(scales + i * 8);
+        o[i] = _mm256_load_ps(offsets + i * 8);
+        m[i] = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(masks + i * 8)));
+    }
+
+    while (vertexEnd - vertex >= 8)
+    {
+        auto data = reinterpret_cast<float*>(vertex);
+        for (int i = 0; i < 5; ++i)
+        {
+            const __m256 v = _mm256_loadu_ps(data + i * 8);
+            const __m256 r = _mm256_add_ps(_mm256_mul_ps(v, s[i]), o[i]);
+            _mm256_storeu_ps(data + i * 8, _mm256_blendv_ps(v, r, m[i]));
+        }
+        vertex += 8;
+    }
+
+    TransformVerticesScalar(vertex, vertexEnd, scale, offset);
+}
+
+static bool HasAVX2()
+{
+#     if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // OS must save YMM registers
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx     = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#     else
+    return __builtin_cpu_supports("avx2") != 0;
+#     endif
+}
+# endif
+
+# if IMGUI_EX_CANVAS_NEON
+static void TransformVerticesNEON(ImDrawVert* vertex, ImDrawVert* vertexEnd, float scale, const ImVec2& offset)
+{
+    // 4 vertices = 20 floats = 5 registers
+    float        scales[20];
+    float        offsets[20];
+    unsigned int masks[20];
+    BuildTransformPattern(scales, offsets, masks, 20, scale, offset);
+
+    float32x4_t s[5], o[5];
+    uint32x4_t  m[5];
+    for (int i = 0; i < 5; ++i)
+    {
+        s[i] = vld1q_f32(scales + i * 4);
+        o[i] = vld1q_f32(offsets + i * 4);
+        m[i] = vld1q_u32(masks + i * 4);
+    }
+
+    while (vertexEnd - vertex >= 4)
+    {
+        auto data = reinterpret_cast<float*>(vertex);
+        for (int i = 0; i < 5; ++i)
+        {
+            const float32x4_t v = vld1q_f32(data + i * 4);
+            const float32x4_t r = vaddq_f32(vmulq_f32(v, s[i]), o[i]);
+            vst1q_f32(data + i * 4, vbslq_f32(m[i], r, v));
+        }
+        vertex += 4;
+    }
+
+    TransformVerticesScalar(vertex, vertexEnd, scale, offset);
+}
+# endif
+
+static TransformVerticesFn SelectTransformVertices()
+{
+    if (!c_DefaultVertexLayout)
+        return &TransformVerticesScalar;
+
+# if IMGUI_EX_CANVAS_AVX2
+    if (HasAVX2())
+        return &TransformVerticesAVX2;
+# endif
+# if IMGUI_EX_CANVAS_SSE2
+    return &TransformVerticesSSE2;
+# elif IMGUI_EX_CANVAS_NEON
+    return &TransformVerticesNEON;
+# else
+    return &TransformVerticesScalar;
+# endif
+}
+
+static void TransformVertices(ImDrawVert* vertex, ImDrawVert* vertexEnd, float scale, const ImVec2& offset)
+{
+    static const TransformVerticesFn transform = SelectTransformVertices();
+
+    transform(vertex, vertexEnd, scale, offset);
+}
+
 } // namespace ImCanvasDetails
 
 // Returns a reference to _FringeScale extension to ImDrawList
@@ -166,6 +368,18 @@ void ImGuiEx::Canvas::End()
 
     LeaveLocalSpace();
 
+# if IMGUI_EX_CANVAS_DEFERED()
+    // Move vertices of all recorded ranges to screen space.
+    for (auto& range : m_Ranges)
+    {
+        auto vertex    = m_DrawList->VtxBuffer.Data + range.BeginVertexIndex;
+        auto vertexEnd = m_DrawList->VtxBuffer.Data + range.EndVertexIndex;
+
+        ImCanvasDetails::TransformVertices(vertex, vertexEnd, range.Scale, range.Offset);
+    }
+    m_Ranges.resize(0);
+# endif
+
     ImGui::GetCurrentWindow()->DC.CursorMaxPos = m_WindowCursorMaxBackup;
 
 # if IMGUI_VERSION_NUM < 18967
@@ -482,56 +696,45 @@ void ImGuiEx::Canvas::LeaveLocalSpace()
 
     m_CurrentRange->EndVertexIndex  = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
     m_CurrentRange->EndCommandIndex = m_DrawList->CmdBuffer.size();
+    m_CurrentRange->Offset          = m_ViewTransformPosition;
+    m_CurrentRange->Scale           = m_View.Scale;
     if (m_CurrentRange->BeginVertexIndex == m_CurrentRange->EndVertexIndex)
     {
         // Drop empty range
         m_Ranges.resize(m_Ranges.Size - 1);
     }
+    else if (m_Ranges.Size > 1)
+    {
+        // Merge with previous range if nothing was drawn in between
+        auto& previous = m_Ranges[m_Ranges.Size - 2];
+        if (previous.EndVertexIndex == m_CurrentRange->BeginVertexIndex
+            && previous.Scale == m_CurrentRange->Scale
+            && previous.Offset.x == m_CurrentRange->Offset.x
+            && previous.Offset.y == m_CurrentRange->Offset.y)
+        {
+            previous.EndVertexIndex  = m_CurrentRange->EndVertexIndex;
+            previous.EndCommandIndex = m_CurrentRange->EndCommandIndex;
+            m_Ranges.resize(m_Ranges.Size - 1);
+        }
+    }
     m_CurrentRange = nullptr;
-# endif
-
+# else
     // Move vertices to screen space.
     auto vertex    = m_DrawList->VtxBuffer.Data + m_DrawListStartVertexIndex;
     auto vertexEnd = m_DrawList->VtxBuffer.Data + m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
 
-    // If canvas view is not scaled take a faster path.
-    if (m_View.Scale != 1.0f)
-    {
-        while (vertex < vertexEnd)
-        {
-            vertex->pos.x = vertex->pos.x * m_View.Scale + m_ViewTransformPosition.x;
-            vertex->pos.y = vertex->pos.y * m_View.Scale + m_ViewTransformPosition.y;
-            ++vertex;
-        }
+    ImCanvasDetails::TransformVertices(vertex, vertexEnd, m_View.Scale, m_ViewTransformPosition);
+# endif
 
-        // Move clip rectangles to screen space.
-        for (int i = m_DrawListFirstCommandIndex; i < m_DrawList->CmdBuffer.size(); ++i)
-        {
-            auto& command = m_DrawList->CmdBuffer[i];
-            command.ClipRect.x = command.ClipRect.x * m_View.Scale + m_ViewTransformPosition.x;
-            command.ClipRect.y = command.ClipRect.y * m_View.Scale + m_ViewTransformPosition.y;
-            command.ClipRect.z = command.ClipRect.z * m_View.Scale + m_ViewTransformPosition.x;
-            command.ClipRect.w = command.ClipRect.w * m_View.Scale + m_ViewTransformPosition.y;
-        }
-    }
-    else
+    // Move clip rectangles to screen space. Command indices are valid only
+    // until channel is changed, so this is never deferred.
+    for (int i = m_DrawListFirstCommandIndex; i < m_DrawList->CmdBuffer.size(); ++i)
     {
-        while (vertex < vertexEnd)
-        {
-            vertex->pos.x = vertex->pos.x + m_ViewTransformPosition.x;
-            vertex->pos.y = vertex->pos.y + m_ViewTransformPosition.y;
-            ++vertex;
-        }
-
-        // Move clip rectangles to screen space.
-        for (int i = m_DrawListFirstCommandIndex; i < m_DrawList->CmdBuffer.size(); ++i)
-        {
-            auto& command = m_DrawList->CmdBuffer[i];
-            command.ClipRect.x = command.ClipRect.x + m_ViewTransformPosition.x;
-            command.ClipRect.y = command.ClipRect.y + m_ViewTransformPosition.y;
-            command.ClipRect.z = command.ClipRect.z + m_ViewTransformPosition.x;
-            command.ClipRect.w = command.ClipRect.w + m_ViewTransformPosition.y;
-        }
+        auto& command = m_DrawList->CmdBuffer[i];
+        command.ClipRect.x = command.ClipRect.x * m_View.Scale + m_ViewTransformPosition.x;
+        command.ClipRect.y = command.ClipRect.y * m_View.Scale + m_ViewTransformPosition.y;
+        command.ClipRect.z = command.ClipRect.z * m_View.Scale + m_ViewTransformPosition.x;
+        command.ClipRect.w = command.ClipRect.w * m_View.Scale + m_ViewTransformPosition.y;
     }
 
     // Remove sentinel draw command if present
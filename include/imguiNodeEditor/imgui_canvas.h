@@ -55,6 +55,12 @@
 #define IMGUIEX_CANVAS_API
 #endif
 
+// When enabled vertices are moved to screen space once in End() for all ranges
+// recorded between Suspend()/Resume() cycles, instead of on every cycle.
+# ifndef IMGUI_EX_CANVAS_DEFERED
+#     define IMGUI_EX_CANVAS_DEFERED() 0
+# endif
+
 namespace ImGuiEx {
 
 struct CanvasView
@@ -199,8 +205,6 @@ struct Canvas
     bool IsSuspended() const { return m_SuspendCounter > 0; }
 
 private:
-# define IMGUI_EX_CANVAS_DEFERED() 0
-
 # if IMGUI_EX_CANVAS_DEFERED()
     struct Range
     {
@@ -208,6 +212,8 @@ private:
         int EndVertexIndex   = 0;
         int BeginComandIndex = 0;
         int EndCommandIndex  = 0;
+        ImVec2 Offset;
+        float  Scale = 1.0f;
     };
 # endif
 
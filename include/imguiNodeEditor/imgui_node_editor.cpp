@@ -10,7 +10,9 @@
 //   Written by Michal Cichon
 //------------------------------------------------------------------------------
 # include "imgui_node_editor_internal.h"
+# include "imgui_node_editor_runtime.h"
 # include <cstdio> // snprintf
+# include <cstring> // memcpy
 # include <string>
 # include <fstream>
 # include <bitset>
@@ -19,6 +21,9 @@
 # include <sstream>
 # include <streambuf>
 # include <type_traits>
+# include <thread>
+# include <unordered_map>
+# include <unordered_set>
 
 // https://stackoverflow.com/a/8597498
 # define DECLARE_HAS_NESTED(Name, Member)                                          \
@@ -84,6 +89,10 @@ static const int c_NodeUserBackgroundChannel = 2;
 static const int c_NodePinChannel            = 3;
 static const int c_NodeContentChannel        = 4;
 
+static const int   c_LodLinkSegmentCount        = 6;
+static const float c_LinkArcLengthStep          = 15.0f; // canvas pixels between arc length samples
+static const int   c_FlowMarkerBatchVertices    = 16384; // vertices reserved at once when drawing flow markers
+
 static const float c_GroupSelectThickness       = 6.0f;  // canvas pixels
 static const float c_LinkSelectThickness        = 5.0f;  // canvas pixels
 static const float c_NavigationZoomMargin       = 0.1f;  // percentage of visible bounds
@@ -137,6 +146,14 @@ static bool IsGroup(const ed::Node* node)
 }
 
 
+//------------------------------------------------------------------------------
+// Quarter-octave zoom step, node content drawn within one step is considered equal.
+static int CalcZoomBucket(float scale)
+{
+    return static_cast<int>(ImFloor(std::log2(scale) * 4.0f));
+}
+
+
 //------------------------------------------------------------------------------
 static void ImDrawListSplitter_Grow(ImDrawList* draw_list, ImDrawListSplitter* splitter, int channels_count)
 {
@@ -315,117 +332,6 @@ static void ImDrawList_PathBezierOffset(ImDrawList* drawList, float offset, cons
     ImCubicBezierSubdivide(acceptPoint, p0, p1, p2, p3);
 }
 
-/*
-static void ImDrawList_PolyFillScanFlood(ImDrawList *draw, std::vector<ImVec2>* poly, ImColor color, int gap = 1, float strokeWidth = 1.0f)
-{
-    std::vector<ImVec2> scanHits;
-    ImVec2 min, max; // polygon min/max points
-    auto io = ImGui::GetIO();
-    float y;
-    bool isMinMaxDone = false;
-    unsigned int polysize = poly->size();
-
-    // find the orthagonal bounding box
-    // probably can put this as a predefined
-    if (!isMinMaxDone)
-    {
-        min.x = min.y = FLT_MAX;
-        max.x = max.y = FLT_MIN;
-        for (auto p : *poly)
-        {
-            if (p.x < min.x) min.x = p.x;
-            if (p.y < min.y) min.y = p.y;
-            if (p.x > max.x) max.x = p.x;
-            if (p.y > max.y) max.y = p.y;
-        }
-        isMinMaxDone = true;
-    }
-
-    // Bounds check
-    if ((max.x < 0) || (min.x > io.DisplaySize.x) || (max.y < 0) || (min.y > io.DisplaySize.y)) return;
-
-    // Vertically clip
-    if (min.y < 0) min.y = 0;
-    if (max.y > io.DisplaySize.y) max.y = io.DisplaySize.y;
-
-    // so we know we start on the outside of the object we step out by 1.
-    min.x -= 1;
-    max.x += 1;
-
-    // Initialise our starting conditions
-    y = min.y;
-
-    // Go through each scan line iteratively, jumping by 'gap' pixels each time
-    while (y < max.y)
-    {
-        scanHits.clear();
-
-        {
-            int jump = 1;
-            ImVec2 fp = poly->at(0);
-
-            for (size_t i = 0; i < polysize - 1; i++)
-            {
-                ImVec2 pa = poly->at(i);
-                ImVec2 pb = poly->at(i + 1);
-
-                // jump double/dud points
-                if (pa.x == pb.x && pa.y == pb.y) continue;
-
-                // if we encounter our hull/poly start point, then we've now created the
-                // closed
-                // hull, jump the next segment and reset the first-point
-                if ((!jump) && (fp.x == pb.x) && (fp.y == pb.y))
-                {
-                    if (i < polysize - 2)
-                    {
-                        fp = poly->at(i + 2);
-                        jump = 1;
-                        i++;
-                    }
-                }
-                else
-                {
-                    jump = 0;
-                }
-
-                // test to see if this segment makes the scan-cut.
-                if ((pa.y > pb.y && y < pa.y && y > pb.y) || (pa.y < pb.y && y > pa.y && y < pb.y))
-                {
-                    ImVec2 intersect;
-
-                    intersect.y = y;
-                    if (pa.x == pb.x)
-                    {
-                        intersect.x = pa.x;
-                    }
-                    else
-                    {
-                        intersect.x = (pb.x - pa.x) / (pb.y - pa.y) * (y - pa.y) + pa.x;
-                    }
-                    scanHits.push_back(intersect);
-                }
-            }
-
-            // Sort the scan hits by X, so we have a proper left->right ordering
-            sort(scanHits.begin(), scanHits.end(), [](ImVec2 const &a, ImVec2 const &b) { return a.x < b.x; });
-
-            // generate the line segments.
-            {
-                int i = 0;
-                int l = scanHits.size() - 1; // we need pairs of points, this prevents segfault.
-                for (i = 0; i < l; i += 2)
-                {
-                    draw->AddLine(scanHits[i], scanHits[i + 1], color, strokeWidth);
-                }
-            }
-        }
-        y += gap;
-    } // for each scan line
-    scanHits.clear();
-}
-*/
-
 static void ImDrawList_AddBezierWithArrows(ImDrawList* drawList, const ImCubicBezierPoints& curve, float thickness,
     float startArrowSize, float startArrowWidth, float endArrowSize, float endArrowWidth,
     bool fill, ImU32 color, float strokeThickness, const ImVec2* startDirHint = nullptr, const ImVec2* endDirHint = nullptr)
@@ -513,8 +419,20 @@ static void ImDrawList_AddBezierWithArrows(ImDrawList* drawList, const ImCubicBe
 // Pin
 //
 //------------------------------------------------------------------------------
+bool ed::Pin::IsVisible() const
+{
+    // Pins of culled node have no channels to draw into.
+    if (m_Node && m_Node->m_IsCulled)
+        return false;
+
+    return Object::IsVisible();
+}
+
 void ed::Pin::Draw(ImDrawList* drawList, DrawFlags flags)
 {
+    if (Editor->GetLodLevel() != LodLevel::Full)
+        return;
+
     if (flags & Hovered)
     {
         drawList->ChannelsSetCurrent(m_Node->m_Channel + c_NodePinChannel);
@@ -595,6 +513,8 @@ void ed::Node::UpdateDrag(const ImVec2& offset)
     auto size = m_Bounds.GetSize();
     m_Bounds.Min = ImFloor(m_DragStart + offset);
     m_Bounds.Max = m_Bounds.Min + size;
+
+    Editor->NotifyNodeChanged(this);
 }
 
 bool ed::Node::EndDrag()
@@ -604,7 +524,20 @@ bool ed::Node::EndDrag()
 
 void ed::Node::Draw(ImDrawList* drawList, DrawFlags flags)
 {
-    if (flags == Detail::Object::None)
+    if (flags == Detail::Object::None && Editor->GetLodLevel() == LodLevel::Summary)
+    {
+        drawList->ChannelsSetCurrent(m_Channel + c_NodeBackgroundChannel);
+
+        if (IsGroup(this))
+            drawList->AddRectFilled(m_GroupBounds.Min, m_GroupBounds.Max, m_GroupColor);
+
+        auto& config = Editor->GetConfig();
+        if (config.DrawNodeSummary)
+            config.DrawNodeSummary(m_ID, drawList, m_Bounds.Min, m_Bounds.Max, config.UserPointer);
+        else
+            drawList->AddRectFilled(m_Bounds.Min, m_Bounds.Max, m_Color);
+    }
+    else if (flags == Detail::Object::None)
     {
         drawList->ChannelsSetCurrent(m_Channel + c_NodeBackgroundChannel);
 
@@ -686,17 +619,7 @@ void ed::Node::DrawBorder(ImDrawList* drawList, ImU32 color, float thickness, fl
 
 void ed::Node::GetGroupedNodes(std::vector<Node*>& result, bool append)
 {
-    if (!append)
-        result.resize(0);
-
-    if (!IsGroup(this))
-        return;
-
-    const auto firstNodeIndex = result.size();
-    Editor->FindNodesInRect(m_GroupBounds, result, true, false);
-
-    for (auto index = firstNodeIndex; index < result.size(); ++index)
-        result[index]->GetGroupedNodes(result, true);
+    Editor->FindGroupedNodes(this, result, append);
 }
 
 ImRect ed::Node::GetRegionBounds(NodeRegion region) const
@@ -832,6 +755,55 @@ ed::NodeRegion ed::Node::GetRegion(const ImVec2& point) const
 
 
 
+//------------------------------------------------------------------------------
+//
+// Link Geometry
+//
+//------------------------------------------------------------------------------
+bool ed::LinkGeometry::IsValid(const ImCubicBezierPoints& curve) const
+{
+    return !m_ArcLength.empty()
+        && m_Curve.P0 == curve.P0 && m_Curve.P1 == curve.P1
+        && m_Curve.P2 == curve.P2 && m_Curve.P3 == curve.P3;
+}
+
+void ed::LinkGeometry::Build(const ImCubicBezierPoints& curve)
+{
+    m_Curve  = curve;
+    m_Length = ImCubicBezierLength(curve.P0, curve.P1, curve.P2, curve.P3);
+
+    auto collectPointsCallback = [this](ImCubicBezierFixedStepSample& result)
+    {
+        m_ArcLength.push_back(ArcPoint{ result.Length, result.Point });
+    };
+
+    m_ArcLength.resize(0);
+    ImCubicBezierFixedStep(collectPointsCallback, curve, c_LinkArcLengthStep, false, 0.5f, 0.001f);
+}
+
+void ed::LinkGeometry::Sample(float offset, float step, vector<ImVec2>& points) const
+{
+    if (m_ArcLength.size() < 2 || m_Length <= 0.0f || step <= 0.0f)
+        return;
+
+    // Distances grow monotonically, so lookup table is walked once for all points.
+    size_t end = 1;
+    for (float d = offset; d < m_Length; d += step)
+    {
+        while (end + 1 < m_ArcLength.size() && m_ArcLength[end].m_Distance <= d)
+            ++end;
+
+        const auto& a = m_ArcLength[end - 1];
+        const auto& b = m_ArcLength[end];
+        const auto  t = (d - a.m_Distance) / (b.m_Distance - a.m_Distance);
+
+        points.push_back(a.m_Point + (b.m_Point - a.m_Point) * t);
+    }
+}
+
+
+
+
 //------------------------------------------------------------------------------
 //
 // Link
@@ -876,6 +848,19 @@ void ed::Link::Draw(ImDrawList* drawList, ImU32 color, float extraThickness) con
 
     const auto curve = GetCurve();
 
+    // Links are few pixels wide when zoomed out, skip arrows and most of the segments.
+    const auto lodLevel = Editor->GetLodLevel();
+    if (lodLevel == LodLevel::Summary)
+    {
+        drawList->AddLine(curve.P0, curve.P3, color, m_Thickness + extraThickness);
+        return;
+    }
+    else if (lodLevel == LodLevel::Simplified)
+    {
+        drawList->AddBezierCubic(curve.P0, curve.P1, curve.P2, curve.P3, color, m_Thickness + extraThickness, c_LodLinkSegmentCount);
+        return;
+    }
+
     ImDrawList_AddBezierWithArrows(drawList, curve, m_Thickness + extraThickness,
         m_StartPin && m_StartPin->m_ArrowSize  > 0.0f ? m_StartPin->m_ArrowSize  + extraThickness : 0.0f,
         m_StartPin && m_StartPin->m_ArrowWidth > 0.0f ? m_StartPin->m_ArrowWidth + extraThickness : 0.0f,
@@ -922,6 +907,15 @@ ImCubicBezierPoints ed::Link::GetCurve() const
     return result;
 }
 
+const ed::LinkGeometry& ed::Link::GetGeometry() const
+{
+    const auto curve = GetCurve();
+    if (!m_Geometry.IsValid(curve))
+        m_Geometry.Build(curve);
+
+    return m_Geometry;
+}
+
 bool ed::Link::TestHit(const ImVec2& point, float extraThickness) const
 {
     if (!m_IsLive)
@@ -1037,12 +1031,22 @@ ed::EditorContext::EditorContext(const ax::NodeEditor::Config* config)
     , m_ShortcutsEnabled(true)
     , m_Style()
     , m_Nodes()
+    , m_NodeIndex()
+    , m_LiveNodeCount(0)
+    , m_KeptLiveNodeCount(0)
+    , m_PreviousLiveNodeCount(0)
+    , m_GroupMembership()
+    , m_Minimap(this)
     , m_Pins()
     , m_Links()
+    , m_LiveLinkCount(0)
+    , m_KeptLiveLinkCount(0)
+    , m_PreviousLiveLinkCount(0)
     , m_SelectionId(1)
     , m_LastActiveLink(nullptr)
     , m_Canvas()
     , m_IsCanvasVisible(false)
+    , m_LodLevel(LodLevel::Full)
     , m_NodeBuilder(this)
     , m_HintBuilder(this)
     , m_CurrentAction(nullptr)
@@ -1066,6 +1070,8 @@ ed::EditorContext::EditorContext(const ax::NodeEditor::Config* config)
     , m_BackgroundDoubleClickButtonIndex(-1)
     , m_IsInitialized(false)
     , m_Settings()
+    , m_SettingsSaver()
+    , m_RemovedNodeSettings()
     , m_DrawList(nullptr)
     , m_ExternalChannel(0)
 {
@@ -1076,6 +1082,9 @@ ed::EditorContext::~EditorContext()
     if (m_IsInitialized)
         SaveSettings();
 
+    // Wait for asynchronous save to finish, Config callbacks may not outlive editor.
+    m_SettingsSaver.reset();
+
     for (auto link  : m_Links)  delete link.m_Object;
     for (auto pin   : m_Pins)   delete pin.m_Object;
     for (auto node  : m_Nodes)  delete node.m_Object;
@@ -1085,6 +1094,9 @@ ed::EditorContext::~EditorContext()
 
 void ed::EditorContext::Begin(const char* id, const ImVec2& size)
 {
+    m_Profiler.BeginFrame(ImGui::GetWindowDrawList());
+    ProfilerScope profileBegin(m_Profiler, ProfilerPhase::Begin);
+
     m_EditorActiveId = ImGui::GetID(id);
     ImGui::PushID(id);
 
@@ -1125,10 +1137,35 @@ void ed::EditorContext::Begin(const char* id, const ImVec2& size)
         }), objects.end());
     };
 
+    const auto linkCount = m_Links.size();
+
+    // Address of deleted link may be reused by new one, which must not inherit its animation.
+    for (auto link : m_Links)
+        if (link->m_DeleteOnNewFrame)
+            m_FlowAnimationController.Forget(link.m_Object);
+
     resetAndCollect(m_Nodes);
     resetAndCollect(m_Pins);
     resetAndCollect(m_Links);
 
+    if (m_Links.size() != linkCount)
+        m_Minimap.Invalidate();
+
+    // Nodes are kept in drawing order, rebuild lookup index if some were collected.
+    if (m_NodeIndex.size() != m_Nodes.size())
+    {
+        m_NodeIndex = m_Nodes;
+        std::sort(m_NodeIndex.begin(), m_NodeIndex.end());
+
+        m_GroupMembership.Invalidate();
+        m_Minimap.Invalidate();
+    }
+
+    m_LiveNodeCount     = 0;
+    m_KeptLiveNodeCount = 0;
+    m_LiveLinkCount     = 0;
+    m_KeptLiveLinkCount = 0;
+
     m_DrawList = ImGui::GetWindowDrawList();
 
     ImDrawList_SwapSplitter(m_DrawList, m_Splitter);
@@ -1197,6 +1234,17 @@ void ed::EditorContext::Begin(const char* id, const ImVec2& size)
 
     m_Canvas.SetView(m_NavigateAction.GetView());
 
+    // Pick level of detail for this frame, thresholds are expressed in GetCurrentZoom() units.
+    {
+        const auto zoom = m_Canvas.View().InvScale;
+
+        m_LodLevel = LodLevel::Full;
+        if (m_Style.LodSimplifiedZoom > 0.0f && zoom >= m_Style.LodSimplifiedZoom)
+            m_LodLevel = LodLevel::Simplified;
+        if (m_Style.LodSummaryZoom > 0.0f && zoom >= m_Style.LodSummaryZoom)
+            m_LodLevel = LodLevel::Summary;
+    }
+
     // #debug #clip
     //ImGui::Text("CLIP = { x=%g y=%g w=%g h=%g r=%g b=%g }",
     //    clipMin.x, clipMin.y, clipMax.x - clipMin.x, clipMax.y - clipMin.y, clipMax.x, clipMax.y);
@@ -1204,16 +1252,50 @@ void ed::EditorContext::Begin(const char* id, const ImVec2& size)
     // Reserve channels for background and links
     ImDrawList_ChannelsGrow(m_DrawList, c_NodeStartChannel);
 
+    m_NodeChannelLayers.resize(0);
+    m_NodeChannelLayerLookup.clear();
+
     if (HasSelectionChanged())
         ++m_SelectionId;
 
     m_LastSelectedObjects = m_SelectedObjects;
+
+    m_Profiler.BeginSubmission();
 }
 
 void ed::EditorContext::End()
 {
+    m_Profiler.EndSubmission();
+
+    // Some nodes live in previous frame were not submitted in this one.
+    if (m_KeptLiveNodeCount < m_PreviousLiveNodeCount)
+    {
+        for (auto node : m_Nodes)
+            if (node->m_WasLive && !node->m_IsLive)
+                NotifyNodeChanged(node);
+    }
+    m_PreviousLiveNodeCount = m_LiveNodeCount;
+
+    if (m_KeptLiveLinkCount < m_PreviousLiveLinkCount)
+    {
+        for (auto link : m_Links)
+            if (link->m_WasLive && !link->m_IsLive)
+                NotifyLinkChanged(link);
+    }
+    m_PreviousLiveLinkCount = m_LiveLinkCount;
+
+    m_GroupMembership.Update(m_Nodes);
+
+    if (m_Minimap.IsVisible())
+    {
+        ProfilerScope profileMinimap(m_Profiler, ProfilerPhase::Minimap);
+        m_Minimap.Update(m_Nodes, m_Links, m_Canvas.Rect());
+    }
+
     //auto& io          = ImGui::GetIO();
+    auto  buildControlStart = FrameProfiler::Clock::now();
     auto  control     = BuildControl(m_CurrentAction && m_CurrentAction->IsDragging()); // NavigateAction.IsMovingOverEdge()
+    m_Profiler.Add(ProfilerPhase::BuildControl, buildControlStart);
     //auto& editorStyle = GetStyle();
 
     m_HoveredNode             = control.HotNode && m_CurrentAction == nullptr ? control.HotNode->m_ID : 0;
@@ -1235,14 +1317,22 @@ void ed::EditorContext::End()
     //const bool isSizing    = CurrentAction && CurrentAction->AsSize()   != nullptr;
 
     // Draw nodes
-    for (auto node : m_Nodes)
-        if (node->m_IsLive && node->IsVisible())
-            node->Draw(m_DrawList);
+    {
+        ProfilerScope profileNodes(m_Profiler, ProfilerPhase::DrawNodes);
+        for (auto node : m_Nodes)
+            if (node->m_IsLive && node->IsVisible())
+                node->Draw(m_DrawList);
+    }
 
     // Draw links
-    for (auto link : m_Links)
-        if (link->m_IsLive && link->IsVisible())
-            link->Draw(m_DrawList);
+    {
+        ProfilerScope profileLinks(m_Profiler, ProfilerPhase::DrawLinks);
+        for (auto link : m_Links)
+            if (link->m_IsLive && link->IsVisible())
+                link->Draw(m_DrawList);
+    }
+
+    auto highlightStart = FrameProfiler::Clock::now();
 
     // Highlight selected objects
     {
@@ -1287,9 +1377,16 @@ void ed::EditorContext::End()
             hoveredObject->Draw(m_DrawList, Object::Hovered);
     }
 
+    m_Profiler.Add(ProfilerPhase::Highlight, highlightStart);
+
     // Draw animations
-    for (auto controller : m_AnimationControllers)
-        controller->Draw(m_DrawList);
+    {
+        ProfilerScope profileAnimations(m_Profiler, ProfilerPhase::Animations);
+        for (auto controller : m_AnimationControllers)
+            controller->Draw(m_DrawList);
+    }
+
+    auto actionsStart = FrameProfiler::Clock::now();
 
     if (m_CurrentAction && !m_CurrentAction->Process(control))
         m_CurrentAction = nullptr;
@@ -1359,10 +1456,11 @@ void ed::EditorContext::End()
             // Bring content of dragged group to front
             std::vector<Node*> nodes;
             control.ActiveNode->GetGroupedNodes(nodes);
+            std::sort(nodes.begin(), nodes.end());
 
             std::stable_partition(m_Nodes.begin(), m_Nodes.end(), [&nodes](Node* node)
             {
-                return std::find(nodes.begin(), nodes.end(), node) == nodes.end();
+                return !std::binary_search(nodes.begin(), nodes.end(), node);
             });
 
             sortGroups = true;
@@ -1394,43 +1492,77 @@ void ed::EditorContext::End()
         return lhs->m_ZPosition < rhs->m_ZPosition;
     });
 
+    m_Profiler.Add(ProfilerPhase::Actions, actionsStart);
+
+    auto channelMergeStart = FrameProfiler::Clock::now();
+
 # if 1
     // Every node has few channels assigned. Grow channel list
     // to hold twice as much of channels and place them in
     // node drawing order.
     {
-        // Copy group nodes
-        auto liveNodeCount = static_cast<int>(std::count_if(m_Nodes.begin(), m_Nodes.end(), [](Node* node) { return node->m_IsLive; }));
-
-        // Reserve two additional channels for sorted list of channels
+        // Reserve space for copy of every allocated node channel
         auto nodeChannelCount = m_DrawList->_Splitter._Count;
-        ImDrawList_ChannelsGrow(m_DrawList, m_DrawList->_Splitter._Count + c_ChannelsPerNode * liveNodeCount + c_LinkChannelCount);
+        ImDrawList_ChannelsGrow(m_DrawList, nodeChannelCount + (nodeChannelCount - c_NodeStartChannel) + c_LinkChannelCount);
 
         int targetChannel = nodeChannelCount;
 
-        auto copyNode = [this, &targetChannel](Node* node)
+        auto copyChannels = [this, &targetChannel](int sourceChannel)
         {
-            if (!node->m_IsLive)
-                return;
-
             for (int i = 0; i < c_ChannelsPerNode; ++i)
-                ImDrawList_SwapChannels(m_DrawList, node->m_Channel + i, targetChannel + i);
+                ImDrawList_SwapChannels(m_DrawList, sourceChannel + i, targetChannel + i);
 
-            node->m_Channel = targetChannel;
+            auto result = targetChannel;
             targetChannel += c_ChannelsPerNode;
+            return result;
+        };
+
+        auto findLayer = [this](Node* node) -> NodeChannelLayer*
+        {
+            return node->m_ChannelLayer >= 0 ? &m_NodeChannelLayers[node->m_ChannelLayer] : nullptr;
+        };
+
+        // Shared layers are copied first, nodes with own channels go over them.
+        auto copyLayers = [&findLayer, &copyChannels](Node* node)
+        {
+            if (!node->m_IsLive || node->m_IsCulled)
+                return;
+
+            if (auto layer = findLayer(node))
+            {
+                if (layer->m_TargetChannel < 0)
+                    layer->m_TargetChannel = copyChannels(layer->m_Channel);
+
+                node->m_Channel = layer->m_TargetChannel;
+            }
+        };
+
+        auto copyNode = [&findLayer, &copyChannels](Node* node)
+        {
+            if (!node->m_IsLive || node->m_IsCulled || findLayer(node))
+                return;
+
+            node->m_Channel = copyChannels(node->m_Channel);
+        };
+
+        auto copyNodes = [&](auto first, auto last)
+        {
+            if (!m_NodeChannelLayers.empty())
+                std::for_each(first, last, copyLayers);
+            std::for_each(first, last, copyNode);
         };
 
         auto groupsItEnd = std::find_if(m_Nodes.begin(), m_Nodes.end(), [](Node* node) { return !IsGroup(node); });
 
         // Copy group nodes
-        std::for_each(m_Nodes.begin(), groupsItEnd, copyNode);
+        copyNodes(m_Nodes.begin(), groupsItEnd);
 
         // Copy links
         for (int i = 0; i < c_LinkChannelCount; ++i, ++targetChannel)
             ImDrawList_SwapChannels(m_DrawList, c_LinkStartChannel + i, targetChannel);
 
         // Copy normal nodes
-        std::for_each(groupsItEnd, m_Nodes.end(), copyNode);
+        copyNodes(groupsItEnd, m_Nodes.end());
     }
 # endif
 
@@ -1526,6 +1658,8 @@ void ed::EditorContext::End()
 
     UpdateAnimations();
 
+    const auto channelCount = m_DrawList->_Splitter._Count;
+
     m_DrawList->ChannelsMerge();
 
     // #debug
@@ -1538,6 +1672,15 @@ void ed::EditorContext::End()
 
     ImDrawList_SwapSplitter(m_DrawList, m_Splitter);
 
+    m_Profiler.Add(ProfilerPhase::ChannelMerge, channelMergeStart);
+
+    if (m_Minimap.IsVisible())
+    {
+        ProfilerScope profileMinimap(m_Profiler, ProfilerPhase::Minimap);
+        m_Minimap.Draw(m_DrawList, m_Canvas.ViewRect());
+        m_Minimap.EndFrame();
+    }
+
     // Draw border
     {
         auto& style = ImGui::GetStyle();
@@ -1563,8 +1706,15 @@ void ed::EditorContext::End()
     if (HasSelectionChanged())
         MakeDirty(SaveReasonFlags::Selection);
 
+    ApplySaveResults();
+
     if (m_Settings.m_IsDirty && !m_CurrentAction)
+    {
+        ProfilerScope profileSave(m_Profiler, ProfilerPhase::SaveSettings);
         SaveSettings();
+    }
+
+    m_Profiler.EndFrame(m_DrawList, channelCount);
 
     m_DrawList = nullptr;
     m_IsFirstFrame = false;
@@ -1584,6 +1734,16 @@ bool ed::EditorContext::DoLink(LinkId id, PinId startPinId, PinId endPinId, ImU3
       endPin->m_HasConnection = true;
 
     auto link           = GetLink(id);
+    auto lastStart      = link->m_Start;
+    auto lastEnd        = link->m_End;
+
+    if (!link->m_IsLive)
+    {
+        ++m_LiveLinkCount;
+        if (link->m_WasLive)
+            ++m_KeptLiveLinkCount;
+    }
+
     link->m_StartPin      = startPin;
     link->m_EndPin        = endPin;
     link->m_Color         = color;
@@ -1593,6 +1753,9 @@ bool ed::EditorContext::DoLink(LinkId id, PinId startPinId, PinId endPinId, ImU3
 
     link->UpdateEndpoints();
 
+    if (!link->m_WasLive || link->m_Start != lastStart || link->m_End != lastEnd)
+        NotifyLinkChanged(link);
+
     return true;
 }
 
@@ -1622,7 +1785,11 @@ void ed::EditorContext::SetGroupSize(NodeId nodeId, const ImVec2& size)
         node->m_IsLive = false;
     }
 
-    node->m_Type = NodeType::Group;
+    if (node->m_Type != NodeType::Group)
+    {
+        node->m_Type = NodeType::Group;
+        NotifyNodeChanged(node);
+    }
 
     if (node->m_GroupBounds.GetSize() != size)
     {
@@ -1672,6 +1839,127 @@ float ed::EditorContext::GetNodeZPosition(NodeId nodeId)
     return node->m_ZPosition;
 }
 
+bool ed::EditorContext::IsNodeInView(NodeId nodeId, float margin)
+{
+    auto node = FindNode(nodeId);
+    if (!node)
+        return true;
+
+    return IsNodeBoundsInView(node, margin);
+}
+
+int ed::EditorContext::GetNodesInView(NodeId* nodes, int size, float margin) const
+{
+    int result = 0;
+    for (auto node : m_Nodes)
+    {
+        if (!IsNodeBoundsInView(node, margin))
+            continue;
+
+        if (nodes)
+        {
+            if (size <= 0)
+                break;
+
+            *nodes++ = node->m_ID;
+            --size;
+        }
+
+        ++result;
+    }
+
+    return result;
+}
+
+bool ed::EditorContext::SkipNode(NodeId nodeId)
+{
+    auto node = FindNode(nodeId);
+
+    // Node must be submitted at least once to know its bounds.
+    if (!node || ImRect_IsEmpty(node->m_Bounds))
+        return false;
+
+    // Node was already submitted or skipped in this frame.
+    if (node->m_IsLive)
+        return true;
+
+    // Pending state changes are applied only by NodeBuilder.
+    if (node->m_RestoreState || node->m_CenterOnScreen)
+        return false;
+
+    MarkNodeLive(node);
+    node->m_IsCulled = true;
+
+    // Keep pins alive, so links to this node are not dropped.
+    for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
+        pin->m_IsLive = true;
+
+    // Summary does not need user content, so visible node can be drawn
+    // using last frame layout.
+    if (m_LodLevel == LodLevel::Summary && m_DrawList && IsNodeBoundsInView(node, 0.0f))
+    {
+        node->m_Channel  = AllocateNodeChannels(node);
+        node->m_IsCulled = false;
+    }
+
+    return true;
+}
+
+int ed::EditorContext::AllocateNodeChannels(Node* node)
+{
+    IM_ASSERT(m_DrawList != nullptr);
+
+    // Nodes which have to keep strict z-order get own set of channels.
+    const bool ownChannels = !m_Config.EnableLayeredChannels
+        || node->m_IsSelected
+        || node->m_ID == m_HoveredNode
+        || node == m_SizeAction.m_SizedNode;
+
+    node->m_ChannelLayer = -1;
+
+    uint64_t layerKey = 0;
+    if (!ownChannels)
+    {
+        // Adding 0.0f folds -0.0f into 0.0f, so both share a layer like they did when compared.
+        const float zPosition = node->m_ZPosition + 0.0f;
+        uint32_t    zBits     = 0;
+        memcpy(&zBits, &zPosition, sizeof(zBits));
+        layerKey = (static_cast<uint64_t>(node->m_Type) << 32) | zBits;
+
+        auto it = m_NodeChannelLayerLookup.find(layerKey);
+        if (it != m_NodeChannelLayerLookup.end())
+        {
+            node->m_ChannelLayer = it->second;
+            return m_NodeChannelLayers[it->second].m_Channel;
+        }
+    }
+
+    auto channel = m_DrawList->_Splitter._Count;
+    ImDrawList_ChannelsGrow(m_DrawList, channel + c_ChannelsPerNode);
+
+    if (!ownChannels)
+    {
+        node->m_ChannelLayer = static_cast<int>(m_NodeChannelLayers.size());
+        m_NodeChannelLayerLookup.emplace(layerKey, node->m_ChannelLayer);
+        m_NodeChannelLayers.push_back({ node->m_Type, node->m_ZPosition, channel, -1 });
+    }
+
+    return channel;
+}
+
+bool ed::EditorContext::IsNodeBoundsInView(const Node* node, float margin) const
+{
+    // Node was never measured or is waiting for deferred update,
+    // it has to be submitted to have valid bounds.
+    if (ImRect_IsEmpty(node->m_Bounds) || node->m_RestoreState || node->m_CenterOnScreen)
+        return true;
+
+    auto viewRect = m_Canvas.ViewRect();
+    viewRect.Expand(margin * m_Canvas.View().InvScale);
+
+    return node->m_Bounds.Overlaps(viewRect);
+}
+
 void ed::EditorContext::MarkNodeToRestoreState(Node* node)
 {
     node->m_RestoreState = true;
@@ -1710,6 +1998,8 @@ void ed::EditorContext::UpdateNodeState(Node* node)
     node->m_GroupBounds.Min = settings->m_Location;
     node->m_GroupBounds.Max = node->m_GroupBounds.Min + settings->m_GroupSize;
     node->m_GroupBounds.Floor();
+
+    NotifyNodeChanged(node);
 }
 
 void ed::EditorContext::RemoveSettings(Object* object)
@@ -1718,6 +2008,10 @@ void ed::EditorContext::RemoveSettings(Object* object)
     {
         m_Settings.RemoveNode(node->m_ID);
         MakeDirty(SaveReasonFlags::RemoveNode, node);
+
+        // Node is no longer in m_Nodes, SaveSettingsAsync() would not see it.
+        if (m_Config.EnableAsyncSave)
+            m_RemovedNodeSettings.push_back(node->m_ID);
     }
 }
 
@@ -1815,6 +2109,17 @@ void ed::EditorContext::FindNodesInRect(const ImRect& r, vector<Node*>& result,
             result.push_back(node);
 }
 
+void ed::EditorContext::FindGroupedNodes(const Node* group, vector<Node*>& result, bool append)
+{
+    if (!append)
+        result.resize(0);
+
+    if (!IsGroup(group))
+        return;
+
+    m_GroupMembership.GetMembers(group, result);
+}
+
 void ed::EditorContext::FindLinksInRect(const ImRect& r, vector<Link*>& result, bool append)
 {
     if (!append)
@@ -2000,6 +2305,9 @@ ed::Node* ed::EditorContext::CreateNode(NodeId id)
     m_Nodes.push_back({id, node});
     //std::sort(Nodes.begin(), Nodes.end());
 
+    ObjectWrapper<Node> wrapper{id, node};
+    m_NodeIndex.insert(std::upper_bound(m_NodeIndex.begin(), m_NodeIndex.end(), wrapper), wrapper);
+
     auto settings = m_Settings.FindNode(id);
     if (!settings)
         settings = m_Settings.AddNode(id);
@@ -2068,7 +2376,7 @@ static inline auto FindItemIn(C& container, Id id)
 
 ed::Node* ed::EditorContext::FindNode(NodeId id)
 {
-    return FindItemInLinear(m_Nodes, id);
+    return FindItemIn(m_NodeIndex, id);
 }
 
 ed::Pin* ed::EditorContext::FindPin(PinId id)
@@ -2137,19 +2445,26 @@ void ed::EditorContext::LoadSettings()
 
 void ed::EditorContext::SaveSettings()
 {
+    if (m_Config.EnableAsyncSave)
+    {
+        SaveSettingsAsync();
+        return;
+    }
+
     m_Config.BeginSave();
 
     for (auto& node : m_Nodes)
     {
         auto settings = m_Settings.FindNode(node->m_ID);
-        settings->m_Location = node->m_Bounds.Min;
-        settings->m_Size     = node->m_Bounds.GetSize();
+        settings->SetLocation(node->m_Bounds.Min);
+        settings->m_Size = node->m_Bounds.GetSize();
         if (IsGroup(node))
-            settings->m_GroupSize = node->m_GroupBounds.GetSize();
+            settings->SetGroupSize(node->m_GroupBounds.GetSize());
 
+        // Only nodes changed since last save are serialized.
         if (!node->m_RestoreState && settings->m_IsDirty && m_Config.SaveNodeSettings)
         {
-            if (m_Config.SaveNode(node->m_ID, settings->Serialize().dump(), settings->m_DirtyReason))
+            if (m_Config.SaveNode(node->m_ID, settings->Serialize(m_Config.SettingsFormat), settings->m_DirtyReason))
                 settings->ClearDirty();
         }
     }
@@ -2162,12 +2477,89 @@ void ed::EditorContext::SaveSettings()
     m_Settings.m_ViewZoom    = m_NavigateAction.m_Zoom;
     m_Settings.m_VisibleRect = m_NavigateAction.m_VisibleRect;
 
-    if (m_Config.Save(m_Settings.Serialize(), m_Settings.m_DirtyReason))
+    if (m_Config.Save(m_Settings, m_Settings.m_DirtyReason))
         m_Settings.ClearDirty();
 
     m_Config.EndSave();
 }
 
+void ed::EditorContext::SaveSettingsAsync()
+{
+    // Worker starts with a copy of current settings, later only changes are handed over.
+    if (!m_SettingsSaver)
+        m_SettingsSaver.reset(new SettingsSaver(m_Config, m_Settings));
+
+    SettingsSaver::Snapshot snapshot;
+
+    for (auto& id : m_RemovedNodeSettings)
+    {
+        // Node was created again since, it is handed over below.
+        auto settings = m_Settings.FindNode(id);
+        if (settings && !settings->m_WasUsed)
+            snapshot.AddNode(*settings);
+    }
+    m_RemovedNodeSettings.resize(0);
+
+    for (auto& node : m_Nodes)
+    {
+        auto settings = m_Settings.FindNode(node->m_ID);
+        auto changed  = settings->SetLocation(node->m_Bounds.Min);
+        settings->m_Size = node->m_Bounds.GetSize();
+        if (IsGroup(node))
+            changed = settings->SetGroupSize(node->m_GroupBounds.GetSize()) || changed;
+
+        if (!changed && !settings->m_IsDirty)
+            continue;
+
+        snapshot.AddNode(*settings);
+        snapshot.m_Nodes.back().m_IsDirty = !node->m_RestoreState && settings->m_IsDirty && m_Config.SaveNodeSettings;
+        if (snapshot.m_Nodes.back().m_IsDirty)
+            settings->ClearDirty();
+    }
+
+    for (auto& object : m_SelectedObjects)
+        snapshot.m_Selection.push_back(object->ID());
+
+    snapshot.m_ViewScroll  = m_NavigateAction.m_Scroll;
+    snapshot.m_ViewZoom    = m_NavigateAction.m_Zoom;
+    snapshot.m_VisibleRect = m_NavigateAction.m_VisibleRect;
+    snapshot.m_Reason      = m_Settings.m_DirtyReason;
+
+    m_Settings.m_Selection   = snapshot.m_Selection;
+    m_Settings.m_ViewScroll  = snapshot.m_ViewScroll;
+    m_Settings.m_ViewZoom    = snapshot.m_ViewZoom;
+    m_Settings.m_VisibleRect = snapshot.m_VisibleRect;
+
+    // Settings are considered saved, ApplySaveResults() makes them dirty again on failure.
+    m_Settings.ClearDirty();
+
+    m_SettingsSaver->Submit(std::move(snapshot));
+}
+
+void ed::EditorContext::ApplySaveResults()
+{
+    if (!m_SettingsSaver)
+        return;
+
+    auto failed = false;
+    auto reason = SaveReasonFlags::None;
+    vector<SettingsSaver::NodeFailure> nodes;
+    if (!m_SettingsSaver->TakeFailures(failed, reason, nodes))
+        return;
+
+    if (failed)
+        m_Settings.MakeDirty(reason);
+
+    for (auto& failure : nodes)
+    {
+        if (auto settings = m_Settings.FindNode(failure.m_ID))
+        {
+            settings->MakeDirty(failure.m_Reason);
+            m_Settings.MakeDirty(failure.m_Reason);
+        }
+    }
+}
+
 void ed::EditorContext::MakeDirty(SaveReasonFlags reason)
 {
     m_Settings.MakeDirty(reason);
@@ -2176,6 +2568,34 @@ void ed::EditorContext::MakeDirty(SaveReasonFlags reason)
 void ed::EditorContext::MakeDirty(SaveReasonFlags reason, Node* node)
 {
     m_Settings.MakeDirty(reason, node);
+
+    if (node && (reason & (SaveReasonFlags::Position | SaveReasonFlags::Size)) != SaveReasonFlags::None)
+        NotifyNodeChanged(node);
+}
+
+void ed::EditorContext::NotifyNodeChanged(Node* node)
+{
+    m_GroupMembership.MarkChanged(node);
+    m_Minimap.MarkChanged(node);
+}
+
+void ed::EditorContext::NotifyLinkChanged(Link* link)
+{
+    m_Minimap.MarkChanged(link);
+}
+
+void ed::EditorContext::MarkNodeLive(Node* node)
+{
+    if (node->m_IsLive)
+        return;
+
+    node->m_IsLive = true;
+    ++m_LiveNodeCount;
+
+    if (node->m_WasLive)
+        ++m_KeptLiveNodeCount;
+    else
+        NotifyNodeChanged(node);
 }
 
 ed::Link* ed::EditorContext::FindLinkAt(const ImVec2& p)
@@ -2285,6 +2705,22 @@ ed::Control ed::EditorContext::BuildControl(bool allowOffscreen)
     m_IsHovered = false;
     m_IsHoveredWithoutOverlapp = false;
 
+    // Minimap is drawn over everything else, so it is first to take input.
+    // It is not an editor item, while it is active editor gets no control.
+    auto isMinimapHovered = false;
+    if (m_Minimap.IsVisible())
+    {
+        ImVec2 target;
+        bool   isClick = false;
+        if (m_Minimap.ProcessInput(target, isClick))
+        {
+            const auto bounds = ImRect(target - ImVec2(0.5f, 0.5f), target + ImVec2(0.5f, 0.5f));
+            m_NavigateAction.NavigateTo(bounds, NavigateAction::ZoomMode::None, isClick ? -1.0f : 0.0f, NavigateAction::NavigationReason::Minimap);
+        }
+
+        isMinimapHovered = m_Minimap.IsHovered();
+    }
+
     const auto windowHovered = ImGui::IsWindowHovered();
     const auto widgetHovered = ImGui::IsMouseHoveringRect(m_Canvas.ViewRect().Min, m_Canvas.ViewRect().Max, true);
 
@@ -2440,7 +2876,7 @@ ed::Control ed::EditorContext::BuildControl(bool allowOffscreen)
 
     // Links are just over background. So if anything else
     // is hovered we can skip them.
-    if (nullptr == hotObject)
+    if (nullptr == hotObject && !isMinimapHovered)
         hotObject = FindLinkAt(mousePos);
 
     ImGuiButtonFlags backgroundExtraFlags = ImGuiButtonFlags_None;
@@ -2589,6 +3025,17 @@ void ed::EditorContext::ShowMetrics(const Control& control)
     ImGui::Text("Live Nodes: %d", liveNodeCount);
     ImGui::Text("Live Pins: %d", livePinCount);
     ImGui::Text("Live Links: %d", liveLinkCount);
+    {
+        const auto stats = m_Profiler.GetStats();
+        ImGui::Text("Frame Profile (%d frames): vertices=%d indices=%d channels=%d", stats.FrameCount, stats.VertexCount, stats.IndexCount, stats.ChannelCount);
+        for (int i = 0; i < FrameProfiler::c_PhaseCount; ++i)
+        {
+            const auto& phase = stats.Phases[i];
+            ImGui::Text("  %-14s last %7.3f  min %7.3f  avg %7.3f  p99 %7.3f ms", FrameProfiler::GetPhaseName(static_cast<ProfilerPhase>(i)),
+                phase.Last, phase.Min, phase.Average, phase.P99);
+        }
+    }
+    ImGui::Text("Minimap: changes=%d rebuilds=%d", m_Minimap.GetChangeCount(), m_Minimap.GetRebuildCount());
     ImGui::Text("Hot Object: %s (%p)", getHotObjectName(), control.HotObject ? control.HotObject->ID().AsPointer() : nullptr);
     if (auto node = control.HotObject ? control.HotObject->AsNode() : nullptr)
     {
@@ -2618,277 +3065,2055 @@ void ed::EditorContext::ShowMetrics(const Control& control)
 
 //------------------------------------------------------------------------------
 //
-// Node Settings
+// Layout
 //
 //------------------------------------------------------------------------------
-void ed::NodeSettings::ClearDirty()
-{
-    m_IsDirty     = false;
-    m_DirtyReason = SaveReasonFlags::None;
-}
-
-void ed::NodeSettings::MakeDirty(SaveReasonFlags reason)
+// Calls f(begin, end) for chunks of [0, count) on pool workers and calling
+// thread. Ranges shorter than 'minChunk' per thread, or no pool, run on calling
+// thread only.
+template <typename F>
+static void ParallelFor(ax::NodeEditor::Runtime::ThreadPool* pool, int count, int minChunk, F&& f)
 {
-    m_IsDirty     = true;
-    m_DirtyReason = m_DirtyReason | reason;
-}
+    const int chunkCount = pool ? ImMin(pool->GetWorkerCount() + 1, count / ImMax(minChunk, 1)) : 1;
+    if (chunkCount <= 1)
+    {
+        f(0, count);
+        return;
+    }
 
-ed::json::value ed::NodeSettings::Serialize()
-{
-    json::value result;
-    result["location"]["x"] = m_Location.x;
-    result["location"]["y"] = m_Location.y;
+    const int chunk = (count + chunkCount - 1) / chunkCount;
 
-    if (m_GroupSize.x > 0 || m_GroupSize.y > 0)
+    std::atomic<int> remaining(0);
+    for (int begin = chunk; begin < count; begin += chunk)
     {
-        result["group_size"]["x"] = m_GroupSize.x;
-        result["group_size"]["y"] = m_GroupSize.y;
+        const int end = ImMin(begin + chunk, count);
+        remaining.fetch_add(1, std::memory_order_relaxed);
+        pool->Submit([&f, &remaining, begin, end]
+        {
+            f(begin, end);
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
     }
 
-    return result;
+    f(0, ImMin(chunk, count));
+
+    // Chunks still queued are taken over, pool may be busy with other work.
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!pool->RunPendingTask())
+            std::this_thread::yield();
+    }
 }
 
-bool ed::NodeSettings::Parse(const std::string& string, NodeSettings& settings)
+ax::NodeEditor::Runtime::ThreadPool& ed::EditorContext::GetLayoutPool()
 {
-    auto settingsValue = json::value::parse(string);
-    if (settingsValue.is_discarded())
-        return false;
+    if (!m_LayoutPool)
+        m_LayoutPool = std::make_unique<Runtime::ThreadPool>();
 
-    return Parse(settingsValue, settings);
+    return *m_LayoutPool;
 }
 
-bool ed::NodeSettings::Parse(const json::value& data, NodeSettings& result)
+// Builds compressed adjacency, 'items[offsets[v]..offsets[v + 1]]' are indices of edges leaving 'v'.
+static void BuildAdjacency(int vertexCount, const std::vector<std::pair<int, int>>& edges, std::vector<int>& offsets, std::vector<int>& items)
 {
-    if (!data.is_object())
-        return false;
+    offsets.assign(vertexCount + 1, 0);
+    for (auto& edge : edges)
+        ++offsets[edge.first + 1];
+    for (int i = 0; i < vertexCount; ++i)
+        offsets[i + 1] += offsets[i];
 
-    auto tryParseVector = [](const json::value& v, ImVec2& result) -> bool
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    items.resize(edges.size());
+    for (int i = 0; i < static_cast<int>(edges.size()); ++i)
+        items[fill[edges[i].first]++] = i;
+}
+
+void ed::EditorContext::ArrangeNodes(const ArrangeConfig& config, const NodeId* nodeIds, int nodeCount)
+{
+    // Collect nodes, groups stay where they are.
+    vector<Node*> nodes;
+    if (nodeIds)
     {
-        if (v.is_object())
+        for (int i = 0; i < nodeCount; ++i)
         {
-            auto xValue = v["x"];
-            auto yValue = v["y"];
+            auto node = FindNode(nodeIds[i]);
+            if (node && !IsGroup(node))
+                nodes.push_back(node);
+        }
 
-            if (xValue.is_number() && yValue.is_number())
-            {
-                result.x = static_cast<float>(xValue.get<double>());
-                result.y = static_cast<float>(yValue.get<double>());
+        // Caller order is layout input order, only later duplicates are dropped.
+        std::unordered_set<const Node*> seen;
+        seen.reserve(nodes.size());
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&seen](const Node* node) { return !seen.insert(node).second; }), nodes.end());
+    }
+    else
+    {
+        // Nodes not submitted yet in this frame are live since previous one.
+        for (auto node : m_Nodes)
+            if ((node->m_IsLive || node->m_WasLive) && !IsGroup(node))
+                nodes.push_back(node);
+    }
 
-                return true;
-            }
-        }
+    if (nodes.empty())
+        return;
 
-        return false;
-    };
+    const int realCount = static_cast<int>(nodes.size());
 
-    if (!tryParseVector(data["location"], result.m_Location))
-        return false;
+    std::unordered_map<const Node*, int> nodeIndex;
+    nodeIndex.reserve(realCount);
+    for (int i = 0; i < realCount; ++i)
+        nodeIndex[nodes[i]] = i;
 
-    if (data.contains("group_size") && !tryParseVector(data["group_size"], result.m_GroupSize))
-        return false;
+    // Edges between arranged nodes in flow direction, output -> input.
+    vector<std::pair<int, int>> edges;
+    edges.reserve(m_Links.size());
+    for (auto link : m_Links)
+    {
+        if (!link->m_IsLive && !link->m_WasLive)
+            continue;
 
-    return true;
-}
+        auto startPin = link->m_StartPin;
+        auto endPin   = link->m_EndPin;
+        if (startPin->m_Kind == PinKind::Input && endPin->m_Kind == PinKind::Output)
+            std::swap(startPin, endPin);
 
+        auto start = nodeIndex.find(startPin->m_Node);
+        auto end   = nodeIndex.find(endPin->m_Node);
+        if (start == nodeIndex.end() || end == nodeIndex.end() || start->second == end->second)
+            continue;
 
+        edges.emplace_back(start->second, end->second);
+    }
 
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
 
-//------------------------------------------------------------------------------
-//
-// Settings
-//
-//------------------------------------------------------------------------------
-ed::NodeSettings* ed::Settings::AddNode(NodeId id)
-{
-    m_Nodes.push_back(NodeSettings(id));
-    return &m_Nodes.back();
-}
+    vector<int> outOffsets, outEdges;
+    BuildAdjacency(realCount, edges, outOffsets, outEdges);
 
-ed::NodeSettings* ed::Settings::FindNode(NodeId id)
-{
-    for (auto& settings : m_Nodes)
-        if (settings.m_ID == id)
-            return &settings;
+    // Break cycles, edges pointing back onto DFS stack are reversed.
+    {
+        vector<char> state(realCount, 0); // 0 - not visited, 1 - on stack, 2 - done
+        vector<std::pair<int, int>> stack; // vertex, next edge slot
+        for (int root = 0; root < realCount; ++root)
+        {
+            if (state[root])
+                continue;
 
-    return nullptr;
-}
+            state[root] = 1;
+            stack.emplace_back(root, outOffsets[root]);
+            while (!stack.empty())
+            {
+                auto& top = stack.back();
+                if (top.second == outOffsets[top.first + 1])
+                {
+                    state[top.first] = 2;
+                    stack.pop_back();
+                    continue;
+                }
 
-void ed::Settings::RemoveNode(NodeId id)
-{
-    auto node = FindNode(id);
-    if (!node)
-        return;
+                auto& edge = edges[outEdges[top.second++]];
+                if (state[edge.second] == 1)
+                    std::swap(edge.first, edge.second);
+                else if (state[edge.second] == 0)
+                {
+                    state[edge.second] = 1;
+                    stack.emplace_back(edge.second, outOffsets[edge.second]);
+                }
+            }
+        }
 
-    *node = NodeSettings(id);
-}
+        // Reversing may produce duplicates of existing edges.
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        BuildAdjacency(realCount, edges, outOffsets, outEdges);
+    }
 
-void ed::Settings::ClearDirty(Node* node)
-{
-    if (node)
+    // Longest path layering, linear in nodes and edges.
+    vector<int> layer(realCount, 0);
     {
-        auto settings = FindNode(node->m_ID);
-        IM_ASSERT(settings);
-        settings->ClearDirty();
+        vector<int> inDegree(realCount, 0);
+        for (auto& edge : edges)
+            ++inDegree[edge.second];
+
+        vector<int> predecessors = inDegree;
+        vector<int> order;
+        order.reserve(realCount);
+        for (int i = 0; i < realCount; ++i)
+            if (predecessors[i] == 0)
+                order.push_back(i);
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const int v = order[i];
+            for (int e = outOffsets[v]; e < outOffsets[v + 1]; ++e)
+            {
+                const int w = edges[outEdges[e]].second;
+                layer[w] = ImMax(layer[w], layer[v] + 1);
+                if (--predecessors[w] == 0)
+                    order.push_back(w);
+            }
+        }
+
+        // Sources are pulled next to their closest successor, long links need more dummies.
+        for (int v = 0; v < realCount; ++v)
+        {
+            if (inDegree[v] != 0 || outOffsets[v] == outOffsets[v + 1])
+                continue;
+
+            int closest = INT_MAX;
+            for (int e = outOffsets[v]; e < outOffsets[v + 1]; ++e)
+                closest = ImMin(closest, layer[edges[outEdges[e]].second]);
+
+            layer[v] = closest - 1;
+        }
     }
-    else
+
+    // Links spanning multiple layers are not split by dummy vertices. On graphs
+    // with long links that would multiply vertex count by average link span.
+    // Instead neighbours are weighted by inverse of the span.
+    vector<int> inOffsets, inEdges;
     {
-        m_IsDirty     = false;
-        m_DirtyReason = SaveReasonFlags::None;
+        vector<std::pair<int, int>> reversedEdges(edges.size());
+        for (size_t i = 0; i < edges.size(); ++i)
+            reversedEdges[i] = std::make_pair(edges[i].second, edges[i].first);
 
-        for (auto& knownNode : m_Nodes)
-            knownNode.ClearDirty();
+        BuildAdjacency(realCount, reversedEdges, inOffsets, inEdges);
     }
-}
 
-void ed::Settings::MakeDirty(SaveReasonFlags reason, Node* node)
-{
-    m_IsDirty     = true;
-    m_DirtyReason = m_DirtyReason | reason;
+    vector<float> edgeWeight(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i)
+        edgeWeight[i] = 1.0f / static_cast<float>(layer[edges[i].second] - layer[edges[i].first]);
 
-    if (node)
+    // Initial order in layer follows current vertical placement.
+    int layerCount = 0;
+    for (auto l : layer)
+        layerCount = ImMax(layerCount, l + 1);
+
+    vector<vector<int>> layers(layerCount);
+    for (int v = 0; v < realCount; ++v)
+        layers[layer[v]].push_back(v);
+
+    // Rank is position in layer normalized to [0, 1], so layers of different
+    // sizes can be compared.
+    vector<float> rank(realCount);
+    auto updateRanks = [&rank](const vector<int>& vertices)
     {
-        auto settings = FindNode(node->m_ID);
-        IM_ASSERT(settings);
+        const float scale = 1.0f / static_cast<float>(vertices.size());
+        for (int i = 0; i < static_cast<int>(vertices.size()); ++i)
+            rank[vertices[i]] = (i + 0.5f) * scale;
+    };
 
-        settings->MakeDirty(reason);
+    for (auto& vertices : layers)
+    {
+        std::stable_sort(vertices.begin(), vertices.end(), [&nodes](int lhs, int rhs)
+        {
+            return nodes[lhs]->m_Bounds.GetCenter().y < nodes[rhs]->m_Bounds.GetCenter().y;
+        });
+        updateRanks(vertices);
     }
-}
-
-std::string ed::Settings::Serialize()
-{
-    json::value result;
 
-    auto serializeObjectId = [](ObjectId id)
+    // Crossing reduction. Each sweep reorders every other layer by barycenter of
+    // neighbours. Barycenters are computed for all layers of a sweep first and only
+    // then layers are sorted, both steps run in parallel across layers.
+    vector<float> barycenter(realCount);
+    auto computeBarycenters = [&](int l)
     {
-        auto value = std::to_string(reinterpret_cast<uintptr_t>(id.AsPointer()));
-        switch (id.Type())
+        for (auto v : layers[l])
         {
-            default:
-            case NodeEditor::Detail::ObjectType::None: return value;
-            case NodeEditor::Detail::ObjectType::Node: return "node:" + value;
-            case NodeEditor::Detail::ObjectType::Link: return "link:" + value;
-            case NodeEditor::Detail::ObjectType::Pin:  return "pin:"  + value;
+            float sum    = 0.0f;
+            float weight = 0.0f;
+            for (int i = inOffsets[v]; i < inOffsets[v + 1]; ++i)
+            {
+                sum    += rank[edges[inEdges[i]].first] * edgeWeight[inEdges[i]];
+                weight += edgeWeight[inEdges[i]];
+            }
+            for (int i = outOffsets[v]; i < outOffsets[v + 1]; ++i)
+            {
+                sum    += rank[edges[outEdges[i]].second] * edgeWeight[outEdges[i]];
+                weight += edgeWeight[outEdges[i]];
+            }
+
+            barycenter[v] = weight > 0.0f ? sum / weight : rank[v];
         }
     };
 
-    auto& nodes = result["nodes"];
-    for (auto& node : m_Nodes)
+    auto sortLayer = [&](int l)
     {
-        if (node.m_WasUsed)
-            nodes[serializeObjectId(node.m_ID)] = node.Serialize();
-    }
+        auto& vertices = layers[l];
+        std::stable_sort(vertices.begin(), vertices.end(), [&barycenter](int lhs, int rhs) { return barycenter[lhs] < barycenter[rhs]; });
+        updateRanks(vertices);
+    };
 
-    auto& selection = result["selection"];
-    for (auto& id : m_Selection)
-        selection.push_back(serializeObjectId(id));
+    // Workers are kept by editor, sweeps are too short to start threads for each.
+    auto pool = layerCount >= 2 * 2 * 16 ? &GetLayoutPool() : nullptr;
 
-    auto& view = result["view"];
-    view["scroll"]["x"] = m_ViewScroll.x;
-    view["scroll"]["y"] = m_ViewScroll.y;
-    view["zoom"]   = m_ViewZoom;
-    view["visible_rect"]["min"]["x"] = m_VisibleRect.Min.x;
-    view["visible_rect"]["min"]["y"] = m_VisibleRect.Min.y;
-    view["visible_rect"]["max"]["x"] = m_VisibleRect.Max.x;
-    view["visible_rect"]["max"]["y"] = m_VisibleRect.Max.y;
+    for (int iteration = 0; iteration < config.CrossingIterations; ++iteration)
+    {
+        for (int parity = 0; parity < 2; ++parity)
+        {
+            const int first = (iteration + parity + 1) & 1;
+            const int count = (layerCount - first + 1) / 2;
 
-    return result.dump();
-}
+            ParallelFor(pool, count, 16, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                    computeBarycenters(first + i * 2);
+            });
 
-bool ed::Settings::Parse(const std::string& string, Settings& settings)
-{
-    Settings result = settings;
+            ParallelFor(pool, count, 16, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                    sortLayer(first + i * 2);
+            });
+        }
+    }
 
-    auto settingsValue = json::value::parse(string);
-    if (settingsValue.is_discarded())
-        return false;
+    // Horizontal coordinate is given by layer.
+    vector<float> layerX(layerCount + 1, 0.0f);
+    for (int l = 0; l < layerCount; ++l)
+    {
+        float width = 0.0f;
+        for (auto v : layers[l])
+            width = ImMax(width, nodes[v]->m_Bounds.GetWidth());
 
-    if (!settingsValue.is_object())
-        return false;
+        layerX[l + 1] = layerX[l] + width + config.LayerSpacing;
+    }
 
-    auto tryParseVector = [](const json::value& v, ImVec2& result) -> bool
+    // Vertical coordinate, nodes are stacked in layer order first, then pulled
+    // toward connected neighbours while keeping order and spacing.
+    vector<float> height(realCount);
+    for (int v = 0; v < realCount; ++v)
+        height[v] = nodes[v]->m_Bounds.GetHeight();
+
+    vector<float> y(realCount, 0.0f);
+    for (auto& vertices : layers)
+        for (size_t i = 1; i < vertices.size(); ++i)
+            y[vertices[i]] = y[vertices[i - 1]] + height[vertices[i - 1]] + config.NodeSpacing;
+
+    vector<float> desired, top, bottom;
+    auto alignLayer = [&](int l, bool usePredecessors)
     {
-        if (v.is_object() && v.contains("x") && v.contains("y"))
+        auto& vertices = layers[l];
+        const int count = static_cast<int>(vertices.size());
+        if (count == 0)
+            return;
+
+        auto& offsets = usePredecessors ? inOffsets : outOffsets;
+        auto& items   = usePredecessors ? inEdges   : outEdges;
+
+        desired.resize(count);
+        for (int i = 0; i < count; ++i)
         {
-            auto xValue = v["x"];
-            auto yValue = v["y"];
+            const int v = vertices[i];
 
-            if (xValue.is_number() && yValue.is_number())
+            float sum    = 0.0f;
+            float weight = 0.0f;
+            for (int j = offsets[v]; j < offsets[v + 1]; ++j)
             {
-                result.x = static_cast<float>(xValue.get<double>());
-                result.y = static_cast<float>(yValue.get<double>());
-
-                return true;
+                auto& edge = edges[items[j]];
+                const int neighbour = usePredecessors ? edge.first : edge.second;
+                sum    += (y[neighbour] + height[neighbour] * 0.5f) * edgeWeight[items[j]];
+                weight += edgeWeight[items[j]];
             }
+
+            desired[i] = weight > 0.0f ? sum / weight - height[v] * 0.5f : y[v];
         }
 
-        return false;
+        // Closest placements packed from top and from bottom both keep order
+        // and spacing, so does their average.
+        top.resize(count);
+        bottom.resize(count);
+        top[0] = desired[0];
+        for (int i = 1; i < count; ++i)
+            top[i] = ImMax(desired[i], top[i - 1] + height[vertices[i - 1]] + config.NodeSpacing);
+        bottom[count - 1] = desired[count - 1];
+        for (int i = count - 2; i >= 0; --i)
+            bottom[i] = ImMin(desired[i], bottom[i + 1] - height[vertices[i]] - config.NodeSpacing);
+
+        for (int i = 0; i < count; ++i)
+            y[vertices[i]] = (top[i] + bottom[i]) * 0.5f;
     };
 
-    auto deserializeObjectId = [](const std::string& str)
+    for (int iteration = 0; iteration < config.AlignIterations; ++iteration)
     {
-        auto separator = str.find_first_of(':');
-        auto idStart   = str.c_str() + ((separator != std::string::npos) ? separator + 1 : 0);
-        auto id        = reinterpret_cast<void*>(strtoull(idStart, nullptr, 10));
-        if (str.compare(0, separator, "node") == 0)
-            return ObjectId(NodeId(id));
-        else if (str.compare(0, separator, "link") == 0)
-            return ObjectId(LinkId(id));
-        else if (str.compare(0, separator, "pin") == 0)
-            return ObjectId(PinId(id));
-        else
-            // fallback to old format
-            return ObjectId(NodeId(id)); //return ObjectId();
-    };
+        for (int l = 1; l < layerCount; ++l)
+            alignLayer(l, true);
+        for (int l = layerCount - 2; l >= 0; --l)
+            alignLayer(l, false);
+    }
+
+    // Arranged nodes keep top left corner of area they occupied.
+    ImVec2 origin = nodes[0]->m_Bounds.Min;
+    float  minY   = y[0];
+    for (int i = 0; i < realCount; ++i)
+    {
+        origin = ImMin(origin, nodes[i]->m_Bounds.Min);
+        minY   = ImMin(minY, y[i]);
+    }
+
+    ImRect bounds;
+    for (int i = 0; i < realCount; ++i)
+    {
+        SetNodePosition(nodes[i]->m_ID, origin + ImVec2(layerX[layer[i]], y[i] - minY));
+
+        if (i == 0)
+            bounds = nodes[i]->m_Bounds;
+        else
+            bounds.Add(nodes[i]->m_Bounds);
+    }
+
+    if (config.NavigateToContent)
+        NavigateTo(bounds, true, config.NavigateDuration);
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Node Settings
+//
+//------------------------------------------------------------------------------
+// Binary settings are little-endian dumps of plain values prefixed with a magic,
+// so Parse() can tell them apart from JSON produced by older versions.
+static const char     c_SettingsMagic[4]     = { 'N', 'E', 'D', 'S' };
+static const char     c_NodeSettingsMagic[4] = { 'N', 'E', 'D', 'N' };
+static const uint8_t  c_SettingsVersion      = 1;
+
+struct BinaryWriter
+{
+    std::string& m_Data;
+
+    void Write(const void* data, size_t size) { m_Data.append(static_cast<const char*>(data), size); }
+    void Write(uint8_t value)                 { Write(&value, sizeof(value)); }
+    void Write(uint32_t value)                { uint8_t bytes[4]; for (int i = 0; i < 4; ++i) bytes[i] = static_cast<uint8_t>(value >> (i * 8)); Write(bytes, 4); }
+    void Write(uint64_t value)                { Write(static_cast<uint32_t>(value)); Write(static_cast<uint32_t>(value >> 32)); }
+    void Write(float value)                   { uint32_t bits; memcpy(&bits, &value, sizeof(bits)); Write(bits); }
+    void Write(const ImVec2& value)           { Write(value.x); Write(value.y); }
+};
+
+// JSON and CBOR documents have the same layout, both writers share interface.
+template <typename Writer>
+static void WriteVector(Writer& writer, const char* name, const ImVec2& value)
+{
+    writer.key(name).begin_object(2);
+    writer.key("x").value(value.x);
+    writer.key("y").value(value.y);
+    writer.end_object();
+}
+
+template <typename Writer>
+static void WriteNodeDocument(Writer& writer, const ed::NodeSettings& settings)
+{
+    const bool hasGroup = settings.m_GroupSize.x > 0 || settings.m_GroupSize.y > 0;
+
+    writer.begin_object(hasGroup ? 2 : 1);
+
+    WriteVector(writer, "location", settings.m_Location);
+
+    if (hasGroup)
+        WriteVector(writer, "group_size", settings.m_GroupSize);
+
+    writer.end_object();
+}
+
+struct BinaryReader
+{
+    const uint8_t* m_Data;
+    const uint8_t* m_End;
+
+    BinaryReader(const std::string& data)
+        : m_Data(reinterpret_cast<const uint8_t*>(data.data()))
+        , m_End(m_Data + data.size())
+    {
+    }
+
+    bool Read(void* data, size_t size)
+    {
+        if (static_cast<size_t>(m_End - m_Data) < size)
+            return false;
+        memcpy(data, m_Data, size);
+        m_Data += size;
+        return true;
+    }
+
+    bool Read(uint8_t& value) { return Read(&value, sizeof(value)); }
+    bool Read(uint32_t& value)
+    {
+        uint8_t bytes[4];
+        if (!Read(bytes, 4))
+            return false;
+        value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+        return true;
+    }
+    bool Read(uint64_t& value)
+    {
+        uint32_t lo, hi;
+        if (!Read(lo) || !Read(hi))
+            return false;
+        value = lo | (static_cast<uint64_t>(hi) << 32);
+        return true;
+    }
+    bool Read(float& value)
+    {
+        uint32_t bits;
+        if (!Read(bits))
+            return false;
+        memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+    bool Read(ImVec2& value) { return Read(value.x) && Read(value.y); }
+
+    bool AtEnd() const { return m_Data == m_End; }
+};
+
+static bool HasMagic(const std::string& data, const char (&magic)[4])
+{
+    return data.size() >= sizeof(magic) && memcmp(data.data(), magic, sizeof(magic)) == 0;
+}
+
+static void WriteNodeSettings(BinaryWriter& writer, const ed::NodeSettings& settings)
+{
+    const bool hasGroup = settings.m_GroupSize.x > 0 || settings.m_GroupSize.y > 0;
+
+    writer.Write(settings.m_Location);
+    writer.Write(static_cast<uint8_t>(hasGroup ? 1 : 0));
+    if (hasGroup)
+        writer.Write(settings.m_GroupSize);
+}
+
+static bool ReadNodeSettings(BinaryReader& reader, ed::NodeSettings& settings)
+{
+    uint8_t hasGroup = 0;
+    if (!reader.Read(settings.m_Location) || !reader.Read(hasGroup))
+        return false;
+
+    if (hasGroup && !reader.Read(settings.m_GroupSize))
+        return false;
+
+    return true;
+}
+
+void ed::NodeSettings::ClearDirty()
+{
+    m_IsDirty     = false;
+    m_DirtyReason = SaveReasonFlags::None;
+}
+
+void ed::NodeSettings::MakeDirty(SaveReasonFlags reason)
+{
+    m_IsDirty     = true;
+    m_DirtyReason = m_DirtyReason | reason;
+}
+
+bool ed::NodeSettings::SetLocation(const ImVec2& location)
+{
+    if (m_Location.x == location.x && m_Location.y == location.y)
+        return false;
+
+    m_Location = location;
+    m_Record.clear();
+    return true;
+}
+
+bool ed::NodeSettings::SetGroupSize(const ImVec2& groupSize)
+{
+    if (m_GroupSize.x == groupSize.x && m_GroupSize.y == groupSize.y)
+        return false;
+
+    m_GroupSize = groupSize;
+    m_Record.clear();
+    return true;
+}
+
+std::string ed::NodeSettings::Serialize(SettingsFormat format)
+{
+    switch (format)
+    {
+        case SettingsFormat::Binary: return SerializeBinary();
+        case SettingsFormat::Cbor:   return SerializeCbor();
+        default:                     return SerializeCached();
+    }
+}
+
+const std::string& ed::NodeSettings::SerializeCached()
+{
+    if (m_Record.empty())
+    {
+        json::buffer_sink sink(m_Record);
+        json::writer writer(sink);
+        WriteNodeDocument(writer, *this);
+    }
+
+    return m_Record;
+}
+
+std::string ed::NodeSettings::SerializeBinary() const
+{
+    std::string result;
+    BinaryWriter writer{ result };
+    writer.Write(c_NodeSettingsMagic, sizeof(c_NodeSettingsMagic));
+    writer.Write(c_SettingsVersion);
+    WriteNodeSettings(writer, *this);
+    return result;
+}
+
+std::string ed::NodeSettings::SerializeCbor() const
+{
+    std::string result;
+    json::buffer_sink sink(result);
+    json::cbor_writer writer(sink);
+    writer.self_describe();
+    WriteNodeDocument(writer, *this);
+    writer.flush();
+    return result;
+}
+
+bool ed::NodeSettings::Parse(const std::string& string, NodeSettings& settings)
+{
+    if (HasMagic(string, c_NodeSettingsMagic))
+    {
+        NodeSettings result = settings;
+
+        BinaryReader reader(string);
+        uint8_t version = 0;
+        reader.m_Data += sizeof(c_NodeSettingsMagic);
+        if (!reader.Read(version) || version != c_SettingsVersion || !ReadNodeSettings(reader, result))
+            return false;
+
+        result.m_Record.clear();
+        settings = std::move(result);
+        return true;
+    }
+
+    auto settingsValue = json::value::is_cbor(string) ? json::value::parse_cbor(string) : json::value::parse(string);
+    if (settingsValue.is_discarded())
+        return false;
+
+    return Parse(settingsValue, settings);
+}
+
+bool ed::NodeSettings::Parse(const json::value& data, NodeSettings& result)
+{
+    if (!data.is_object())
+        return false;
+
+    auto tryParseVector = [](const json::value& v, ImVec2& result) -> bool
+    {
+        if (v.is_object())
+        {
+            auto xValue = v["x"];
+            auto yValue = v["y"];
+
+            if (xValue.is_number() && yValue.is_number())
+            {
+                result.x = static_cast<float>(xValue.get<double>());
+                result.y = static_cast<float>(yValue.get<double>());
+
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    if (!tryParseVector(data["location"], result.m_Location))
+        return false;
+
+    if (data.contains("group_size") && !tryParseVector(data["group_size"], result.m_GroupSize))
+        return false;
+
+    result.m_Record.clear();
+
+    return true;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Settings
+//
+//------------------------------------------------------------------------------
+ed::NodeSettings* ed::Settings::AddNode(NodeId id)
+{
+    m_NodeIndex[id.Get()] = static_cast<int>(m_Nodes.size());
+    m_Nodes.push_back(NodeSettings(id));
+    return &m_Nodes.back();
+}
+
+ed::NodeSettings* ed::Settings::FindNode(NodeId id)
+{
+    auto it = m_NodeIndex.find(id.Get());
+    if (it != m_NodeIndex.end())
+        return &m_Nodes[it->second];
+
+    NodeSettings settings(id);
+    if (!ParsePendingNode(settings))
+        return nullptr;
+
+    auto result = AddNode(id);
+    *result = std::move(settings);
+    return result;
+}
+
+bool ed::Settings::ParsePendingNode(NodeSettings& settings) const
+{
+    if (!m_PendingNodes)
+        return false;
+
+    using Entry = std::pair<uintptr_t, json::lazy_value>;
+
+    const auto  id      = settings.m_ID.Get();
+    const auto& pending = m_PendingNodes->m_Nodes;
+
+    auto it = std::lower_bound(pending.begin(), pending.end(), id, [](const Entry& entry, uintptr_t id) { return entry.first < id; });
+    if (it == pending.end() || it->first != id)
+        return false;
+
+    // Same node saved under more than one key is applied in document order,
+    // so later one wins, as with settings parsed up front. Bodies were
+    // checked on load, parse() does not fail here.
+    for (; it != pending.end() && it->first == id; ++it)
+        NodeSettings::Parse(it->second.parse(), settings);
+
+    return true;
+}
+
+void ed::Settings::RemoveNode(NodeId id)
+{
+    auto node = FindNode(id);
+    if (!node)
+        return;
+
+    *node = NodeSettings(id);
+}
+
+void ed::Settings::ClearDirty(Node* node)
+{
+    if (node)
+    {
+        auto settings = FindNode(node->m_ID);
+        IM_ASSERT(settings);
+        settings->ClearDirty();
+    }
+    else
+    {
+        m_IsDirty     = false;
+        m_DirtyReason = SaveReasonFlags::None;
+
+        for (auto& knownNode : m_Nodes)
+            knownNode.ClearDirty();
+    }
+}
+
+void ed::Settings::MakeDirty(SaveReasonFlags reason, Node* node)
+{
+    m_IsDirty     = true;
+    m_DirtyReason = m_DirtyReason | reason;
+
+    if (node)
+    {
+        auto settings = FindNode(node->m_ID);
+        IM_ASSERT(settings);
+
+        settings->MakeDirty(reason);
+    }
+}
+
+static std::string SerializeObjectId(ed::ObjectId id)
+{
+    auto value = std::to_string(reinterpret_cast<uintptr_t>(id.AsPointer()));
+    switch (id.Type())
+    {
+        default:
+        case ed::ObjectType::None: return value;
+        case ed::ObjectType::Node: return "node:" + value;
+        case ed::ObjectType::Link: return "link:" + value;
+        case ed::ObjectType::Pin:  return "pin:"  + value;
+    }
+}
+
+std::string ed::Settings::Serialize(SettingsFormat format)
+{
+    std::string result;
+    json::buffer_sink sink(result);
+    Serialize(sink, format);
+    return result;
+}
+
+template <typename Writer, typename WriteNode>
+static bool WriteSettingsDocument(Writer& writer, ed::Settings& settings, WriteNode&& writeNode)
+{
+    size_t nodeCount = 0;
+    for (auto& node : settings.m_Nodes)
+        if (node.m_WasUsed)
+            ++nodeCount;
+
+    writer.begin_object(3);
+
+    writer.key("nodes").begin_object(nodeCount);
+    for (auto& node : settings.m_Nodes)
+    {
+        if (!node.m_WasUsed)
+            continue;
+
+        writer.key(SerializeObjectId(node.m_ID));
+        writeNode(node);
+    }
+    writer.end_object();
+
+    writer.key("selection").begin_array(settings.m_Selection.size());
+    for (auto& id : settings.m_Selection)
+        writer.value(SerializeObjectId(id));
+    writer.end_array();
+
+    writer.key("view").begin_object(3);
+    WriteVector(writer, "scroll", settings.m_ViewScroll);
+    writer.key("zoom").value(settings.m_ViewZoom);
+    writer.key("visible_rect").begin_object(2);
+    WriteVector(writer, "min", settings.m_VisibleRect.Min);
+    WriteVector(writer, "max", settings.m_VisibleRect.Max);
+    writer.end_object();
+    writer.end_object();
+
+    writer.end_object();
+
+    return writer.flush();
+}
+
+bool ed::Settings::Serialize(json::sink& sink, SettingsFormat format)
+{
+    if (format == SettingsFormat::Binary)
+    {
+        auto data = SerializeBinary();
+        return sink.write(data.data(), data.size());
+    }
+
+    if (format == SettingsFormat::Cbor)
+    {
+        json::cbor_writer writer(sink);
+        writer.self_describe();
+        return WriteSettingsDocument(writer, *this, [&writer](const NodeSettings& node) { WriteNodeDocument(writer, node); });
+    }
+
+    // Document is streamed from cached node records, only nodes which changed
+    // since last save are converted to JSON again.
+    json::writer writer(sink);
+    return WriteSettingsDocument(writer, *this, [&writer](NodeSettings& node) { writer.raw_value(node.SerializeCached()); });
+}
+
+std::string ed::Settings::SerializeBinary() const
+{
+    std::string result;
+    result.reserve(64 + m_Nodes.size() * 32 + m_Selection.size() * 9);
+
+    BinaryWriter writer{ result };
+    writer.Write(c_SettingsMagic, sizeof(c_SettingsMagic));
+    writer.Write(c_SettingsVersion);
+
+    writer.Write(m_ViewScroll);
+    writer.Write(m_ViewZoom);
+    writer.Write(m_VisibleRect.Min);
+    writer.Write(m_VisibleRect.Max);
+
+    writer.Write(static_cast<uint32_t>(m_Selection.size()));
+    for (auto& id : m_Selection)
+    {
+        writer.Write(static_cast<uint8_t>(id.Type()));
+        writer.Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(id.AsPointer())));
+    }
+
+    uint32_t usedNodes = 0;
+    for (auto& node : m_Nodes)
+        if (node.m_WasUsed)
+            ++usedNodes;
+
+    writer.Write(usedNodes);
+    for (auto& node : m_Nodes)
+    {
+        if (!node.m_WasUsed)
+            continue;
+
+        writer.Write(static_cast<uint64_t>(node.m_ID.Get()));
+        WriteNodeSettings(writer, node);
+    }
+
+    return result;
+}
+
+bool ed::Settings::ParseBinary(const std::string& string, Settings& settings)
+{
+    Settings result = settings;
+
+    BinaryReader reader(string);
+    reader.m_Data += sizeof(c_SettingsMagic);
+
+    uint8_t version = 0;
+    if (!reader.Read(version) || version != c_SettingsVersion)
+        return false;
+
+    if (!reader.Read(result.m_ViewScroll) || !reader.Read(result.m_ViewZoom)
+     || !reader.Read(result.m_VisibleRect.Min) || !reader.Read(result.m_VisibleRect.Max))
+        return false;
+
+    uint32_t selectionCount = 0;
+    if (!reader.Read(selectionCount))
+        return false;
+
+    result.m_Selection.resize(0);
+    for (uint32_t i = 0; i < selectionCount; ++i)
+    {
+        uint8_t  type = 0;
+        uint64_t id   = 0;
+        if (!reader.Read(type) || !reader.Read(id))
+            return false;
+
+        auto pointer = reinterpret_cast<void*>(static_cast<uintptr_t>(id));
+        switch (static_cast<ObjectType>(type))
+        {
+            case ObjectType::Link: result.m_Selection.push_back(ObjectId(LinkId(pointer))); break;
+            case ObjectType::Pin:  result.m_Selection.push_back(ObjectId(PinId(pointer)));  break;
+            default:               result.m_Selection.push_back(ObjectId(NodeId(pointer))); break;
+        }
+    }
+
+    uint32_t nodeCount = 0;
+    if (!reader.Read(nodeCount))
+        return false;
+
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        uint64_t id = 0;
+        if (!reader.Read(id))
+            return false;
+
+        auto nodeId       = NodeId(static_cast<uintptr_t>(id));
+        auto nodeSettings = result.FindNode(nodeId);
+        if (!nodeSettings)
+            nodeSettings = result.AddNode(nodeId);
+
+        if (!ReadNodeSettings(reader, *nodeSettings))
+            return false;
+
+        nodeSettings->m_Record.clear();
+    }
+
+    if (!reader.AtEnd())
+        return false;
+
+    settings = std::move(result);
+
+    return true;
+}
+
+bool ed::Settings::Parse(const std::string& string, Settings& settings)
+{
+    if (HasMagic(string, c_SettingsMagic))
+        return ParseBinary(string, settings);
+
+    Settings result = settings;
+
+    json::value                   settingsValue;
+    std::shared_ptr<PendingNodes> pendingNodes;
+    if (json::value::is_cbor(string))
+    {
+        // CBOR holds the same document as JSON text.
+        settingsValue = json::value::parse_cbor(string);
+        if (!settingsValue.is_object())
+            return false;
+    }
+    else
+    {
+        // JSON text is only indexed. Selection and view are parsed now, nodes
+        // when they are looked for, most of them may never be.
+        pendingNodes = std::make_shared<PendingNodes>();
+        pendingNodes->m_Document = json::lazy_document::parse(std::string(string));
+
+        auto root = pendingNodes->m_Document.root();
+        if (!root.is_object())
+            return false;
+
+        // Values are checked without being built, malformed node fails whole
+        // load like it did when everything was parsed up front.
+        if (!root.is_valid())
+            return false;
+
+        settingsValue = json::value(json::type_t::object);
+        for (auto key : { "selection", "view" })
+        {
+            auto member = root[key];
+            if (member.is_discarded())
+                continue;
+
+            auto memberValue = member.parse();
+            if (memberValue.is_discarded())
+                return false;
+
+            settingsValue[key] = std::move(memberValue);
+        }
+    }
+
+    auto tryParseVector = [](const json::value& v, ImVec2& result) -> bool
+    {
+        if (v.is_object() && v.contains("x") && v.contains("y"))
+        {
+            auto xValue = v["x"];
+            auto yValue = v["y"];
+
+            if (xValue.is_number() && yValue.is_number())
+            {
+                result.x = static_cast<float>(xValue.get<double>());
+                result.y = static_cast<float>(yValue.get<double>());
+
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    auto deserializeObjectId = [](const std::string& str)
+    {
+        auto separator = str.find_first_of(':');
+        auto idStart   = str.c_str() + ((separator != std::string::npos) ? separator + 1 : 0);
+        auto id        = reinterpret_cast<void*>(strtoull(idStart, nullptr, 10));
+        if (str.compare(0, separator, "node") == 0)
+            return ObjectId(NodeId(id));
+        else if (str.compare(0, separator, "link") == 0)
+            return ObjectId(LinkId(id));
+        else if (str.compare(0, separator, "pin") == 0)
+            return ObjectId(PinId(id));
+        else
+            // fallback to old format
+            return ObjectId(NodeId(id)); //return ObjectId();
+    };
+
+    //auto& settingsObject = settingsValue.get<json::object>();
+
+    if (pendingNodes)
+    {
+        auto nodesValue = pendingNodes->m_Document.root()["nodes"];
+        for (auto it = nodesValue.begin(), end = nodesValue.end(); it != end; ++it)
+            pendingNodes->m_Nodes.emplace_back(deserializeObjectId(std::string(it.key())).AsNodeId().Get(), *it);
+
+        std::stable_sort(pendingNodes->m_Nodes.begin(), pendingNodes->m_Nodes.end(),
+            [](const std::pair<uintptr_t, json::lazy_value>& lhs, const std::pair<uintptr_t, json::lazy_value>& rhs) { return lhs.first < rhs.first; });
+
+        if (!pendingNodes->m_Nodes.empty())
+        {
+            // Nodes left from previous load are parsed before their document
+            // is dropped. Known nodes take new settings right away.
+            if (result.m_PendingNodes)
+                for (auto& node : result.m_PendingNodes->m_Nodes)
+                    result.FindNode(NodeId(node.first));
+
+            result.m_PendingNodes = std::move(pendingNodes);
+
+            for (auto& node : result.m_Nodes)
+                result.ParsePendingNode(node);
+        }
+    }
+    else
+    {
+        auto& nodesValue = settingsValue["nodes"];
+        if (nodesValue.is_object())
+        {
+            for (auto& node : nodesValue.get<json::object>())
+            {
+                auto id = deserializeObjectId(node.first).AsNodeId();
+
+                auto nodeSettings = result.FindNode(id);
+                if (!nodeSettings)
+                    nodeSettings = result.AddNode(id);
+
+                NodeSettings::Parse(node.second, *nodeSettings);
+            }
+        }
+    }
+
+    auto& selectionValue = settingsValue["selection"];
+    if (selectionValue.is_array())
+    {
+        const auto selectionArray = selectionValue.get<json::array>();
+
+        result.m_Selection.reserve(selectionArray.size());
+        result.m_Selection.resize(0);
+        for (auto& selection : selectionArray)
+        {
+            if (selection.is_string())
+                result.m_Selection.push_back(deserializeObjectId(selection.get<json::string>()));
+        }
+    }
+
+    auto& viewValue = settingsValue["view"];
+    if (viewValue.is_object())
+    {
+        // Looking up missing member inserts it, which invalidates references
+        // to other members. Each one is used before next lookup.
+        if (!tryParseVector(viewValue["scroll"], result.m_ViewScroll))
+            result.m_ViewScroll = ImVec2(0, 0);
+
+        auto& viewZoomValue = viewValue["zoom"];
+
+        result.m_ViewZoom = viewZoomValue.is_number() ? static_cast<float>(viewZoomValue.get<double>()) : 1.0f;
+
+        if (!viewValue.contains("visible_rect") || !tryParseVector(viewValue["visible_rect"]["min"], result.m_VisibleRect.Min) || !tryParseVector(viewValue["visible_rect"]["max"], result.m_VisibleRect.Max))
+            result.m_VisibleRect = {};
+    }
+
+    settings = std::move(result);
+
+    return true;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Settings Saver
+//
+//------------------------------------------------------------------------------
+void ed::SettingsSaver::Snapshot::AddNode(const NodeSettings& settings)
+{
+    m_NodeIndex[settings.m_ID.Get()] = static_cast<int>(m_Nodes.size());
+    m_Nodes.push_back(settings);
+}
+
+void ed::SettingsSaver::Snapshot::Merge(Snapshot&& newer)
+{
+    for (auto& node : newer.m_Nodes)
+    {
+        auto it = m_NodeIndex.find(node.m_ID.Get());
+        if (it == m_NodeIndex.end())
+        {
+            AddNode(node);
+            continue;
+        }
+
+        // Keep request to save node, if older snapshot had one and node was not removed since.
+        auto& older = m_Nodes[it->second];
+        if (!node.m_WasUsed)
+        {
+            older = std::move(node);
+            continue;
+        }
+
+        auto  isDirty     = older.m_IsDirty || node.m_IsDirty;
+        auto  dirtyReason = older.m_DirtyReason | node.m_DirtyReason;
+        older = std::move(node);
+        older.m_IsDirty     = isDirty;
+        older.m_DirtyReason = dirtyReason;
+    }
+
+    m_Selection   = std::move(newer.m_Selection);
+    m_ViewScroll  = newer.m_ViewScroll;
+    m_ViewZoom    = newer.m_ViewZoom;
+    m_VisibleRect = newer.m_VisibleRect;
+    m_Reason      = m_Reason | newer.m_Reason;
+}
+
+ed::SettingsSaver::SettingsSaver(const Config& config, const Settings& settings)
+    : m_Config(config)
+    , m_Settings(settings)
+    , m_HasPending(false)
+    , m_Quit(false)
+    , m_HasFailed(false)
+    , m_FailedReason(SaveReasonFlags::None)
+{
+    m_Thread = std::thread(&SettingsSaver::WorkerMain, this);
+}
+
+ed::SettingsSaver::~SettingsSaver()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Quit = true;
+    }
+    m_WakeUp.notify_one();
+
+    // Worker writes pending snapshot before it quits.
+    m_Thread.join();
+}
+
+void ed::SettingsSaver::Submit(Snapshot&& snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_HasPending)
+            m_Pending.Merge(std::move(snapshot));
+        else
+            m_Pending = std::move(snapshot);
+        m_HasPending = true;
+    }
+    m_WakeUp.notify_one();
+}
+
+bool ed::SettingsSaver::TakeFailures(bool& failed, SaveReasonFlags& reason, vector<NodeFailure>& nodes)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_HasFailed && m_FailedNodes.empty())
+        return false;
+
+    failed = m_HasFailed;
+    reason = m_FailedReason;
+    nodes  = std::move(m_FailedNodes);
+
+    m_HasFailed    = false;
+    m_FailedReason = SaveReasonFlags::None;
+    m_FailedNodes.clear();
+
+    return true;
+}
+
+void ed::SettingsSaver::WorkerMain()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;)
+    {
+        m_WakeUp.wait(lock, [this] { return m_HasPending || m_Quit; });
+        if (!m_HasPending)
+            break;
+
+        Snapshot snapshot = std::move(m_Pending);
+        m_Pending    = Snapshot();
+        m_HasPending = false;
+        lock.unlock();
+
+        vector<NodeFailure> failedNodes;
+        auto saved = Write(snapshot, failedNodes);
+
+        lock.lock();
+        if (!saved)
+        {
+            m_HasFailed    = true;
+            m_FailedReason = m_FailedReason | snapshot.m_Reason;
+        }
+        m_FailedNodes.insert(m_FailedNodes.end(), failedNodes.begin(), failedNodes.end());
+    }
+}
+
+bool ed::SettingsSaver::Write(Snapshot& snapshot, vector<NodeFailure>& failedNodes)
+{
+    m_Config.BeginSave();
+
+    for (auto& node : snapshot.m_Nodes)
+    {
+        if (!node.m_WasUsed)
+        {
+            m_Settings.RemoveNode(node.m_ID);
+            continue;
+        }
+
+        auto settings = m_Settings.FindNode(node.m_ID);
+        if (!settings)
+            settings = m_Settings.AddNode(node.m_ID);
+
+        settings->SetLocation(node.m_Location);
+        settings->SetGroupSize(node.m_GroupSize);
+        settings->m_Size    = node.m_Size;
+        settings->m_WasUsed = node.m_WasUsed;
+
+        if (!node.m_IsDirty)
+            continue;
+
+        if (!m_Config.SaveNode(node.m_ID, settings->Serialize(m_Config.SettingsFormat), node.m_DirtyReason))
+            failedNodes.push_back({ node.m_ID, node.m_DirtyReason });
+    }
+
+    m_Settings.m_Selection   = std::move(snapshot.m_Selection);
+    m_Settings.m_ViewScroll  = snapshot.m_ViewScroll;
+    m_Settings.m_ViewZoom    = snapshot.m_ViewZoom;
+    m_Settings.m_VisibleRect = snapshot.m_VisibleRect;
+
+    auto saved = m_Config.Save(m_Settings, snapshot.m_Reason);
+
+    m_Config.EndSave();
+
+    return saved;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Frame Profiler
+//
+//------------------------------------------------------------------------------
+ed::FrameProfiler::FrameProfiler()
+    : m_Next(0)
+    , m_FrameCount(0)
+    , m_VertexStart(0)
+    , m_IndexStart(0)
+    , m_VertexCount(0)
+    , m_IndexCount(0)
+    , m_ChannelCount(0)
+    , m_SubmissionStart(Clock::now())
+{
+    memset(m_Current, 0, sizeof(m_Current));
+    memset(m_History, 0, sizeof(m_History));
+}
+
+void ed::FrameProfiler::BeginFrame(const ImDrawList* drawList)
+{
+    memset(m_Current, 0, sizeof(m_Current));
+
+    m_VertexStart = drawList ? drawList->VtxBuffer.Size : 0;
+    m_IndexStart  = drawList ? drawList->IdxBuffer.Size : 0;
+}
+
+void ed::FrameProfiler::EndFrame(const ImDrawList* drawList, int channelCount)
+{
+    for (int i = 0; i < c_PhaseCount; ++i)
+        m_History[i][m_Next] = m_Current[i];
+
+    m_Next       = (m_Next + 1) % c_HistorySize;
+    m_FrameCount = ImMin(m_FrameCount + 1, c_HistorySize);
+
+    m_VertexCount  = drawList ? drawList->VtxBuffer.Size - m_VertexStart : 0;
+    m_IndexCount   = drawList ? drawList->IdxBuffer.Size - m_IndexStart  : 0;
+    m_ChannelCount = channelCount;
+}
+
+void ed::FrameProfiler::Add(ProfilerPhase phase, Clock::time_point start)
+{
+    m_Current[static_cast<int>(phase)] += std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+ed::ProfilerStats ed::FrameProfiler::GetStats() const
+{
+    ProfilerStats stats = {};
+    stats.FrameCount   = m_FrameCount;
+    stats.VertexCount  = m_VertexCount;
+    stats.IndexCount   = m_IndexCount;
+    stats.ChannelCount = m_ChannelCount;
+
+    if (m_FrameCount == 0)
+        return stats;
+
+    const auto last = (m_Next + c_HistorySize - 1) % c_HistorySize;
+
+    float samples[c_HistorySize];
+    for (int i = 0; i < c_PhaseCount; ++i)
+    {
+        // History is full or filled from the start, so first m_FrameCount entries are valid.
+        memcpy(samples, m_History[i], sizeof(float) * m_FrameCount);
+
+        auto sum = 0.0f;
+        auto min = samples[0];
+        for (int j = 0; j < m_FrameCount; ++j)
+        {
+            sum += samples[j];
+            min  = ImMin(min, samples[j]);
+        }
 
-    //auto& settingsObject = settingsValue.get<json::object>();
+        const auto p99 = ImClamp(static_cast<int>(ImCeil(m_FrameCount * 0.99f)) - 1, 0, m_FrameCount - 1);
+        std::nth_element(samples, samples + p99, samples + m_FrameCount);
+
+        auto& phase = stats.Phases[i];
+        phase.Last    = m_History[i][last];
+        phase.Min     = min;
+        phase.Average = sum / m_FrameCount;
+        phase.P99     = samples[p99];
+    }
+
+    return stats;
+}
+
+const char* ed::FrameProfiler::GetPhaseName(ProfilerPhase phase)
+{
+    switch (phase)
+    {
+        case ProfilerPhase::Begin:          return "Begin";
+        case ProfilerPhase::Submission:     return "Submission";
+        case ProfilerPhase::BuildControl:   return "BuildControl";
+        case ProfilerPhase::DrawNodes:      return "DrawNodes";
+        case ProfilerPhase::DrawLinks:      return "DrawLinks";
+        case ProfilerPhase::Highlight:      return "Highlight";
+        case ProfilerPhase::Animations:     return "Animations";
+        case ProfilerPhase::Actions:        return "Actions";
+        case ProfilerPhase::ChannelMerge:   return "ChannelMerge";
+        case ProfilerPhase::Minimap:        return "Minimap";
+        case ProfilerPhase::SaveSettings:   return "SaveSettings";
+        case ProfilerPhase::Count:          break;
+    }
+
+    return "";
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Group Membership
+//
+//------------------------------------------------------------------------------
+// Above this many changed groups incremental update costs more than rebuild.
+static const int c_MaxIncrementalGroupChanges = 8;
+
+void ed::GroupMembership::Record(Entry& entry) const
+{
+    entry.m_Bounds      = entry.m_Node->m_Bounds;
+    entry.m_GroupBounds = entry.m_Node->m_GroupBounds;
+    entry.m_IsGroup     = IsGroup(entry.m_Node);
+    entry.m_IsLive      = entry.m_Node->m_IsLive;
+}
+
+bool ed::GroupMembership::IsMember(const Entry& group, const Entry& node) const
+{
+    return &group != &node && group.m_IsLive && node.m_IsLive && !ImRect_IsEmpty(node.m_Bounds) && group.m_GroupBounds.Contains(node.m_Bounds);
+}
+
+void ed::GroupMembership::Update(const vector<ObjectWrapper<Node>>& nodes)
+{
+    if (m_NeedRebuild || nodes.size() != m_Entries.size())
+    {
+        Rebuild(nodes);
+        return;
+    }
+
+    if (m_ChangedEntries.empty())
+        return;
+
+    // Of nodes reported since last update, find ones which moved and groups which changed.
+    vector<int> changedNodes;
+    vector<int> changedGroups;
+    for (auto index : m_ChangedEntries)
+    {
+        auto& entry = m_Entries[index];
+        auto  node  = entry.m_Node;
+        entry.m_IsChanged = false;
+
+        if (entry.m_Bounds.Min == node->m_Bounds.Min && entry.m_Bounds.Max == node->m_Bounds.Max &&
+            entry.m_GroupBounds.Min == node->m_GroupBounds.Min && entry.m_GroupBounds.Max == node->m_GroupBounds.Max &&
+            entry.m_IsGroup == IsGroup(node) && entry.m_IsLive == node->m_IsLive)
+            continue;
+
+        if (entry.m_IsGroup != IsGroup(node))
+        {
+            Rebuild(nodes);
+            return;
+        }
+
+        Record(entry);
+        changedNodes.push_back(index);
+        if (entry.m_IsGroup)
+            changedGroups.push_back(index);
+    }
+    m_ChangedEntries.resize(0);
+
+    if (static_cast<int>(changedGroups.size()) > c_MaxIncrementalGroupChanges)
+    {
+        Rebuild(nodes);
+        return;
+    }
+
+    for (auto group : changedGroups)
+        CollectMembers(group);
+
+    for (auto node : changedNodes)
+    {
+        Detach(node);
+        AttachToGroups(node);
+    }
+}
+
+void ed::GroupMembership::MarkChanged(Node* node)
+{
+    if (m_NeedRebuild)
+        return;
+
+    // Node is not tracked yet.
+    const auto index = node->m_MembershipIndex;
+    if (index < 0 || index >= static_cast<int>(m_Entries.size()) || m_Entries[index].m_Node != node)
+    {
+        m_NeedRebuild = true;
+        return;
+    }
+
+    auto& entry = m_Entries[index];
+    if (entry.m_IsChanged)
+        return;
+
+    entry.m_IsChanged = true;
+    m_ChangedEntries.push_back(index);
+}
+
+void ed::GroupMembership::GetMembers(const Node* group, vector<Node*>& result) const
+{
+    const auto index = group->m_MembershipIndex;
+    if (index < 0 || index >= static_cast<int>(m_Entries.size()) || m_Entries[index].m_Node != group)
+        return;
+
+    for (auto member : m_Entries[index].m_Members)
+        result.push_back(m_Entries[member].m_Node);
+}
+
+void ed::GroupMembership::Rebuild(const vector<ObjectWrapper<Node>>& nodes)
+{
+    m_NeedRebuild = false;
+
+    m_Entries.resize(nodes.size());
+    m_GroupEntries.resize(0);
+    m_ChangedEntries.resize(0);
+
+    vector<int> groups;
+    vector<int> order;
+    order.reserve(nodes.size());
+
+    for (int i = 0; i < static_cast<int>(nodes.size()); ++i)
+    {
+        auto& entry = m_Entries[i];
+        entry.m_Node = nodes[i].m_Object;
+        entry.m_Node->m_MembershipIndex = i;
+        entry.m_IsChanged = false;
+        entry.m_Groups.resize(0);
+        entry.m_Members.resize(0);
+        Record(entry);
+
+        if (entry.m_IsGroup)
+            m_GroupEntries.push_back(i);
+        if (entry.m_IsGroup && entry.m_IsLive && !ImRect_IsEmpty(entry.m_GroupBounds))
+            groups.push_back(i);
+        if (entry.m_IsLive && !ImRect_IsEmpty(entry.m_Bounds))
+            order.push_back(i);
+    }
+
+    // Sweep nodes and groups from left to right. Group is active while sweep
+    // line is within its horizontal extent, only active groups are tested.
+    std::sort(groups.begin(), groups.end(), [this](int lhs, int rhs) { return m_Entries[lhs].m_GroupBounds.Min.x < m_Entries[rhs].m_GroupBounds.Min.x; });
+    std::sort(order.begin(),  order.end(),  [this](int lhs, int rhs) { return m_Entries[lhs].m_Bounds.Min.x      < m_Entries[rhs].m_Bounds.Min.x; });
+
+    vector<int> active;
+    size_t nextGroup = 0;
+    for (auto index : order)
+    {
+        auto& node = m_Entries[index];
+
+        while (nextGroup < groups.size() && m_Entries[groups[nextGroup]].m_GroupBounds.Min.x <= node.m_Bounds.Min.x)
+            active.push_back(groups[nextGroup++]);
+
+        active.erase(std::remove_if(active.begin(), active.end(), [this, &node](int group)
+        {
+            return m_Entries[group].m_GroupBounds.Max.x < node.m_Bounds.Min.x;
+        }), active.end());
+
+        for (auto group : active)
+        {
+            if (!IsMember(m_Entries[group], node))
+                continue;
+
+            m_Entries[group].m_Members.push_back(index);
+            node.m_Groups.push_back(group);
+        }
+    }
+}
+
+void ed::GroupMembership::Detach(int node)
+{
+    auto& entry = m_Entries[node];
+    for (auto group : entry.m_Groups)
+    {
+        auto& members = m_Entries[group].m_Members;
+        members.erase(std::find(members.begin(), members.end(), node));
+    }
+    entry.m_Groups.resize(0);
+}
+
+void ed::GroupMembership::DetachMembers(int group)
+{
+    auto& entry = m_Entries[group];
+    for (auto member : entry.m_Members)
+    {
+        auto& groups = m_Entries[member].m_Groups;
+        groups.erase(std::find(groups.begin(), groups.end(), group));
+    }
+    entry.m_Members.resize(0);
+}
+
+void ed::GroupMembership::AttachToGroups(int node)
+{
+    auto& entry = m_Entries[node];
+    for (auto group : m_GroupEntries)
+    {
+        if (!IsMember(m_Entries[group], entry))
+            continue;
+
+        m_Entries[group].m_Members.push_back(node);
+        entry.m_Groups.push_back(group);
+    }
+}
+
+void ed::GroupMembership::CollectMembers(int group)
+{
+    DetachMembers(group);
+
+    auto& entry = m_Entries[group];
+    if (ImRect_IsEmpty(entry.m_GroupBounds))
+        return;
+
+    for (int i = 0; i < static_cast<int>(m_Entries.size()); ++i)
+    {
+        if (!IsMember(entry, m_Entries[i]))
+            continue;
+
+        entry.m_Members.push_back(i);
+        m_Entries[i].m_Groups.push_back(group);
+    }
+}
+
+
+
+//------------------------------------------------------------------------------
+//
+// Minimap
+//
+//------------------------------------------------------------------------------
+// Free space left around content, relative to its larger extent.
+static const float c_MinimapContentMargin = 0.1f;
+// Distance between minimap and edges of the editor, in pixels.
+static const float c_MinimapPadding = 10.0f;
+// Links are rasterised as polylines with this many segments.
+static const int c_MinimapLinkSegments = 8;
+
+ed::Minimap::Minimap(EditorContext* editor)
+    : Editor(editor)
+    , m_CellSize(1.0f)
+    , m_Width(0)
+    , m_Height(0)
+    , m_LiveNodeCount(0)
+    , m_RebuildLiveNodeCount(0)
+    , m_RebuildCount(0)
+    , m_ChangeCount(0)
+    , m_SizeFraction(0.2f)
+    , m_Location(MinimapLocation::BottomRight)
+    , m_IsVisible(false)
+    , m_IsHovered(false)
+    , m_NeedRebuild(true)
+{
+}
+
+void ed::Minimap::Show(float sizeFraction, MinimapLocation location)
+{
+    m_SizeFraction = ImClamp(sizeFraction, 0.05f, 1.0f);
+    m_Location     = location;
+    m_IsVisible    = true;
+}
 
-    auto& nodesValue = settingsValue["nodes"];
-    if (nodesValue.is_object())
+void ed::Minimap::Update(const vector<ObjectWrapper<Node>>& nodes, const vector<ObjectWrapper<Link>>& links, const ImRect& editorRect)
+{
+    m_ChangeCount = 0;
+
+    if (m_NeedRebuild || nodes.size() != m_NodeEntries.size() || links.size() != m_LinkEntries.size() || !UpdateNodes() || !UpdateLinks())
+        Rebuild(nodes, links);
+
+    UpdateRows();
+
+    // Keep aspect of the content, fit into fraction of the editor.
+    const auto maxSize = editorRect.GetSize() * m_SizeFraction;
+    auto size = maxSize;
+    if (m_Width > 0 && m_Height > 0)
+    {
+        const auto scale = ImMin(maxSize.x / m_Width, maxSize.y / m_Height);
+        size = ImVec2(m_Width * scale, m_Height * scale);
+    }
+
+    const auto isLeft = m_Location == MinimapLocation::TopLeft || m_Location == MinimapLocation::BottomLeft;
+    const auto isTop  = m_Location == MinimapLocation::TopLeft || m_Location == MinimapLocation::TopRight;
+
+    ImVec2 position;
+    position.x = isLeft ? editorRect.Min.x + c_MinimapPadding : editorRect.Max.x - c_MinimapPadding - size.x;
+    position.y = isTop  ? editorRect.Min.y + c_MinimapPadding : editorRect.Max.y - c_MinimapPadding - size.y;
+
+    m_Rect = ImRect(ImFloor(position), ImFloor(position + size));
+}
+
+void ed::Minimap::MarkChanged(Node* node)
+{
+    if (m_NeedRebuild)
+        return;
+
+    auto index = node->m_MinimapIndex;
+    if (index < 0 || index >= static_cast<int>(m_NodeEntries.size()) || m_NodeEntries[index].m_Node != node)
+    {
+        // New node, it is placed by next update.
+        NodeEntry entry = {};
+        entry.m_Node = node;
+        index = static_cast<int>(m_NodeEntries.size());
+        node->m_MinimapIndex = index;
+        m_NodeEntries.push_back(entry);
+    }
+
+    auto& entry = m_NodeEntries[index];
+    if (entry.m_IsChanged)
+        return;
+
+    entry.m_IsChanged = true;
+    m_ChangedNodes.push_back(index);
+}
+
+void ed::Minimap::MarkChanged(Link* link)
+{
+    if (m_NeedRebuild)
+        return;
+
+    auto index = link->m_MinimapIndex;
+    if (index < 0 || index >= static_cast<int>(m_LinkEntries.size()) || m_LinkEntries[index].m_Link != link)
+    {
+        // New link, it is placed by next update.
+        LinkEntry entry = {};
+        entry.m_Link = link;
+        index = static_cast<int>(m_LinkEntries.size());
+        link->m_MinimapIndex = index;
+        m_LinkEntries.push_back(std::move(entry));
+    }
+
+    auto& entry = m_LinkEntries[index];
+    if (entry.m_IsChanged)
+        return;
+
+    entry.m_IsChanged = true;
+    m_ChangedLinks.push_back(index);
+}
+
+bool ed::Minimap::ProcessInput(ImVec2& target, bool& isClick)
+{
+    m_IsHovered = false;
+
+    const auto rect = ImRect(Editor->ToCanvas(m_Rect.Min), Editor->ToCanvas(m_Rect.Max));
+    if (ImRect_IsEmpty(rect))
+        return false;
+
+    ImGui::SetCursorScreenPos(rect.Min);
+    ImGui::InvisibleButton("##minimap", rect.GetSize());
+
+    m_IsHovered = ImGui::IsItemHovered();
+
+    if (!ImGui::IsItemActive() || m_Width == 0 || m_Height == 0)
+        return false;
+
+    auto& io = ImGui::GetIO();
+    isClick = ImGui::IsItemActivated();
+    if (!isClick && io.MouseDelta.x == 0.0f && io.MouseDelta.y == 0.0f)
+        return false;
+
+    const auto point = ImClamp(Editor->ToScreen(ImGui::GetMousePos()), m_Rect.Min, m_Rect.Max);
+    target = m_World.Min + (point - m_Rect.Min) * (m_World.GetSize() / m_Rect.GetSize());
+
+    return true;
+}
+
+void ed::Minimap::Draw(ImDrawList* drawList, const ImRect& viewRect)
+{
+    drawList->AddRectFilled(m_Rect.Min, m_Rect.Max, Editor->GetColor(StyleColor_MinimapBg));
+
+    if (m_Width > 0 && m_Height > 0)
+    {
+        drawList->PushClipRect(m_Rect.Min, m_Rect.Max, true);
+
+        const auto cellSize = m_Rect.GetWidth() / m_Width;
+
+        static const StyleColor c_LayerColors[Layer_Count] =
+        {
+            StyleColor_MinimapGroup,
+            StyleColor_MinimapLink,
+            StyleColor_MinimapNode
+        };
+
+        for (int layer = 0; layer < Layer_Count; ++layer)
+        {
+            const auto color = Editor->GetColor(c_LayerColors[layer]);
+            for (int y = 0; y < m_Height; ++y)
+            {
+                for (auto& run : m_Rows[layer][y])
+                {
+                    drawList->AddRectFilled(
+                        m_Rect.Min + ImVec2(run.m_Begin * cellSize, y       * cellSize),
+                        m_Rect.Min + ImVec2(run.m_End   * cellSize, (y + 1) * cellSize),
+                        color);
+                }
+            }
+        }
+
+        // Selection is small compared to the graph, draw it exactly.
+        const auto selectionColor = Editor->GetColor(StyleColor_SelNodeBorder);
+        for (auto object : Editor->GetSelectedObjects())
+        {
+            auto node = object->AsNode();
+            if (!node || !node->m_IsLive)
+                continue;
+
+            drawList->AddRect(ToMinimap(node->m_Bounds.Min), ToMinimap(node->m_Bounds.Max), selectionColor);
+        }
+
+        const auto viewMin = ToMinimap(viewRect.Min);
+        const auto viewMax = ToMinimap(viewRect.Max);
+        drawList->AddRectFilled(viewMin, viewMax, Editor->GetColor(StyleColor_MinimapView, 0.15f));
+        drawList->AddRect(viewMin, viewMax, Editor->GetColor(StyleColor_MinimapView));
+
+        drawList->PopClipRect();
+    }
+
+    drawList->AddRect(m_Rect.Min, m_Rect.Max, ImColor(ImGui::GetStyle().Colors[ImGuiCol_Border]));
+}
+
+void ed::Minimap::Rebuild(const vector<ObjectWrapper<Node>>& nodes, const vector<ObjectWrapper<Link>>& links)
+{
+    m_NeedRebuild = false;
+    ++m_RebuildCount;
+
+    ImRect content(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    m_LiveNodeCount = 0;
+    for (auto& node : nodes)
+    {
+        if (!node->m_IsLive)
+            continue;
+
+        content.Add(node->m_Bounds);
+        ++m_LiveNodeCount;
+    }
+    m_RebuildLiveNodeCount = m_LiveNodeCount;
+
+    if (m_LiveNodeCount > 0 && !ImRect_IsEmpty(content))
+    {
+        const auto extent = ImMax(content.GetWidth(), content.GetHeight());
+        content.Expand(extent * c_MinimapContentMargin);
+
+        // Cells are square, grid covers whole content.
+        m_CellSize = ImMax(content.GetWidth(), content.GetHeight()) / c_Resolution;
+        m_Width    = ImMax(1, static_cast<int>(ImCeil(content.GetWidth()  / m_CellSize)));
+        m_Height   = ImMax(1, static_cast<int>(ImCeil(content.GetHeight() / m_CellSize)));
+        m_World    = ImRect(content.Min, content.Min + ImVec2(m_Width * m_CellSize, m_Height * m_CellSize));
+    }
+    else
+    {
+        m_Width  = 0;
+        m_Height = 0;
+        m_World  = ImRect();
+    }
+
+    for (int layer = 0; layer < Layer_Count; ++layer)
+    {
+        m_Cells[layer].assign(m_Width * m_Height, 0);
+        m_Rows[layer].resize(m_Height);
+        for (auto& row : m_Rows[layer])
+            row.resize(0);
+    }
+    m_DirtyRows.assign(m_Height, 1);
+
+    m_ChangedNodes.resize(0);
+    m_ChangedLinks.resize(0);
+
+    m_NodeEntries.resize(nodes.size());
+    for (int i = 0; i < static_cast<int>(nodes.size()); ++i)
+    {
+        auto& entry = m_NodeEntries[i];
+        entry.m_Node      = nodes[i].m_Object;
+        entry.m_IsPlaced  = false;
+        entry.m_IsChanged = false;
+        entry.m_Node->m_MinimapIndex = i;
+        Place(entry);
+    }
+
+    m_LinkEntries.resize(links.size());
+    for (int i = 0; i < static_cast<int>(links.size()); ++i)
+    {
+        auto& entry = m_LinkEntries[i];
+        entry.m_Link      = links[i].m_Object;
+        entry.m_IsChanged = false;
+        entry.m_Cells.resize(0);
+        entry.m_Link->m_MinimapIndex = i;
+        Place(entry);
+    }
+}
+
+bool ed::Minimap::UpdateNodes()
+{
+    for (auto index : m_ChangedNodes)
+    {
+        auto& entry = m_NodeEntries[index];
+        auto  node  = entry.m_Node;
+        entry.m_IsChanged = false;
+
+        if (entry.m_Bounds.Min == node->m_Bounds.Min && entry.m_Bounds.Max == node->m_Bounds.Max &&
+            entry.m_IsGroup == IsGroup(node) && entry.m_IsLive == node->m_IsLive)
+            continue;
+
+        // Content outgrown the grid.
+        if (node->m_IsLive && !m_World.Contains(node->m_Bounds))
+            return false;
+
+        m_LiveNodeCount += (node->m_IsLive ? 1 : 0) - (entry.m_IsLive ? 1 : 0);
+
+        Remove(entry);
+        Place(entry);
+        ++m_ChangeCount;
+    }
+    m_ChangedNodes.resize(0);
+
+    // Most of the content is gone, grid is too coarse for what is left.
+    return m_LiveNodeCount * 2 >= m_RebuildLiveNodeCount;
+}
+
+bool ed::Minimap::UpdateLinks()
+{
+    for (auto index : m_ChangedLinks)
+    {
+        auto& entry = m_LinkEntries[index];
+        auto  link  = entry.m_Link;
+        entry.m_IsChanged = false;
+
+        if (entry.m_IsLive == link->m_IsLive && (!entry.m_IsLive || (entry.m_Start == link->m_Start && entry.m_End == link->m_End)))
+            continue;
+
+        Remove(entry);
+        Place(entry);
+        ++m_ChangeCount;
+    }
+    m_ChangedLinks.resize(0);
+
+    return true;
+}
+
+void ed::Minimap::UpdateRows()
+{
+    for (int y = 0; y < m_Height; ++y)
     {
-        for (auto& node : nodesValue.get<json::object>())
+        if (!m_DirtyRows[y])
+            continue;
+
+        m_DirtyRows[y] = 0;
+
+        for (int layer = 0; layer < Layer_Count; ++layer)
         {
-            auto id = deserializeObjectId(node.first.c_str()).AsNodeId();
+            const auto cells = m_Cells[layer].data() + y * m_Width;
+
+            auto& row = m_Rows[layer][y];
+            row.resize(0);
+            for (int x = 0; x < m_Width; )
+            {
+                if (!cells[x])
+                {
+                    ++x;
+                    continue;
+                }
 
-            auto nodeSettings = result.FindNode(id);
-            if (!nodeSettings)
-                nodeSettings = result.AddNode(id);
+                Run run;
+                run.m_Begin = x;
+                while (x < m_Width && cells[x])
+                    ++x;
+                run.m_End = x;
 
-            NodeSettings::Parse(node.second, *nodeSettings);
+                row.push_back(run);
+            }
         }
     }
+}
 
-    auto& selectionValue = settingsValue["selection"];
-    if (selectionValue.is_array())
+void ed::Minimap::Place(NodeEntry& entry)
+{
+    auto node = entry.m_Node;
+    entry.m_Bounds  = node->m_Bounds;
+    entry.m_IsGroup = IsGroup(node);
+    entry.m_IsLive  = node->m_IsLive;
+
+    if (!entry.m_IsLive || m_Width == 0 || ImRect_IsEmpty(entry.m_Bounds))
+        return;
+
+    entry.m_CellMin[0] = ToCell(entry.m_Bounds.Min.x, m_World.Min.x, m_Width);
+    entry.m_CellMin[1] = ToCell(entry.m_Bounds.Min.y, m_World.Min.y, m_Height);
+    entry.m_CellMax[0] = ToCell(entry.m_Bounds.Max.x, m_World.Min.x, m_Width);
+    entry.m_CellMax[1] = ToCell(entry.m_Bounds.Max.y, m_World.Min.y, m_Height);
+    entry.m_IsPlaced   = true;
+
+    const auto layer = entry.m_IsGroup ? Layer_Groups : Layer_Nodes;
+    for (int y = entry.m_CellMin[1]; y <= entry.m_CellMax[1]; ++y)
+        for (int x = entry.m_CellMin[0]; x <= entry.m_CellMax[0]; ++x)
+            AddToCell(layer, y * m_Width + x, 1);
+}
+
+void ed::Minimap::Remove(NodeEntry& entry)
+{
+    if (!entry.m_IsPlaced)
+        return;
+
+    const auto layer = entry.m_IsGroup ? Layer_Groups : Layer_Nodes;
+    for (int y = entry.m_CellMin[1]; y <= entry.m_CellMax[1]; ++y)
+        for (int x = entry.m_CellMin[0]; x <= entry.m_CellMax[0]; ++x)
+            AddToCell(layer, y * m_Width + x, -1);
+
+    entry.m_IsPlaced = false;
+}
+
+void ed::Minimap::Place(LinkEntry& entry)
+{
+    auto link = entry.m_Link;
+    entry.m_IsLive = link->m_IsLive;
+    entry.m_Start  = link->m_Start;
+    entry.m_End    = link->m_End;
+
+    if (!entry.m_IsLive || m_Width == 0)
+        return;
+
+    // Walk every segment in steps of half a cell, so no cell on the way is skipped.
+    const auto curve = link->GetCurve();
+    auto last = ImVec2(curve.P0.x, curve.P0.y);
+    int  lastCell = -1;
+    for (int i = 1; i <= c_MinimapLinkSegments; ++i)
     {
-        const auto selectionArray = selectionValue.get<json::array>();
+        const auto point  = ImCubicBezier(curve.P0, curve.P1, curve.P2, curve.P3, i / static_cast<float>(c_MinimapLinkSegments));
+        const auto delta  = point - last;
+        const auto steps  = ImMax(1, static_cast<int>(ImMax(ImFabs(delta.x), ImFabs(delta.y)) * 2.0f / m_CellSize));
 
-        result.m_Selection.reserve(selectionArray.size());
-        result.m_Selection.resize(0);
-        for (auto& selection : selectionArray)
+        for (int step = (i == 1 ? 0 : 1); step <= steps; ++step)
         {
-            if (selection.is_string())
-                result.m_Selection.push_back(deserializeObjectId(selection.get<json::string>()));
+            const auto p    = last + delta * (step / static_cast<float>(steps));
+            const auto cell = ToCell(p.y, m_World.Min.y, m_Height) * m_Width + ToCell(p.x, m_World.Min.x, m_Width);
+            if (cell == lastCell)
+                continue;
+
+            entry.m_Cells.push_back(cell);
+            lastCell = cell;
         }
+
+        last = point;
     }
 
-    auto& viewValue = settingsValue["view"];
-    if (viewValue.is_object())
-    {
-        auto& viewScrollValue = viewValue["scroll"];
-        auto& viewZoomValue   = viewValue["zoom"];
+    for (auto cell : entry.m_Cells)
+        AddToCell(Layer_Links, cell, 1);
+}
 
-        if (!tryParseVector(viewScrollValue, result.m_ViewScroll))
-            result.m_ViewScroll = ImVec2(0, 0);
+void ed::Minimap::Remove(LinkEntry& entry)
+{
+    for (auto cell : entry.m_Cells)
+        AddToCell(Layer_Links, cell, -1);
 
-        result.m_ViewZoom = viewZoomValue.is_number() ? static_cast<float>(viewZoomValue.get<double>()) : 1.0f;
+    entry.m_Cells.resize(0);
+}
 
-        if (!viewValue.contains("visible_rect") || !tryParseVector(viewValue["visible_rect"]["min"], result.m_VisibleRect.Min) || !tryParseVector(viewValue["visible_rect"]["max"], result.m_VisibleRect.Max))
-            result.m_VisibleRect = {};
-    }
+void ed::Minimap::AddToCell(int layer, int cell, int delta)
+{
+    auto& count = m_Cells[layer][cell];
 
-    settings = std::move(result);
+    const auto wasEmpty = count == 0;
+    count += delta;
+    if (wasEmpty != (count == 0))
+        m_DirtyRows[cell / m_Width] = 1;
+}
 
-    return true;
+int ed::Minimap::ToCell(float value, float origin, int size) const
+{
+    return ImClamp(static_cast<int>((value - origin) / m_CellSize), 0, size - 1);
+}
+
+ImVec2 ed::Minimap::ToMinimap(const ImVec2& point) const
+{
+    return m_Rect.Min + (point - m_World.Min) * (m_Rect.GetSize() / m_World.GetSize());
 }
 
 
@@ -3037,8 +5262,9 @@ ed::FlowAnimation::FlowAnimation(FlowAnimationController* controller):
     Animation(controller->Editor),
     Controller(controller),
     m_Link(nullptr),
-    m_Offset(0.0f),
-    m_PathLength(0.0f)
+    m_Speed(0.0f),
+    m_MarkerDistance(0.0f),
+    m_Offset(0.0f)
 {
 }
 
@@ -3047,13 +5273,7 @@ void ed::FlowAnimation::Flow(ed::Link* link, float markerDistance, float speed,
     Stop();
 
     if (m_Link != link)
-    {
         m_Offset = 0.0f;
-        ClearPath();
-    }
-
-    if (m_MarkerDistance != markerDistance)
-        ClearPath();
 
     m_MarkerDistance = markerDistance;
     m_Speed          = speed;
@@ -3062,14 +5282,11 @@ void ed::FlowAnimation::Flow(ed::Link* link, float markerDistance, float speed,
     Play(duration);
 }
 
-void ed::FlowAnimation::Draw(ImDrawList* drawList)
+void ed::FlowAnimation::Draw(ImDrawList* drawList, vector<ImVec2>& markers, float& markerRadius, ImU32& markerColor)
 {
     if (!IsPlaying() || !IsLinkValid() || !m_Link->IsVisible())
         return;
 
-    if (!IsPathValid())
-        UpdatePath();
-
     m_Offset = fmodf(m_Offset, m_MarkerDistance);
     if (m_Offset < 0)
         m_Offset += m_MarkerDistance;
@@ -3078,21 +5295,14 @@ void ed::FlowAnimation::Draw(ImDrawList* drawList)
 
     const auto flowAlpha = 1.0f - progress * progress;
     const auto flowColor = Editor->GetColor(StyleColor_Flow, flowAlpha);
-    //const auto flowPath  = Link->GetCurve();
 
     m_Link->Draw(drawList, flowColor, 2.0f);
 
-    if (IsPathValid())
-    {
-        //Offset = 0;
-
-        const auto markerAlpha  = powf(1.0f - progress, 0.35f);
-        const auto markerRadius = 4.0f * (1.0f - progress) + 2.0f;
-        const auto markerColor  = Editor->GetColor(StyleColor_FlowMarker, markerAlpha);
+    const auto markerAlpha = powf(1.0f - progress, 0.35f);
+    markerRadius = 4.0f * (1.0f - progress) + 2.0f;
+    markerColor  = Editor->GetColor(StyleColor_FlowMarker, markerAlpha);
 
-        for (float d = m_Offset; d < m_PathLength; d += m_MarkerDistance)
-            drawList->AddCircleFilled(SamplePath(d), markerRadius, markerColor);
-    }
+    m_Link->GetGeometry().Sample(m_Offset, m_MarkerDistance, markers);
 }
 
 bool ed::FlowAnimation::IsLinkValid() const
@@ -3100,59 +5310,6 @@ bool ed::FlowAnimation::IsLinkValid() const
     return m_Link && m_Link->m_IsLive;
 }
 
-bool ed::FlowAnimation::IsPathValid() const
-{
-    return m_Path.size() > 1 && m_PathLength > 0.0f && m_Link->m_Start == m_LastStart && m_Link->m_End == m_LastEnd;
-}
-
-void ed::FlowAnimation::UpdatePath()
-{
-    if (!IsLinkValid())
-    {
-        ClearPath();
-        return;
-    }
-
-    const auto curve  = m_Link->GetCurve();
-
-    m_LastStart  = m_Link->m_Start;
-    m_LastEnd    = m_Link->m_End;
-    m_PathLength = ImCubicBezierLength(curve.P0, curve.P1, curve.P2, curve.P3);
-
-    auto collectPointsCallback = [this](ImCubicBezierFixedStepSample& result)
-    {
-        m_Path.push_back(CurvePoint{ result.Length, result.Point });
-    };
-
-    const auto step = ImMax(m_MarkerDistance * 0.5f, 15.0f);
-
-    m_Path.resize(0);
-    ImCubicBezierFixedStep(collectPointsCallback, curve, step, false, 0.5f, 0.001f);
-}
-
-void ed::FlowAnimation::ClearPath()
-{
-    vector<CurvePoint>().swap(m_Path);
-    m_PathLength = 0.0f;
-}
-
-ImVec2 ed::FlowAnimation::SamplePath(float distance) const
-{
-    //distance = ImMax(0.0f, std::min(distance, PathLength));
-
-    auto endPointIt = std::find_if(m_Path.begin(), m_Path.end(), [distance](const CurvePoint& p) { return distance < p.Distance; });
-    if (endPointIt == m_Path.end())
-        endPointIt = m_Path.end() - 1;
-    else if (endPointIt == m_Path.begin())
-        endPointIt = m_Path.begin() + 1;
-
-    const auto& start = endPointIt[-1];
-    const auto& end   = *endPointIt;
-    const auto  t     = (distance - start.Distance) / (end.Distance - start.Distance);
-
-    return start.Point + (end.Point - start.Point) * t;
-}
-
 void ed::FlowAnimation::OnUpdate(float progress)
 {
     IM_UNUSED(progress);
@@ -3174,14 +5331,13 @@ void ed::FlowAnimation::OnStop()
 //
 //------------------------------------------------------------------------------
 ed::FlowAnimationController::FlowAnimationController(EditorContext* editor):
-    AnimationController(editor)
+    AnimationController(editor),
+    m_HasStopped(false)
 {
 }
 
 ed::FlowAnimationController::~FlowAnimationController()
 {
-    for (auto animation : m_Animations)
-        delete animation;
 }
 
 void ed::FlowAnimationController::Flow(Link* link, FlowDirection direction)
@@ -3202,42 +5358,181 @@ void ed::FlowAnimationController::Flow(Link* link, FlowDirection direction)
 
 void ed::FlowAnimationController::Draw(ImDrawList* drawList)
 {
+    ReclaimStopped();
+
     if (m_Animations.empty())
         return;
 
     drawList->ChannelsSetCurrent(c_LinkChannel_Flow);
 
+    m_Markers.resize(0);
+    m_MarkerBatches.resize(0);
+
     for (auto animation : m_Animations)
-        animation->Draw(drawList);
+    {
+        MarkerBatch batch;
+        batch.m_First = static_cast<int>(m_Markers.size());
+        animation->Draw(drawList, m_Markers, batch.m_Radius, batch.m_Color);
+        batch.m_Count = static_cast<int>(m_Markers.size()) - batch.m_First;
+
+        if (batch.m_Count > 0)
+            m_MarkerBatches.push_back(batch);
+    }
+
+    DrawMarkers(drawList);
 }
 
-ed::FlowAnimation* ed::FlowAnimationController::GetOrCreate(Link* link)
+// Segment count for circle approximation within given error, same as ImGui uses.
+static int CalcCircleSegmentCount(float radius, float maxError)
+{
+    const auto segments = static_cast<int>(ImCeil(IM_PI / ImAcos(1.0f - ImMin(maxError, radius) / radius)));
+    return ImClamp((segments + 1) & ~1, 4, 512);
+}
+
+void ed::FlowAnimationController::DrawMarkers(ImDrawList* drawList)
 {
-    // Return live animation which match target link
+    if (m_MarkerBatches.empty())
+        return;
+
+    // Markers of all flows are emitted as filled circles directly into
+    // vertex buffer, instead of building a path for every single one.
+    const auto antiAliased = (drawList->Flags & ImDrawListFlags_AntiAliasedFill) != 0;
+    const auto fringe      = ImFringeScaleRef(drawList);
+    const auto uv          = ImGui::GetFontTexUvWhitePixel();
+
+    for (auto& batch : m_MarkerBatches)
     {
-        auto animationIt = std::find_if(m_Animations.begin(), m_Animations.end(), [link](FlowAnimation* animation) { return animation->m_Link == link; });
-        if (animationIt != m_Animations.end())
-            return *animationIt;
+        const auto segments = CalcCircleSegmentCount(batch.m_Radius, ImGui::GetStyle().CircleTessellationMaxError * fringe);
+
+        m_CircleDirections.resize(segments);
+        for (int i = 0; i < segments; ++i)
+        {
+            const auto a = (IM_PI * 2.0f * i) / segments;
+            m_CircleDirections[i] = ImVec2(ImCos(a), ImSin(a));
+        }
+
+        const auto vertexCount = antiAliased ? segments * 2 : segments;
+        const auto indexCount  = antiAliased ? (segments - 2) * 3 + segments * 6 : (segments - 2) * 3;
+        const auto perReserve  = ImMax(1, c_FlowMarkerBatchVertices / vertexCount);
+
+        const auto innerRadius = antiAliased ? batch.m_Radius - fringe * 0.5f : batch.m_Radius;
+        const auto outerRadius = batch.m_Radius + fringe * 0.5f;
+        const auto innerColor  = batch.m_Color;
+        const auto outerColor  = batch.m_Color & ~IM_COL32_A_MASK;
+
+        for (int first = 0; first < batch.m_Count; first += perReserve)
+        {
+            const auto count = ImMin(perReserve, batch.m_Count - first);
+            drawList->PrimReserve(count * indexCount, count * vertexCount);
+
+            for (int m = 0; m < count; ++m)
+            {
+                const auto center = m_Markers[batch.m_First + first + m];
+                const auto base   = static_cast<ImDrawIdx>(drawList->_VtxCurrentIdx);
+                const auto stride = antiAliased ? 2 : 1;
+
+                for (auto& direction : m_CircleDirections)
+                {
+                    drawList->PrimWriteVtx(center + direction * innerRadius, uv, innerColor);
+                    if (antiAliased)
+                        drawList->PrimWriteVtx(center + direction * outerRadius, uv, outerColor);
+                }
+
+                for (int i = 2; i < segments; ++i)
+                {
+                    drawList->PrimWriteIdx(base);
+                    drawList->PrimWriteIdx(static_cast<ImDrawIdx>(base + (i - 1) * stride));
+                    drawList->PrimWriteIdx(static_cast<ImDrawIdx>(base + i * stride));
+                }
+
+                if (!antiAliased)
+                    continue;
+
+                for (int i = 0; i < segments; ++i)
+                {
+                    const auto j      = (i + 1) % segments;
+                    const auto innerI = static_cast<ImDrawIdx>(base + i * 2);
+                    const auto innerJ = static_cast<ImDrawIdx>(base + j * 2);
+                    drawList->PrimWriteIdx(innerI);
+                    drawList->PrimWriteIdx(innerJ);
+                    drawList->PrimWriteIdx(static_cast<ImDrawIdx>(innerJ + 1));
+                    drawList->PrimWriteIdx(static_cast<ImDrawIdx>(innerJ + 1));
+                    drawList->PrimWriteIdx(static_cast<ImDrawIdx>(innerI + 1));
+                    drawList->PrimWriteIdx(innerI);
+                }
+            }
+        }
     }
+}
 
-    // There are no live animations for target link, try to reuse inactive old one
+ed::FlowAnimation* ed::FlowAnimationController::GetOrCreate(Link* link)
+{
+    // Return animation which match target link
+    auto animationIt = m_LinkAnimations.find(link);
+    if (animationIt != m_LinkAnimations.end())
+        return animationIt->second;
+
+    // There are no animations for target link, try to reuse stopped one
+    FlowAnimation* animation = nullptr;
     if (!m_FreePool.empty())
     {
-        auto animation = m_FreePool.back();
+        animation = m_FreePool.back();
         m_FreePool.pop_back();
-        return animation;
+    }
+    else
+    {
+        m_Pool.emplace_back(this);
+        animation = &m_Pool.back();
     }
 
-    // Cache miss, allocate new one
-    auto animation = new FlowAnimation(this);
     m_Animations.push_back(animation);
+    m_LinkAnimations[link] = animation;
 
     return animation;
 }
 
 void ed::FlowAnimationController::Release(FlowAnimation* animation)
 {
+    // Animation may be restarted right away by Flow(), so it is returned to
+    // the pool on next Draw() if it is still stopped.
     IM_UNUSED(animation);
+    m_HasStopped = true;
+}
+
+void ed::FlowAnimationController::Forget(Link* link)
+{
+    auto animationIt = m_LinkAnimations.find(link);
+    if (animationIt == m_LinkAnimations.end())
+        return;
+
+    auto animation = animationIt->second;
+    m_LinkAnimations.erase(animationIt);
+
+    animation->m_Link = nullptr;
+    animation->Stop();
+
+    // Stop() does nothing for animation which already finished.
+    m_HasStopped = true;
+}
+
+void ed::FlowAnimationController::ReclaimStopped()
+{
+    if (!m_HasStopped)
+        return;
+
+    auto it = std::remove_if(m_Animations.begin(), m_Animations.end(), [this](FlowAnimation* animation)
+    {
+        if (animation->IsPlaying() && animation->IsLinkValid())
+            return false;
+
+        animation->Stop();
+        if (animation->m_Link)
+            m_LinkAnimations.erase(animation->m_Link);
+        m_FreePool.push_back(animation);
+        return true;
+    });
+    m_Animations.erase(it, m_Animations.end());
+    m_HasStopped = false;
 }
 
 
@@ -3769,6 +6064,8 @@ bool ed::SizeAction::Process(const Control& control)
         m_SizedNode->m_GroupBounds.Min.y -= m_StartBounds.Min.y - m_StartGroupBounds.Min.y;
         m_SizedNode->m_GroupBounds.Max.x -= m_StartBounds.Max.x - m_StartGroupBounds.Max.x;
         m_SizedNode->m_GroupBounds.Max.y -= m_StartBounds.Max.y - m_StartGroupBounds.Max.y;
+
+        Editor->NotifyNodeChanged(m_SizedNode);
     }
     else if (!control.ActiveNode)
     {
@@ -5150,7 +7447,12 @@ ed::Object* ed::DeleteItemsAction::DropCurrentItem()
 ed::NodeBuilder::NodeBuilder(EditorContext* editor):
     Editor(editor),
     m_CurrentNode(nullptr),
-    m_CurrentPin(nullptr)
+    m_CurrentPin(nullptr),
+    m_CacheNode(nullptr),
+    m_CacheHash(0),
+    m_IsCapturing(false),
+    m_CaptureCommandStart(0),
+    m_CaptureVertexStart(0)
 {
 }
 
@@ -5204,29 +7506,35 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
 
     auto& editorStyle = Editor->GetStyle();
 
-    const auto alpha = ImGui::GetStyle().Alpha;
-
-    m_CurrentNode->m_IsLive           = true;
-    m_CurrentNode->m_LastPin          = nullptr;
-    m_CurrentNode->m_Color            = Editor->GetColor(StyleColor_NodeBg, alpha);
-    m_CurrentNode->m_BorderColor      = Editor->GetColor(StyleColor_NodeBorder, alpha);
-    m_CurrentNode->m_BorderWidth      = editorStyle.NodeBorderWidth;
-    m_CurrentNode->m_Rounding         = editorStyle.NodeRounding;
-    m_CurrentNode->m_GroupColor       = Editor->GetColor(StyleColor_GroupBg, alpha);
-    m_CurrentNode->m_GroupBorderColor = Editor->GetColor(StyleColor_GroupBorder, alpha);
-    m_CurrentNode->m_GroupBorderWidth = editorStyle.GroupBorderWidth;
-    m_CurrentNode->m_GroupRounding    = editorStyle.GroupRounding;
-    m_CurrentNode->m_HighlightConnectedLinks = editorStyle.HighlightConnectedLinks != 0.0f;
+    m_CurrentNode->m_LastPin = nullptr;
+    ApplyNodeStyle(m_CurrentNode);
 
     m_IsGroup = false;
 
+    // Content is recorded only if Replay() was requested for this node and failed.
+    const bool capture = m_CacheNode == m_CurrentNode && !::IsGroup(m_CurrentNode) && Editor->GetLodLevel() != LodLevel::Summary;
+    m_CacheNode   = nullptr;
+    m_IsCapturing = false;
+    m_CurrentNode->m_DrawCache.Clear();
+
     // Grow channel list and select user channel
     if (auto drawList = Editor->GetDrawList())
     {
-        m_CurrentNode->m_Channel = drawList->_Splitter._Count;
-        ImDrawList_ChannelsGrow(drawList, drawList->_Splitter._Count + c_ChannelsPerNode);
+        m_CurrentNode->m_Channel = Editor->AllocateNodeChannels(m_CurrentNode);
         drawList->ChannelsSetCurrent(m_CurrentNode->m_Channel + c_NodeContentChannel);
 
+        if (capture)
+        {
+            // Layered channels are shared, start with fresh command so
+            // content of other nodes is not recorded.
+            if (!drawList->CmdBuffer.empty() && drawList->CmdBuffer.back().ElemCount > 0)
+                drawList->AddDrawCmd();
+
+            m_IsCapturing         = true;
+            m_CaptureCommandStart = drawList->CmdBuffer.Size - 1;
+            m_CaptureVertexStart  = drawList->VtxBuffer.Size;
+        }
+
         m_Splitter.Clear();
         ImDrawList_SwapSplitter(drawList, m_Splitter);
     }
@@ -5250,6 +7558,19 @@ void ed::NodeBuilder::End()
     {
         IM_ASSERT(drawList->_Splitter._Count == 1); // Did you forgot to call drawList->ChannelsMerge()?
         ImDrawList_SwapSplitter(drawList, m_Splitter);
+
+        // User content is not drawn at summary level, drop it.
+        if (Editor->GetLodLevel() == LodLevel::Summary)
+        {
+            drawList->ChannelsSetCurrent(m_CurrentNode->m_Channel + c_NodeBaseChannel);
+
+            for (auto channel : { c_NodeUserBackgroundChannel, c_NodePinChannel, c_NodeContentChannel })
+            {
+                auto& drawChannel = drawList->_Splitter._Channels[m_CurrentNode->m_Channel + channel];
+                drawChannel._CmdBuffer.resize(0);
+                drawChannel._IdxBuffer.resize(0);
+            }
+        }
     }
 
     // Apply frame padding. This must be done in this convoluted way if outer group
@@ -5277,6 +7598,9 @@ void ed::NodeBuilder::End()
         Editor->MakeDirty(SaveReasonFlags::Size, m_CurrentNode);
     }
 
+    const auto type        = m_CurrentNode->m_Type;
+    const auto groupBounds = m_CurrentNode->m_GroupBounds;
+
     if (m_IsGroup)
     {
         // Groups cannot have pins. Discard them.
@@ -5290,9 +7614,238 @@ void ed::NodeBuilder::End()
     else
         m_CurrentNode->m_Type        = NodeType::Node;
 
+    if (m_CurrentNode->m_Type != type || m_CurrentNode->m_GroupBounds.Min != groupBounds.Min || m_CurrentNode->m_GroupBounds.Max != groupBounds.Max)
+        Editor->NotifyNodeChanged(m_CurrentNode);
+
+    if (m_IsCapturing && !m_IsGroup)
+    {
+        if (auto drawList = Editor->GetDrawList())
+            CaptureCache(drawList);
+    }
+
+    m_IsCapturing = false;
     m_CurrentNode = nullptr;
 }
 
+bool ed::NodeBuilder::Replay(NodeId nodeId, uint64_t contentHash)
+{
+    IM_ASSERT(nullptr == m_CurrentNode);
+
+    m_CacheNode = nullptr;
+
+    auto node     = Editor->FindNode(nodeId);
+    auto drawList = Editor->GetDrawList();
+    if (!node || !drawList || node->m_IsLive)
+        return false;
+
+    // Remember request, node content will be recorded by following Begin()/End().
+    m_CacheNode = node;
+    m_CacheHash = contentHash;
+
+    auto& cache = node->m_DrawCache;
+    if (!cache.m_IsValid || cache.m_Hash != contentHash)
+        return false;
+
+    if (::IsGroup(node) || node->m_RestoreState || node->m_CenterOnScreen)
+        return false;
+
+    if (Editor->GetLodLevel() == LodLevel::Summary)
+        return false;
+
+    // Hover and selection are commonly reflected in node content.
+    if (Editor->GetHoveredNode() == nodeId || cache.m_IsSelected != node->m_IsSelected)
+        return false;
+
+    // Hovered node is known only after the frame, node under the mouse needs
+    // live widgets already, otherwise first click on it would be lost.
+    if (node->m_Bounds.Contains(ImGui::GetMousePos()))
+        return false;
+
+    if (cache.m_Size != node->m_Bounds.GetSize() || cache.m_ZoomBucket != CalcZoomBucket(Editor->GetView().Scale))
+        return false;
+
+    // Font atlas was rebuilt, texture coordinates are no longer valid.
+    if (cache.m_WhitePixelUV != ImGui::GetFontTexUvWhitePixel())
+        return false;
+
+    const bool useVertexOffset = (drawList->Flags & ImDrawListFlags_AllowVtxOffset) != 0;
+    if (!useVertexOffset && sizeof(ImDrawIdx) == 2)
+    {
+        const auto vertexCount = drawList->VtxBuffer.Size - static_cast<int>(drawList->_CmdHeader.VtxOffset) + static_cast<int>(cache.m_Vertices.size());
+        if (vertexCount > 0xFFFF)
+            return false;
+    }
+
+    for (auto& pinState : cache.m_Pins)
+    {
+        if (!Editor->FindPin(pinState.m_ID))
+            return false;
+    }
+
+    m_CacheNode = nullptr;
+
+    node->m_LastPin = nullptr;
+    ApplyNodeStyle(node);
+
+    const auto origin = node->m_Bounds.Min;
+
+    node->m_Channel = Editor->AllocateNodeChannels(node);
+    drawList->ChannelsSetCurrent(node->m_Channel + c_NodeContentChannel);
+
+    if (!drawList->CmdBuffer.empty() && drawList->CmdBuffer.back().ElemCount == 0 && drawList->CmdBuffer.back().UserCallback == nullptr)
+        drawList->CmdBuffer.pop_back();
+
+    for (auto& cached : cache.m_Commands)
+    {
+        auto command = cached.m_Command;
+        command.ClipRect.x += origin.x;
+        command.ClipRect.y += origin.y;
+        command.ClipRect.z += origin.x;
+        command.ClipRect.w += origin.y;
+        command.IdxOffset   = static_cast<unsigned int>(drawList->IdxBuffer.Size);
+
+        ImDrawIdx indexBias = 0;
+        if (useVertexOffset)
+            command.VtxOffset = static_cast<unsigned int>(drawList->VtxBuffer.Size);
+        else
+        {
+            command.VtxOffset = drawList->_CmdHeader.VtxOffset;
+            indexBias = static_cast<ImDrawIdx>(drawList->VtxBuffer.Size - drawList->_CmdHeader.VtxOffset);
+        }
+
+        auto vertex = cache.m_Vertices.data() + cached.m_FirstVertex;
+        for (int i = 0; i < cached.m_VertexCount; ++i, ++vertex)
+        {
+            drawList->VtxBuffer.push_back(*vertex);
+            drawList->VtxBuffer.back().pos += origin;
+        }
+
+        auto index = cache.m_Indices.data() + cached.m_FirstIndex;
+        for (int i = 0; i < cached.m_IndexCount; ++i, ++index)
+            drawList->IdxBuffer.push_back(static_cast<ImDrawIdx>(*index + indexBias));
+
+        drawList->CmdBuffer.push_back(command);
+    }
+
+    drawList->_VtxCurrentIdx = static_cast<unsigned int>(drawList->VtxBuffer.Size) - drawList->_CmdHeader.VtxOffset;
+    drawList->_VtxWritePtr   = drawList->VtxBuffer.Data + drawList->VtxBuffer.Size;
+    drawList->_IdxWritePtr   = drawList->IdxBuffer.Data + drawList->IdxBuffer.Size;
+    drawList->AddDrawCmd();
+
+    for (auto& pinState : cache.m_Pins)
+    {
+        auto pin = Editor->FindPin(pinState.m_ID);
+
+        pin->m_IsLive      = true;
+        pin->m_Node        = node;
+        pin->m_Bounds      = ImRect(pinState.m_Bounds.Min + origin, pinState.m_Bounds.Max + origin);
+        pin->m_Pivot       = ImRect(pinState.m_Pivot.Min  + origin, pinState.m_Pivot.Max  + origin);
+        pin->m_PreviousPin = node->m_LastPin;
+        node->m_LastPin    = pin;
+    }
+
+    return true;
+}
+
+void ed::NodeBuilder::ApplyNodeStyle(Node* node)
+{
+    auto& editorStyle = Editor->GetStyle();
+
+    const auto alpha = ImGui::GetStyle().Alpha;
+
+    Editor->MarkNodeLive(node);
+    node->m_Color            = Editor->GetColor(StyleColor_NodeBg, alpha);
+    node->m_BorderColor      = Editor->GetColor(StyleColor_NodeBorder, alpha);
+    node->m_BorderWidth      = editorStyle.NodeBorderWidth;
+    node->m_Rounding         = editorStyle.NodeRounding;
+    node->m_GroupColor       = Editor->GetColor(StyleColor_GroupBg, alpha);
+    node->m_GroupBorderColor = Editor->GetColor(StyleColor_GroupBorder, alpha);
+    node->m_GroupBorderWidth = editorStyle.GroupBorderWidth;
+    node->m_GroupRounding    = editorStyle.GroupRounding;
+    node->m_HighlightConnectedLinks = editorStyle.HighlightConnectedLinks != 0.0f;
+}
+
+void ed::NodeBuilder::CaptureCache(ImDrawList* drawList)
+{
+    auto  node  = m_CurrentNode;
+    auto& cache = node->m_DrawCache;
+
+    cache.Clear();
+
+    // Hovered content may differ from the one drawn next frame.
+    if (Editor->GetHoveredNode() == node->m_ID)
+        return;
+
+    const auto origin    = node->m_Bounds.Min;
+    const int  vertexEnd = drawList->VtxBuffer.Size;
+
+    for (int i = m_CaptureCommandStart; i < drawList->CmdBuffer.Size; ++i)
+    {
+        auto& command = drawList->CmdBuffer[i];
+        if (command.UserCallback)
+            return; // callbacks cannot be replayed
+        if (command.ElemCount == 0)
+            continue;
+
+        auto indices  = drawList->IdxBuffer.Data + command.IdxOffset;
+        auto minIndex = static_cast<unsigned int>(indices[0]);
+        auto maxIndex = minIndex;
+        for (unsigned int j = 1; j < command.ElemCount; ++j)
+        {
+            minIndex = ImMin(minIndex, static_cast<unsigned int>(indices[j]));
+            maxIndex = ImMax(maxIndex, static_cast<unsigned int>(indices[j]));
+        }
+
+        const int firstVertex = static_cast<int>(command.VtxOffset + minIndex);
+        const int lastVertex  = static_cast<int>(command.VtxOffset + maxIndex);
+        if (firstVertex < m_CaptureVertexStart || lastVertex >= vertexEnd)
+        {
+            cache.Clear();
+            return;
+        }
+
+        NodeDrawCache::Command cached;
+        cached.m_Command     = command;
+        cached.m_Command.ClipRect.x -= origin.x;
+        cached.m_Command.ClipRect.y -= origin.y;
+        cached.m_Command.ClipRect.z -= origin.x;
+        cached.m_Command.ClipRect.w -= origin.y;
+        cached.m_FirstVertex = static_cast<int>(cache.m_Vertices.size());
+        cached.m_VertexCount = lastVertex - firstVertex + 1;
+        cached.m_FirstIndex  = static_cast<int>(cache.m_Indices.size());
+        cached.m_IndexCount  = static_cast<int>(command.ElemCount);
+
+        for (int j = firstVertex; j <= lastVertex; ++j)
+        {
+            cache.m_Vertices.push_back(drawList->VtxBuffer[j]);
+            cache.m_Vertices.back().pos -= origin;
+        }
+
+        for (unsigned int j = 0; j < command.ElemCount; ++j)
+            cache.m_Indices.push_back(static_cast<ImDrawIdx>(indices[j] - minIndex));
+
+        cache.m_Commands.push_back(cached);
+    }
+
+    // Pins are stored in submission order.
+    for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
+    {
+        NodeDrawCache::PinState pinState;
+        pinState.m_ID     = pin->m_ID;
+        pinState.m_Bounds = ImRect(pin->m_Bounds.Min - origin, pin->m_Bounds.Max - origin);
+        pinState.m_Pivot  = ImRect(pin->m_Pivot.Min  - origin, pin->m_Pivot.Max  - origin);
+        cache.m_Pins.push_back(pinState);
+    }
+    std::reverse(cache.m_Pins.begin(), cache.m_Pins.end());
+
+    cache.m_IsValid      = true;
+    cache.m_Hash         = m_CacheHash;
+    cache.m_Size         = node->m_Bounds.GetSize();
+    cache.m_ZoomBucket   = CalcZoomBucket(Editor->GetView().Scale);
+    cache.m_IsSelected   = node->m_IsSelected;
+    cache.m_WhitePixelUV = ImGui::GetFontTexUvWhitePixel();
+}
+
 void ed::NodeBuilder::BeginPin(PinId pinId, PinKind kind)
 {
     IM_ASSERT(nullptr != m_CurrentNode);
@@ -5437,7 +7990,7 @@ ImDrawList* ed::NodeBuilder::GetUserBackgroundDrawList() const
 
 ImDrawList* ed::NodeBuilder::GetUserBackgroundDrawList(Node* node) const
 {
-    if (node && node->m_IsLive)
+    if (node && node->m_IsLive && !node->m_IsCulled)
     {
         auto drawList = Editor->GetDrawList();
         drawList->ChannelsSetCurrent(node->m_Channel + c_NodeUserBackgroundChannel);
@@ -5657,6 +8210,11 @@ const char* ed::Style::GetColorName(StyleColor colorIndex) const
         case StyleColor_FlowMarker: return "FlowMarker";
         case StyleColor_GroupBg: return "GroupBg";
         case StyleColor_GroupBorder: return "GroupBorder";
+        case StyleColor_MinimapBg: return "MinimapBg";
+        case StyleColor_MinimapNode: return "MinimapNode";
+        case StyleColor_MinimapGroup: return "MinimapGroup";
+        case StyleColor_MinimapLink: return "MinimapLink";
+        case StyleColor_MinimapView: return "MinimapView";
         case StyleColor_Count: break;
     }
 
@@ -5689,6 +8247,8 @@ float* ed::Style::GetVarFloatAddr(StyleVar idx)
         case StyleVar_SnapLinkToPinDir:         return &SnapLinkToPinDir;
         case StyleVar_HoveredNodeBorderOffset:  return &HoverNodeBorderOffset;
         case StyleVar_SelectedNodeBorderOffset: return &SelectedNodeBorderOffset;
+        case StyleVar_LodSimplifiedZoom:        return &LodSimplifiedZoom;
+        case StyleVar_LodSummaryZoom:           return &LodSummaryZoom;
         default:                                return nullptr;
     }
 }
@@ -5744,7 +8304,7 @@ std::string ed::Config::Load()
     }
     else if (SettingsFile)
     {
-        std::ifstream file(SettingsFile);
+        std::ifstream file(SettingsFile, std::ios::binary);
         if (file)
         {
             file.seekg(0, std::ios_base::end);
@@ -5782,19 +8342,32 @@ void ed::Config::BeginSave()
         BeginSaveSession(UserPointer);
 }
 
-bool ed::Config::Save(const std::string& data, SaveReasonFlags flags)
+bool ed::Config::Save(Settings& settings, SaveReasonFlags flags)
 {
     if (SaveSettings)
     {
+        // Callback takes the whole document at once.
+        auto data = settings.Serialize(SettingsFormat);
         return SaveSettings(data.c_str(), data.size(), flags, UserPointer);
     }
     else if (SettingsFile)
     {
-        std::ofstream settingsFile(SettingsFile);
-        if (settingsFile)
-            settingsFile << data;
+        struct StreamSink final: json::sink
+        {
+            std::ostream& m_Stream;
+
+            StreamSink(std::ostream& stream): m_Stream(stream) {}
+
+            bool write(const char* data, size_t size) override { return !!m_Stream.write(data, static_cast<std::streamsize>(size)); }
+        };
+
+        // Document is written while it is serialized, it is never held in memory as a whole.
+        std::ofstream settingsFile(SettingsFile, std::ios::binary);
+        if (!settingsFile)
+            return false;
 
-        return !!settingsFile;
+        StreamSink sink(settingsFile);
+        return settings.Serialize(sink, SettingsFormat) && !!settingsFile.flush();
     }
 
     return false;
@@ -62,6 +62,28 @@ enum class CanvasSizeMode
     CenterOnly,             // Previous view will be centered on new view
 };
 
+enum class SettingsFormat
+{
+    Json,                   // Human readable, compatible with older versions
+    Binary,                 // Compact, several times smaller and faster to write for large graphs
+    Cbor,                   // Same document as Json in standard binary encoding (RFC 8949), readable by generic tools
+};
+
+enum class LodLevel
+{
+    Full,                   // Everything is drawn
+    Simplified,             // Links are drawn with few segments and without arrows, pins are not highlighted
+    Summary,                // Nodes are drawn as filled rectangles without user content, links as straight lines
+};
+
+enum class MinimapLocation
+{
+    TopLeft,
+    TopRight,
+    BottomLeft,
+    BottomRight,
+};
+
 
 //------------------------------------------------------------------------------
 enum class SaveReasonFlags: uint32_t
@@ -87,17 +109,22 @@ using ConfigLoadNodeSettings = size_t (*)(NodeId nodeId, char* data, void* userP
 
 using ConfigSession          = void   (*)(void* userPointer);
 
+using ConfigDrawNodeSummary  = void   (*)(NodeId nodeId, ImDrawList* drawList, const ImVec2& min, const ImVec2& max, void* userPointer);
+
 struct Config
 {
     using CanvasSizeModeAlias = ax::NodeEditor::CanvasSizeMode;
+    using SettingsFormatAlias = ax::NodeEditor::SettingsFormat;
 
     const char*             SettingsFile;
+    SettingsFormatAlias     SettingsFormat;         // Encoding of data passed to SaveSettings/SaveNodeSettings, loading detects format
     ConfigSession           BeginSaveSession;
     ConfigSession           EndSaveSession;
     ConfigSaveSettings      SaveSettings;
     ConfigLoadSettings      LoadSettings;
     ConfigSaveNodeSettings  SaveNodeSettings;
     ConfigLoadNodeSettings  LoadNodeSettings;
+    ConfigDrawNodeSummary   DrawNodeSummary;        // Replaces filled rectangle drawn for a node at LodLevel::Summary
     void*                   UserPointer;
     ImVector<float>         CustomZoomLevels;
     CanvasSizeModeAlias     CanvasSizeMode;
@@ -107,15 +134,19 @@ struct Config
     int                     ContextMenuButtonIndex; // Mouse button index context menu action will react to (0-left, 1-right, 2-middle)
     bool                    EnableSmoothZoom;
     float                   SmoothZoomPower;
+    bool                    EnableLayeredChannels;  // Nodes with same z position share draw channels, selected and hovered nodes keep own ones
+    bool                    EnableAsyncSave;        // Settings are serialized and saved on background thread, save callbacks must be thread safe
 
     Config()
         : SettingsFile("NodeEditor.json")
+        , SettingsFormat(SettingsFormatAlias::Json)
         , BeginSaveSession(nullptr)
         , EndSaveSession(nullptr)
         , SaveSettings(nullptr)
         , LoadSettings(nullptr)
         , SaveNodeSettings(nullptr)
         , LoadNodeSettings(nullptr)
+        , DrawNodeSummary(nullptr)
         , UserPointer(nullptr)
         , CustomZoomLevels()
         , CanvasSizeMode(CanvasSizeModeAlias::FitVerticalView)
@@ -129,11 +160,71 @@ struct Config
 # else
         , SmoothZoomPower(1.3f)
 # endif
+        , EnableLayeredChannels(false)
+        , EnableAsyncSave(false)
     {
     }
 };
 
 
+//------------------------------------------------------------------------------
+struct ArrangeConfig
+{
+    float   LayerSpacing;       // Horizontal gap between layers, links flow from left to right
+    float   NodeSpacing;        // Vertical gap between nodes in one layer
+    int     CrossingIterations; // Number of barycentric sweeps reducing link crossings
+    int     AlignIterations;    // Number of sweeps pulling nodes toward connected neighbours
+    bool    NavigateToContent;  // Navigate view to arranged nodes when done
+    float   NavigateDuration;   // Duration of navigation animation, -1 for default
+
+    ArrangeConfig()
+        : LayerSpacing(64.0f)
+        , NodeSpacing(24.0f)
+        , CrossingIterations(8)
+        , AlignIterations(4)
+        , NavigateToContent(true)
+        , NavigateDuration(-1.0f)
+    {
+    }
+};
+
+
+//------------------------------------------------------------------------------
+enum class ProfilerPhase
+{
+    Begin,                  // Begin()
+    Submission,             // Between Begin() and End(), nodes and links submitted by user
+    BuildControl,           // Hit testing and input state
+    DrawNodes,
+    DrawLinks,
+    Highlight,              // Selected, highlighted and hovered objects
+    Animations,
+    Actions,                // Processing and accepting actions, node ordering
+    ChannelMerge,           // Reordering and merging draw channels, canvas transform
+    Minimap,                // Updating minimap cache and drawing it
+    SaveSettings,
+
+    Count
+};
+
+struct ProfilerPhaseStats
+{
+    float   Last;           // Milliseconds spent in last frame
+    float   Min;            // Minimum over history
+    float   Average;        // Average over history
+    float   P99;            // 99th percentile over history
+};
+
+struct ProfilerStats
+{
+    ProfilerPhaseStats  Phases[static_cast<int>(ProfilerPhase::Count)];
+    int                 FrameCount;     // Number of frames in history
+    int                 VertexCount;    // Vertices emitted by editor in last frame
+    int                 IndexCount;     // Indices emitted by editor in last frame
+    int                 ChannelCount;   // Draw channels merged in last frame
+};
+
+
 //------------------------------------------------------------------------------
 enum StyleColor
 {
@@ -156,6 +247,11 @@ enum StyleColor
     StyleColor_FlowMarker,
     StyleColor_GroupBg,
     StyleColor_GroupBorder,
+    StyleColor_MinimapBg,
+    StyleColor_MinimapNode,
+    StyleColor_MinimapGroup,
+    StyleColor_MinimapLink,
+    StyleColor_MinimapView,
 
     StyleColor_Count
 };
@@ -189,6 +285,8 @@ enum StyleVar
     StyleVar_SnapLinkToPinDir,
     StyleVar_HoveredNodeBorderOffset,
     StyleVar_SelectedNodeBorderOffset,
+    StyleVar_LodSimplifiedZoom,
+    StyleVar_LodSummaryZoom,
 
     StyleVar_Count
 };
@@ -222,6 +320,8 @@ struct Style
     float   GroupBorderWidth;
     float   HighlightConnectedLinks;
     float   SnapLinkToPinDir; // when true link will start on the line defined by pin direction
+    float   LodSimplifiedZoom; // GetCurrentZoom() at which LodLevel::Simplified kicks in, 0 to disable
+    float   LodSummaryZoom;    // GetCurrentZoom() at which LodLevel::Summary kicks in, 0 to disable
     ImVec4  Colors[StyleColor_Count];
 
     Style()
@@ -253,6 +353,8 @@ struct Style
         GroupBorderWidth         = 1.0f;
         HighlightConnectedLinks  = 0.0f;
         SnapLinkToPinDir         = 0.0f;
+        LodSimplifiedZoom        = 0.0f;
+        LodSummaryZoom           = 0.0f;
 
         Colors[StyleColor_Bg]                 = ImColor( 60,  60,  70, 200);
         Colors[StyleColor_Grid]               = ImColor(120, 120, 120,  40);
@@ -273,6 +375,11 @@ struct Style
         Colors[StyleColor_FlowMarker]         = ImColor(255, 128,  64, 255);
         Colors[StyleColor_GroupBg]            = ImColor(  0,   0,   0, 160);
         Colors[StyleColor_GroupBorder]        = ImColor(255, 255, 255,  32);
+        Colors[StyleColor_MinimapBg]          = ImColor( 20,  20,  24, 200);
+        Colors[StyleColor_MinimapNode]        = ImColor(200, 200, 200, 200);
+        Colors[StyleColor_MinimapGroup]       = ImColor(200, 200, 200,  48);
+        Colors[StyleColor_MinimapLink]        = ImColor(120, 120, 140, 160);
+        Colors[StyleColor_MinimapView]        = ImColor(255, 255, 255, 160);
     }
 };
 
@@ -313,6 +420,24 @@ IMGUI_NODE_EDITOR_API void EndPin();
 IMGUI_NODE_EDITOR_API void Group(const ImVec2& size);
 IMGUI_NODE_EDITOR_API void EndNode();
 
+// Retained node content. Replays draw commands recorded for node last time it was
+// submitted, when 'contentHash', node size and zoom did not change, node is not
+// hovered nor under the mouse and its selection did not change. Returns false if
+// node has to be submitted, in which case following BeginNode()/EndNode() records
+// it again.
+//
+// Only content submitted between BeginNode() and EndNode() is recorded. Drawing done
+// through GetNodeBackgroundDrawList() is not part of the cache and has to be submitted
+// every frame, also for replayed nodes. Pin and node frames are drawn by the editor.
+//
+//   if (!ed::ReplayNode(id, hash))
+//   {
+//       ed::BeginNode(id);
+//       ...
+//       ed::EndNode();
+//   }
+IMGUI_NODE_EDITOR_API bool ReplayNode(NodeId nodeId, uint64_t contentHash);
+
 IMGUI_NODE_EDITOR_API bool BeginGroupHint(NodeId nodeId);
 IMGUI_NODE_EDITOR_API ImVec2 GetGroupMin();
 IMGUI_NODE_EDITOR_API ImVec2 GetGroupMax();
@@ -355,6 +480,29 @@ IMGUI_NODE_EDITOR_API float GetNodeZPosition(NodeId nodeId); // Returns node z p
 
 IMGUI_NODE_EDITOR_API void RestoreNodeState(NodeId nodeId);
 
+// Layered (Sugiyama style) layout along links. Arranges given nodes in given order,
+// or all nodes submitted in this or previous frame when 'nodes' is nullptr, and moves
+// them with SetNodePosition(). Groups are not moved. Node sizes from last frame are
+// used, nodes never drawn are treated as points.
+IMGUI_NODE_EDITOR_API void ArrangeNodes(const ArrangeConfig& config = ArrangeConfig(), const NodeId* nodes = nullptr, int nodeCount = 0);
+
+// Viewport culling for large graphs. Must be called between Begin() and End().
+//
+// Visibility is tested against node bounds from last frame and view rect expanded
+// by 'margin' (in screen pixels). Nodes which never were submitted are always
+// reported as visible.
+//
+// Typical use:
+//   if (ed::IsNodeInView(id, 64.0f) || !ed::SkipNode(id))
+//   {
+//       ed::BeginNode(id);
+//       ...
+//       ed::EndNode();
+//   }
+IMGUI_NODE_EDITOR_API bool IsNodeInView(NodeId nodeId, float margin = 0.0f);
+IMGUI_NODE_EDITOR_API int  GetNodesInView(NodeId* nodes, int size, float margin = 0.0f); // Fills an array with id's of visible nodes; up to 'size` elements are set. Pass nullptr to query count.
+IMGUI_NODE_EDITOR_API bool SkipNode(NodeId nodeId); // Keeps node alive without submitting it (layout, pins, links, selection and settings are preserved). Returns false if node has to be submitted.
+
 IMGUI_NODE_EDITOR_API void Suspend();
 IMGUI_NODE_EDITOR_API void Resume();
 IMGUI_NODE_EDITOR_API bool IsSuspended();
@@ -384,6 +532,8 @@ IMGUI_NODE_EDITOR_API int BreakLinks(PinId pinId); // Break all links connected
 IMGUI_NODE_EDITOR_API void NavigateToContent(float duration = -1);
 IMGUI_NODE_EDITOR_API void NavigateToSelection(bool zoomIn = false, float duration = -1);
 
+IMGUI_NODE_EDITOR_API void ShowMinimap(float sizeFraction = 0.2f, MinimapLocation location = MinimapLocation::BottomRight); // Call between Begin() and End() every frame it should be visible, click or drag on it to navigate
+
 IMGUI_NODE_EDITOR_API bool ShowNodeContextMenu(NodeId* nodeId);
 IMGUI_NODE_EDITOR_API bool ShowPinContextMenu(PinId* pinId);
 IMGUI_NODE_EDITOR_API bool ShowLinkContextMenu(LinkId* linkId);
@@ -404,6 +554,10 @@ IMGUI_NODE_EDITOR_API int  GetActionContextLinks(LinkId* links, int size);
 IMGUI_NODE_EDITOR_API void EndShortcut();
 
 IMGUI_NODE_EDITOR_API float GetCurrentZoom();
+IMGUI_NODE_EDITOR_API LodLevel GetLodLevel(); // Level of detail for current zoom, see Style::LodSimplifiedZoom and Style::LodSummaryZoom
+
+IMGUI_NODE_EDITOR_API ProfilerStats GetProfilerStats(); // Timings of recent frames
+IMGUI_NODE_EDITOR_API const char* GetProfilerPhaseName(ProfilerPhase phase);
 
 IMGUI_NODE_EDITOR_API NodeId GetHoveredNode();
 IMGUI_NODE_EDITOR_API PinId GetHoveredPin();
@@ -193,6 +193,11 @@ void ax::NodeEditor::EndNode()
     s_Editor->GetNodeBuilder().End();
 }
 
+bool ax::NodeEditor::ReplayNode(NodeId nodeId, uint64_t contentHash)
+{
+    return s_Editor->GetNodeBuilder().Replay(nodeId, contentHash);
+}
+
 bool ax::NodeEditor::BeginGroupHint(NodeId nodeId)
 {
     return s_Editor->GetHintBuilder().Begin(nodeId);
@@ -429,6 +434,26 @@ void ax::NodeEditor::RestoreNodeState(NodeId nodeId)
         s_Editor->MarkNodeToRestoreState(node);
 }
 
+void ax::NodeEditor::ArrangeNodes(const ArrangeConfig& config, const NodeId* nodes, int nodeCount)
+{
+    s_Editor->ArrangeNodes(config, nodes, nodeCount);
+}
+
+bool ax::NodeEditor::IsNodeInView(NodeId nodeId, float margin)
+{
+    return s_Editor->IsNodeInView(nodeId, margin);
+}
+
+int ax::NodeEditor::GetNodesInView(NodeId* nodes, int size, float margin)
+{
+    return s_Editor->GetNodesInView(nodes, size, margin);
+}
+
+bool ax::NodeEditor::SkipNode(NodeId nodeId)
+{
+    return s_Editor->SkipNode(nodeId);
+}
+
 void ax::NodeEditor::Suspend()
 {
     s_Editor->Suspend();
@@ -576,6 +601,11 @@ void ax::NodeEditor::NavigateToSelection(bool zoomIn, float duration)
     s_Editor->NavigateTo(s_Editor->GetSelectionBounds(), zoomIn, duration);
 }
 
+void ax::NodeEditor::ShowMinimap(float sizeFraction, MinimapLocation location)
+{
+    s_Editor->ShowMinimap(sizeFraction, location);
+}
+
 bool ax::NodeEditor::ShowNodeContextMenu(NodeId* nodeId)
 {
     return s_Editor->GetContextMenu().ShowNodeContextMenu(nodeId);
@@ -667,6 +697,21 @@ float ax::NodeEditor::GetCurrentZoom()
     return s_Editor->GetView().InvScale;
 }
 
+ax::NodeEditor::LodLevel ax::NodeEditor::GetLodLevel()
+{
+    return s_Editor->GetLodLevel();
+}
+
+ax::NodeEditor::ProfilerStats ax::NodeEditor::GetProfilerStats()
+{
+    return s_Editor->GetProfiler().GetStats();
+}
+
+const char* ax::NodeEditor::GetProfilerPhaseName(ProfilerPhase phase)
+{
+    return ax::NodeEditor::Detail::FrameProfiler::GetPhaseName(phase);
+}
+
 ax::NodeEditor::NodeId ax::NodeEditor::GetHoveredNode()
 {
     return s_Editor->GetHoveredNode();
@@ -32,11 +32,21 @@
 
 # include <vector>
 # include <string>
+# include <deque>
+# include <unordered_map>
+# include <memory>
+# include <mutex>
+# include <condition_variable>
+# include <thread>
+# include <chrono>
 
 
 //------------------------------------------------------------------------------
 namespace ax {
 namespace NodeEditor {
+namespace Runtime {
+struct ThreadPool;
+} // namespace Runtime
 namespace Detail {
 
 
@@ -144,6 +154,13 @@ using ax::NodeEditor::PinKind;
 using ax::NodeEditor::StyleColor;
 using ax::NodeEditor::StyleVar;
 using ax::NodeEditor::SaveReasonFlags;
+using ax::NodeEditor::LodLevel;
+using ax::NodeEditor::MinimapLocation;
+using ax::NodeEditor::SettingsFormat;
+using ax::NodeEditor::ProfilerPhase;
+using ax::NodeEditor::ProfilerPhaseStats;
+using ax::NodeEditor::ProfilerStats;
+using ax::NodeEditor::ArrangeConfig;
 
 using ax::NodeEditor::NodeId;
 using ax::NodeEditor::PinId;
@@ -234,7 +251,7 @@ struct Object
 
     virtual ObjectId ID() = 0;
 
-    bool IsVisible() const
+    virtual bool IsVisible() const
     {
         if (!m_IsLive)
             return false;
@@ -342,6 +359,8 @@ struct Pin final: Object
         Object::Reset();
     }
 
+    virtual bool IsVisible() const override final;
+
     virtual void Draw(ImDrawList* drawList, DrawFlags flags = None) override final;
 
     ImVec2 GetClosestPoint(const ImVec2& p) const;
@@ -377,6 +396,51 @@ inline NodeRegion operator |(NodeRegion lhs, NodeRegion rhs) { return static_cas
 inline NodeRegion operator &(NodeRegion lhs, NodeRegion rhs) { return static_cast<NodeRegion>(static_cast<uint8_t>(lhs) & static_cast<uint8_t>(rhs)); }
 
 
+// Node content recorded by NodeBuilder, replayed by NodeBuilder::Replay().
+//
+// Only content channel is recorded. User background channel is filled after
+// EndNode() and is left to the user, other channels are drawn by the editor.
+//
+// Vertices and clip rectangles are stored relative to node origin.
+struct NodeDrawCache
+{
+    struct Command
+    {
+        ImDrawCmd m_Command;
+        int       m_FirstVertex;
+        int       m_VertexCount;
+        int       m_FirstIndex;
+        int       m_IndexCount;
+    };
+
+    struct PinState
+    {
+        PinId  m_ID;
+        ImRect m_Bounds;
+        ImRect m_Pivot;
+    };
+
+    bool               m_IsValid      = false;
+    uint64_t           m_Hash         = 0;
+    ImVec2             m_Size;
+    int                m_ZoomBucket   = 0;
+    bool               m_IsSelected   = false;
+    ImVec2             m_WhitePixelUV;
+    vector<Command>    m_Commands;
+    vector<ImDrawVert> m_Vertices;
+    vector<ImDrawIdx>  m_Indices;
+    vector<PinState>   m_Pins;
+
+    void Clear()
+    {
+        m_IsValid = false;
+        m_Commands.resize(0);
+        m_Vertices.resize(0);
+        m_Indices.resize(0);
+        m_Pins.resize(0);
+    }
+};
+
 struct Node final: Object
 {
     using IdType = NodeId;
@@ -386,6 +450,7 @@ struct Node final: Object
     ImRect   m_Bounds;
     float    m_ZPosition;
     int      m_Channel;
+    int      m_ChannelLayer; // entry in EditorContext::m_NodeChannelLayers this frame, -1 for own channels
     Pin*     m_LastPin;
     ImVec2   m_DragStart;
 
@@ -404,6 +469,12 @@ struct Node final: Object
 
     bool     m_RestoreState;
     bool     m_CenterOnScreen;
+    bool     m_IsCulled; // live, but not submitted this frame (see EditorContext::SkipNode)
+    bool     m_WasLive;  // live in previous frame
+
+    NodeDrawCache m_DrawCache;
+    int           m_MembershipIndex; // entry in GroupMembership, -1 if not tracked yet
+    int           m_MinimapIndex;    // entry in Minimap, -1 if not tracked yet
 
     Node(EditorContext* editor, NodeId id)
         : Object(editor)
@@ -412,6 +483,7 @@ struct Node final: Object
         , m_Bounds()
         , m_ZPosition(0.0f)
         , m_Channel(0)
+        , m_ChannelLayer(-1)
         , m_LastPin(nullptr)
         , m_DragStart()
         , m_Color(IM_COL32_WHITE)
@@ -422,11 +494,26 @@ struct Node final: Object
         , m_HighlightConnectedLinks(false)
         , m_RestoreState(false)
         , m_CenterOnScreen(false)
+        , m_IsCulled(false)
+        , m_WasLive(false)
+        , m_MembershipIndex(-1)
+        , m_MinimapIndex(-1)
     {
     }
 
     virtual ObjectId ID() override { return m_ID; }
 
+    virtual void Reset() override final
+    {
+        m_IsCulled     = false;
+        m_ChannelLayer = -1;
+        m_WasLive      = m_IsLive;
+
+        Object::Reset();
+    }
+
+    virtual bool IsVisible() const override final { return !m_IsCulled && Object::IsVisible(); }
+
     bool AcceptDrag() override;
     void UpdateDrag(const ImVec2& offset) override;
     bool EndDrag() override; // return true, when changed
@@ -449,6 +536,28 @@ struct Node final: Object
     virtual Node* AsNode() override final { return this; }
 };
 
+// Curve of a link with arc length lookup table, rebuilt only when curve changes.
+struct LinkGeometry
+{
+    struct ArcPoint
+    {
+        float  m_Distance;
+        ImVec2 m_Point;
+    };
+
+    ImCubicBezierPoints m_Curve;
+    float               m_Length;
+    vector<ArcPoint>    m_ArcLength;
+
+    LinkGeometry(): m_Curve(), m_Length(0.0f) {}
+
+    bool IsValid(const ImCubicBezierPoints& curve) const;
+    void Build(const ImCubicBezierPoints& curve);
+
+    // Appends points placed every 'step' along the curve starting at 'offset'.
+    void Sample(float offset, float step, vector<ImVec2>& points) const;
+};
+
 struct Link final: Object
 {
     using IdType = LinkId;
@@ -461,6 +570,8 @@ struct Link final: Object
     float  m_Thickness;
     ImVec2 m_Start;
     ImVec2 m_End;
+    bool   m_WasLive;      // live in previous frame
+    int    m_MinimapIndex; // entry in Minimap, -1 if not tracked yet
 
     Link(EditorContext* editor, LinkId id)
         : Object(editor)
@@ -469,11 +580,20 @@ struct Link final: Object
         , m_EndPin(nullptr)
         , m_Color(IM_COL32_WHITE)
         , m_Thickness(1.0f)
+        , m_WasLive(false)
+        , m_MinimapIndex(-1)
     {
     }
 
     virtual ObjectId ID() override { return m_ID; }
 
+    virtual void Reset() override final
+    {
+        m_WasLive = m_IsLive;
+
+        Object::Reset();
+    }
+
     virtual bool IsSelectable() override { return true; }
 
     virtual void Draw(ImDrawList* drawList, DrawFlags flags = None) override final;
@@ -482,6 +602,7 @@ struct Link final: Object
     void UpdateEndpoints();
 
     ImCubicBezierPoints GetCurve() const;
+    const LinkGeometry& GetGeometry() const;
 
     virtual bool TestHit(const ImVec2& point, float extraThickness = 0.0f) const override final;
     virtual bool TestHit(const ImRect& rect, bool allowIntersect = true) const override final;
@@ -489,6 +610,9 @@ struct Link final: Object
     virtual ImRect GetBounds() const override final;
 
     virtual Link* AsLink() override final { return this; }
+
+private:
+    mutable LinkGeometry m_Geometry;
 };
 
 struct NodeSettings
@@ -503,6 +627,8 @@ struct NodeSettings
     bool            m_IsDirty;
     SaveReasonFlags m_DirtyReason;
 
+    string          m_Record; // Serialize() of current state, empty when outdated
+
     NodeSettings(NodeId id)
         : m_ID(id)
         , m_Location(0, 0)
@@ -518,7 +644,13 @@ struct NodeSettings
     void ClearDirty();
     void MakeDirty(SaveReasonFlags reason);
 
-    json::value Serialize();
+    bool SetLocation(const ImVec2& location);   // returns true if value changed
+    bool SetGroupSize(const ImVec2& groupSize); // returns true if value changed
+
+    string Serialize(SettingsFormat format); // record passed to Config::SaveNode
+    const string& SerializeCached();
+    string SerializeBinary() const;
+    string SerializeCbor() const;
 
     static bool Parse(const std::string& string, NodeSettings& settings);
     static bool Parse(const json::value& data, NodeSettings& result);
@@ -526,10 +658,21 @@ struct NodeSettings
 
 struct Settings
 {
+    // Nodes of loaded JSON settings which were not asked for yet. Document is
+    // only indexed on load, node is parsed by first FindNode() looking for it.
+    // Never modified, copies of Settings share it.
+    struct PendingNodes
+    {
+        json::lazy_document                            m_Document;
+        vector<std::pair<uintptr_t, json::lazy_value>> m_Nodes; // sorted by id, document order kept for equal ids
+    };
+
     bool                 m_IsDirty;
     SaveReasonFlags      m_DirtyReason;
 
     vector<NodeSettings> m_Nodes;
+    std::unordered_map<uintptr_t, int> m_NodeIndex; // m_Nodes lookup by id
+    std::shared_ptr<const PendingNodes> m_PendingNodes;
     vector<ObjectId>     m_Selection;
     ImVec2               m_ViewScroll;
     float                m_ViewZoom;
@@ -545,15 +688,23 @@ struct Settings
     }
 
     NodeSettings* AddNode(NodeId id);
-    NodeSettings* FindNode(NodeId id);
+    NodeSettings* FindNode(NodeId id); // parses pending node on first call
     void RemoveNode(NodeId id);
 
     void ClearDirty(Node* node = nullptr);
     void MakeDirty(SaveReasonFlags reason, Node* node = nullptr);
 
-    std::string Serialize();
+    std::string Serialize(SettingsFormat format = SettingsFormat::Json);
+    bool Serialize(json::sink& sink, SettingsFormat format = SettingsFormat::Json); // returns false if sink failed
 
     static bool Parse(const std::string& string, Settings& settings);
+
+private:
+    bool ParsePendingNode(NodeSettings& settings) const; // returns false if node is not pending
+
+    std::string SerializeBinary() const;
+
+    static bool ParseBinary(const std::string& string, Settings& settings);
 };
 
 struct Control
@@ -713,27 +864,12 @@ struct FlowAnimation final: Animation
 
     void Flow(Link* link, float markerDistance, float speed, float duration);
 
-    void Draw(ImDrawList* drawList);
-
-private:
-    struct CurvePoint
-    {
-        float  Distance;
-        ImVec2 Point;
-    };
-
-    ImVec2 m_LastStart;
-    ImVec2 m_LastEnd;
-    float  m_PathLength;
-    vector<CurvePoint> m_Path;
+    // Draws flowing link and appends markers to 'markers', controller draws them in one pass.
+    void Draw(ImDrawList* drawList, vector<ImVec2>& markers, float& markerRadius, ImU32& markerColor);
 
     bool IsLinkValid() const;
-    bool IsPathValid() const;
-    void UpdatePath();
-    void ClearPath();
-
-    ImVec2 SamplePath(float distance) const;
 
+private:
     void OnUpdate(float progress) override final;
     void OnStop() override final;
 };
@@ -768,11 +904,30 @@ struct FlowAnimationController final : AnimationController
 
     void Release(FlowAnimation* animation);
 
+    // Stops animation of link which is about to be deleted.
+    void Forget(Link* link);
+
 private:
-    FlowAnimation* GetOrCreate(Link* link);
+    struct MarkerBatch
+    {
+        int   m_First;
+        int   m_Count;
+        float m_Radius;
+        ImU32 m_Color;
+    };
 
-    vector<FlowAnimation*> m_Animations;
-    vector<FlowAnimation*> m_FreePool;
+    FlowAnimation* GetOrCreate(Link* link);
+    void ReclaimStopped();
+    void DrawMarkers(ImDrawList* drawList);
+
+    std::deque<FlowAnimation>                m_Pool;         // storage, addresses are stable
+    vector<FlowAnimation*>                   m_Animations;
+    vector<FlowAnimation*>                   m_FreePool;
+    std::unordered_map<Link*, FlowAnimation*> m_LinkAnimations;
+    bool                                     m_HasStopped;
+    vector<ImVec2>                           m_Markers;
+    vector<MarkerBatch>                      m_MarkerBatches;
+    vector<ImVec2>                           m_CircleDirections;
 };
 
 struct EditorAction
@@ -826,7 +981,8 @@ struct NavigateAction final: EditorAction
         Selection,
         Object,
         Content,
-        Edge
+        Edge,
+        Minimap
     };
 
     bool            m_IsActive;
@@ -1192,12 +1348,20 @@ struct NodeBuilder
     ImDrawListSplitter m_Splitter;
     ImDrawListSplitter m_PinSplitter;
 
+    Node*    m_CacheNode;
+    uint64_t m_CacheHash;
+    bool     m_IsCapturing;
+    int      m_CaptureCommandStart;
+    int      m_CaptureVertexStart;
+
     NodeBuilder(EditorContext* editor);
     ~NodeBuilder();
 
     void Begin(NodeId nodeId);
     void End();
 
+    bool Replay(NodeId nodeId, uint64_t contentHash);
+
     void BeginPin(PinId pinId, PinKind kind);
     void EndPin();
 
@@ -1211,6 +1375,10 @@ struct NodeBuilder
 
     ImDrawList* GetUserBackgroundDrawList() const;
     ImDrawList* GetUserBackgroundDrawList(Node* node) const;
+
+private:
+    void ApplyNodeStyle(Node* node);
+    void CaptureCache(ImDrawList* drawList);
 };
 
 struct HintBuilder
@@ -1274,11 +1442,276 @@ struct Config: ax::NodeEditor::Config
     std::string LoadNode(NodeId nodeId);
 
     void BeginSave();
-    bool Save(const std::string& data, SaveReasonFlags flags);
+    bool Save(Settings& settings, SaveReasonFlags flags);
     bool SaveNode(NodeId nodeId, const std::string& data, SaveReasonFlags flags);
     void EndSave();
 };
 
+// Serializes and writes settings on a background thread. UI thread hands over
+// only node settings changed since previous snapshot, worker applies them to
+// its own copy of settings. Removed nodes are handed over with m_WasUsed unset.
+// Snapshots submitted while worker is busy are merged, so a burst of saves
+// results in a single write. Failed saves are reported back and UI thread marks
+// settings dirty again.
+struct SettingsSaver
+{
+    struct Snapshot
+    {
+        vector<NodeSettings>               m_Nodes; // m_IsDirty - node should be passed to Config::SaveNode
+        std::unordered_map<uintptr_t, int> m_NodeIndex;
+        vector<ObjectId>                   m_Selection;
+        ImVec2                             m_ViewScroll;
+        float                              m_ViewZoom;
+        ImRect                             m_VisibleRect;
+        SaveReasonFlags                    m_Reason;
+
+        Snapshot(): m_ViewZoom(1.0f), m_Reason(SaveReasonFlags::None) {}
+
+        void AddNode(const NodeSettings& settings);
+        void Merge(Snapshot&& newer);
+    };
+
+    struct NodeFailure
+    {
+        NodeId          m_ID;
+        SaveReasonFlags m_Reason;
+    };
+
+    SettingsSaver(const Config& config, const Settings& settings);
+    ~SettingsSaver(); // flushes pending snapshot
+
+    void Submit(Snapshot&& snapshot);
+
+    // Returns false if nothing failed since last call. 'failed' is set
+    // when Config::Save failed, 'reason' holds reasons of that save.
+    bool TakeFailures(bool& failed, SaveReasonFlags& reason, vector<NodeFailure>& nodes);
+
+private:
+    void WorkerMain();
+    bool Write(Snapshot& snapshot, vector<NodeFailure>& failedNodes);
+
+    Config                  m_Config;
+    Settings                m_Settings;     // owned by worker
+    Snapshot                m_Pending;
+    bool                    m_HasPending;
+    bool                    m_Quit;
+    bool                    m_HasFailed;
+    SaveReasonFlags         m_FailedReason;
+    vector<NodeFailure>     m_FailedNodes;
+    std::mutex              m_Mutex;
+    std::condition_variable m_WakeUp;
+    std::thread             m_Thread;
+};
+
+// Tracks which nodes lie inside of which groups. Editor reports nodes which
+// moved, resized or changed liveness with MarkChanged(), Update() is called once
+// per frame and patches membership of these only. Full rebuild uses sweep and
+// prune along x axis. Nodes inside of nested groups are members of all enclosing groups.
+struct GroupMembership
+{
+    GroupMembership(): m_NeedRebuild(true) {}
+
+    void Update(const vector<ObjectWrapper<Node>>& nodes);
+    void Invalidate() { m_NeedRebuild = true; }
+    void MarkChanged(Node* node);
+
+    // Appends nodes grouped by 'group' as of last Update().
+    void GetMembers(const Node* group, vector<Node*>& result) const;
+
+private:
+    struct Entry
+    {
+        Node*       m_Node;
+        ImRect      m_Bounds;
+        ImRect      m_GroupBounds;
+        bool        m_IsGroup;
+        bool        m_IsLive;
+        bool        m_IsChanged; // queued in m_ChangedEntries
+        vector<int> m_Groups;  // groups containing this node
+        vector<int> m_Members; // nodes contained by this group
+    };
+
+    void Record(Entry& entry) const;
+    bool IsMember(const Entry& group, const Entry& node) const;
+    void Rebuild(const vector<ObjectWrapper<Node>>& nodes);
+    void Detach(int node);
+    void DetachMembers(int group);
+    void AttachToGroups(int node);
+    void CollectMembers(int group);
+
+    vector<Entry> m_Entries;
+    vector<int>   m_GroupEntries;
+    vector<int>   m_ChangedEntries;
+    bool          m_NeedRebuild;
+};
+
+// CPU time spent in phases of editor frame, with history of recent frames.
+struct FrameProfiler
+{
+    static const int c_PhaseCount   = static_cast<int>(ProfilerPhase::Count);
+    static const int c_HistorySize  = 120;
+
+    using Clock = std::chrono::steady_clock;
+
+    FrameProfiler();
+
+    // Vertices and indices emitted are counted as growth of draw list buffers.
+    void BeginFrame(const ImDrawList* drawList);
+    void EndFrame(const ImDrawList* drawList, int channelCount);
+
+    void Add(ProfilerPhase phase, Clock::time_point start);
+
+    void BeginSubmission() { m_SubmissionStart = Clock::now(); }
+    void EndSubmission()   { Add(ProfilerPhase::Submission, m_SubmissionStart); }
+
+    ProfilerStats GetStats() const;
+
+    static const char* GetPhaseName(ProfilerPhase phase);
+
+private:
+    float             m_Current[c_PhaseCount];
+    float             m_History[c_PhaseCount][c_HistorySize];
+    int               m_Next;
+    int               m_FrameCount;
+    int               m_VertexStart;
+    int               m_IndexStart;
+    int               m_VertexCount;
+    int               m_IndexCount;
+    int               m_ChannelCount;
+    Clock::time_point m_SubmissionStart;
+};
+
+struct ProfilerScope
+{
+    ProfilerScope(FrameProfiler& profiler, ProfilerPhase phase)
+        : m_Profiler(profiler)
+        , m_Phase(phase)
+        , m_Start(FrameProfiler::Clock::now())
+    {
+    }
+
+    ~ProfilerScope()
+    {
+        m_Profiler.Add(m_Phase, m_Start);
+    }
+
+private:
+    FrameProfiler&                  m_Profiler;
+    ProfilerPhase                   m_Phase;
+    FrameProfiler::Clock::time_point m_Start;
+};
+
+// Coarse overview of the graph. Groups, links and nodes are rasterised into
+// a grid of cells covering the content. Editor reports nodes and links which
+// changed with MarkChanged(), only these are rasterised again and only rows
+// whose coverage changed are turned into rectangles, so drawing cost is bounded
+// by grid size and frames without changes do not visit nodes nor links.
+struct Minimap
+{
+    static const int c_Resolution = 128; // cells along longer side of the content
+
+    EditorContext* Editor;
+
+    Minimap(EditorContext* editor);
+
+    // Minimap is visible only in frames this was called in.
+    void Show(float sizeFraction, MinimapLocation location);
+    bool IsVisible() const { return m_IsVisible; }
+    void EndFrame() { m_IsVisible = false; }
+
+    void Invalidate() { m_NeedRebuild = true; }
+    void MarkChanged(Node* node);
+    void MarkChanged(Link* link);
+
+    // Refreshes cache and places minimap in a corner of editor rectangle, in screen space.
+    void Update(const vector<ObjectWrapper<Node>>& nodes, const vector<ObjectWrapper<Link>>& links, const ImRect& editorRect);
+
+    // Emits input area over minimap, must be called while canvas is active. Returns
+    // true if minimap was clicked or dragged, with 'target' center of view in canvas.
+    bool ProcessInput(ImVec2& target, bool& isClick);
+    bool IsHovered() const { return m_IsHovered; }
+
+    void Draw(ImDrawList* drawList, const ImRect& viewRect);
+
+    const ImRect& GetRect() const { return m_Rect; }
+    int GetRebuildCount() const { return m_RebuildCount; }
+    int GetChangeCount() const { return m_ChangeCount; }
+
+private:
+    enum Layer
+    {
+        Layer_Groups,
+        Layer_Links,
+        Layer_Nodes,
+
+        Layer_Count
+    };
+
+    struct Run
+    {
+        int m_Begin;
+        int m_End;
+    };
+
+    struct NodeEntry
+    {
+        Node*  m_Node;
+        ImRect m_Bounds;
+        bool   m_IsGroup;
+        bool   m_IsLive;
+        bool   m_IsPlaced;
+        bool   m_IsChanged; // queued in m_ChangedNodes
+        int    m_CellMin[2];
+        int    m_CellMax[2];
+    };
+
+    struct LinkEntry
+    {
+        Link*       m_Link;
+        ImVec2      m_Start;
+        ImVec2      m_End;
+        bool        m_IsLive;
+        bool        m_IsChanged; // queued in m_ChangedLinks
+        vector<int> m_Cells;
+    };
+
+    void Rebuild(const vector<ObjectWrapper<Node>>& nodes, const vector<ObjectWrapper<Link>>& links);
+    bool UpdateNodes();
+    bool UpdateLinks();
+    void UpdateRows();
+
+    void Place(NodeEntry& entry);
+    void Remove(NodeEntry& entry);
+    void Place(LinkEntry& entry);
+    void Remove(LinkEntry& entry);
+    void AddToCell(int layer, int cell, int delta);
+
+    int    ToCell(float value, float origin, int size) const;
+    ImVec2 ToMinimap(const ImVec2& point) const;
+
+    ImRect              m_Rect;
+    ImRect              m_World;
+    float               m_CellSize;
+    int                 m_Width;
+    int                 m_Height;
+    vector<int>         m_Cells[Layer_Count];
+    vector<vector<Run>> m_Rows[Layer_Count];
+    vector<char>        m_DirtyRows;
+    vector<NodeEntry>   m_NodeEntries;
+    vector<LinkEntry>   m_LinkEntries;
+    vector<int>         m_ChangedNodes;
+    vector<int>         m_ChangedLinks;
+    int                 m_LiveNodeCount;
+    int                 m_RebuildLiveNodeCount;
+    int                 m_RebuildCount;
+    int                 m_ChangeCount;
+    float               m_SizeFraction;
+    MinimapLocation     m_Location;
+    bool                m_IsVisible;
+    bool                m_IsHovered;
+    bool                m_NeedRebuild;
+};
+
 enum class SuspendFlags : uint8_t
 {
     None = 0,
@@ -1315,6 +1748,10 @@ struct EditorContext
     ShortcutAction& GetShortcut() { return m_ShortcutAction; }
 
     const ImGuiEx::CanvasView& GetView() const { return m_Canvas.View(); }
+    LodLevel GetLodLevel() const { return m_LodLevel; }
+
+    const FrameProfiler& GetProfiler() const { return m_Profiler; }
+    void ShowMinimap(float sizeFraction, MinimapLocation location) { m_Minimap.Show(sizeFraction, location); }
     const ImRect& GetViewRect() const { return m_Canvas.ViewRect(); }
     const ImRect& GetRect() const { return m_Canvas.Rect(); }
 
@@ -1326,6 +1763,13 @@ struct EditorContext
     void SetNodeZPosition(NodeId nodeId, float z);
     float GetNodeZPosition(NodeId nodeId);
 
+    bool IsNodeInView(NodeId nodeId, float margin);
+    int GetNodesInView(NodeId* nodes, int size, float margin) const;
+    bool SkipNode(NodeId nodeId);
+
+    void ArrangeNodes(const ArrangeConfig& config, const NodeId* nodes, int nodeCount);
+    Runtime::ThreadPool& GetLayoutPool();
+
     void MarkNodeToRestoreState(Node* node);
     void UpdateNodeState(Node* node);
 
@@ -1345,6 +1789,7 @@ struct EditorContext
 
     Node* FindNodeAt(const ImVec2& p);
     void FindNodesInRect(const ImRect& r, vector<Node*>& result, bool append = false, bool includeIntersecting = true);
+    void FindGroupedNodes(const Node* group, vector<Node*>& result, bool append = false);
     void FindLinksInRect(const ImRect& r, vector<Link*>& result, bool append = false);
 
     bool HasAnyLinks(NodeId nodeId) const;
@@ -1374,6 +1819,13 @@ struct EditorContext
     void MakeDirty(SaveReasonFlags reason);
     void MakeDirty(SaveReasonFlags reason, Node* node);
 
+    // Bounds, type or liveness of node changed.
+    void NotifyNodeChanged(Node* node);
+    void MarkNodeLive(Node* node);
+
+    // Endpoints or liveness of link changed.
+    void NotifyLinkChanged(Link* link);
+
     int CountLiveNodes() const;
     int CountLivePins() const;
     int CountLiveLinks() const;
@@ -1473,12 +1925,27 @@ struct EditorContext
 
     ImDrawList* GetDrawList() { return m_DrawList; }
 
+    int AllocateNodeChannels(Node* node);
+
 private:
+    // Set of channels shared by nodes in the same z band in layered channel mode.
+    struct NodeChannelLayer
+    {
+        NodeType m_Type;
+        float    m_ZPosition;
+        int      m_Channel;
+        int      m_TargetChannel;
+    };
+
     void LoadSettings();
     void SaveSettings();
+    void SaveSettingsAsync();
+    void ApplySaveResults();
 
     Control BuildControl(bool allowOffscreen);
 
+    bool IsNodeBoundsInView(const Node* node, float margin) const;
+
     void ShowMetrics(const Control& control);
 
     void UpdateAnimations();
@@ -1496,8 +1963,18 @@ private:
     Style               m_Style;
 
     vector<ObjectWrapper<Node>> m_Nodes;
+    vector<ObjectWrapper<Node>> m_NodeIndex; // m_Nodes sorted by id, for lookup
+    int                         m_LiveNodeCount;         // nodes made live in this frame
+    int                         m_KeptLiveNodeCount;     // of these, nodes live also in previous frame
+    int                         m_PreviousLiveNodeCount;
+    GroupMembership             m_GroupMembership;
+    FrameProfiler               m_Profiler;
+    Minimap                     m_Minimap;
     vector<ObjectWrapper<Pin>>  m_Pins;
     vector<ObjectWrapper<Link>> m_Links;
+    int                         m_LiveLinkCount;         // links made live in this frame
+    int                         m_KeptLiveLinkCount;     // of these, links live also in previous frame
+    int                         m_PreviousLiveLinkCount;
 
     vector<Object*>     m_SelectedObjects;
 
@@ -1509,8 +1986,12 @@ private:
     vector<Animation*>  m_LiveAnimations;
     vector<Animation*>  m_LastLiveAnimations;
 
+    vector<NodeChannelLayer>          m_NodeChannelLayers;
+    std::unordered_map<uint64_t, int> m_NodeChannelLayerLookup; // type and z position -> layer index
+
     ImGuiEx::Canvas     m_Canvas;
     bool                m_IsCanvasVisible;
+    LodLevel            m_LodLevel;
 
     NodeBuilder         m_NodeBuilder;
     HintBuilder         m_HintBuilder;
@@ -1539,6 +2020,10 @@ private:
 
     bool                m_IsInitialized;
     Settings            m_Settings;
+    std::unique_ptr<SettingsSaver> m_SettingsSaver;
+    vector<NodeId>      m_RemovedNodeSettings; // removed since last asynchronous save
+
+    std::unique_ptr<Runtime::ThreadPool> m_LayoutPool; // created by first layout large enough to run in parallel
 
     ImDrawList*         m_DrawList;
     int                 m_ExternalChannel;
@@ -0,0 +1,569 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+# include "imgui_node_editor_runtime.h"
+# include <algorithm>
+
+
+//------------------------------------------------------------------------------
+namespace rt = ax::NodeEditor::Runtime;
+
+
+//------------------------------------------------------------------------------
+// Index of worker running on current thread, -1 for threads not owned by a pool.
+static thread_local const rt::ThreadPool* s_CurrentPool        = nullptr;
+static thread_local int                   s_CurrentWorkerIndex = -1;
+
+
+//------------------------------------------------------------------------------
+//
+// Thread Pool
+//
+//------------------------------------------------------------------------------
+rt::ThreadPool::ThreadPool(int workerCount):
+    m_PendingTasks(0),
+    m_NextQueue(0),
+    m_Quit(false)
+{
+    if (workerCount <= 0)
+        workerCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    m_Workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
+        m_Workers.push_back(std::make_unique<Worker>());
+
+    // Threads are started after all queues exist, they steal from each other.
+    for (int i = 0; i < workerCount; ++i)
+        m_Workers[i]->m_Thread = std::thread(&ThreadPool::WorkerMain, this, i);
+}
+
+rt::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_Quit = true;
+    }
+    m_WakeUp.notify_all();
+
+    for (auto& worker : m_Workers)
+        worker->m_Thread.join();
+}
+
+bool rt::ThreadPool::IsWorkerThread() const
+{
+    return s_CurrentPool == this;
+}
+
+void rt::ThreadPool::Submit(Task task)
+{
+    const int index = IsWorkerThread() ? s_CurrentWorkerIndex : static_cast<int>(m_NextQueue++ % m_Workers.size());
+
+    auto& worker = *m_Workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.m_Mutex);
+        worker.m_Tasks.push_back(std::move(task));
+
+        // Counted while queue is still locked, so task cannot be taken before it is counted.
+        std::lock_guard<std::mutex> sleepLock(m_SleepMutex);
+        ++m_PendingTasks;
+    }
+    m_WakeUp.notify_one();
+}
+
+bool rt::ThreadPool::RunPendingTask()
+{
+    const int index = IsWorkerThread() ? s_CurrentWorkerIndex : -1;
+
+    Task task;
+    if ((index >= 0 && Pop(index, task)) || Steal(index, task))
+    {
+        task();
+        return true;
+    }
+
+    return false;
+}
+
+bool rt::ThreadPool::Pop(int index, Task& task)
+{
+    auto& worker = *m_Workers[index];
+
+    std::lock_guard<std::mutex> lock(worker.m_Mutex);
+    if (worker.m_Tasks.empty())
+        return false;
+
+    task = std::move(worker.m_Tasks.back());
+    worker.m_Tasks.pop_back();
+
+    std::lock_guard<std::mutex> sleepLock(m_SleepMutex);
+    --m_PendingTasks;
+    return true;
+}
+
+bool rt::ThreadPool::Steal(int index, Task& task)
+{
+    const int count = static_cast<int>(m_Workers.size());
+    const int start = index >= 0 ? index + 1 : static_cast<int>(m_NextQueue.load() % count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const int victim = (start + i) % count;
+        if (victim == index)
+            continue;
+
+        auto& worker = *m_Workers[victim];
+
+        std::lock_guard<std::mutex> lock(worker.m_Mutex);
+        if (worker.m_Tasks.empty())
+            continue;
+
+        task = std::move(worker.m_Tasks.front());
+        worker.m_Tasks.pop_front();
+
+        std::lock_guard<std::mutex> sleepLock(m_SleepMutex);
+        --m_PendingTasks;
+        return true;
+    }
+
+    return false;
+}
+
+void rt::ThreadPool::WorkerMain(int index)
+{
+    s_CurrentPool        = this;
+    s_CurrentWorkerIndex = index;
+
+    for (;;)
+    {
+        Task task;
+        if (Pop(index, task) || Steal(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_WakeUp.wait(lock, [this] { return m_Quit || m_PendingTasks > 0; });
+        if (m_Quit && m_PendingTasks == 0)
+            break;
+    }
+
+    s_CurrentPool        = nullptr;
+    s_CurrentWorkerIndex = -1;
+}
+
+
+//------------------------------------------------------------------------------
+//
+// Execution Context
+//
+//------------------------------------------------------------------------------
+ax::NodeEditor::NodeId rt::ExecutionContext::GetNodeId() const
+{
+    return m_Graph.m_Nodes[m_Node].m_ID;
+}
+
+int rt::ExecutionContext::GetInputCount() const
+{
+    return static_cast<int>(m_Graph.m_Nodes[m_Node].m_Inputs.size());
+}
+
+int rt::ExecutionContext::GetInputLinkCount(int input) const
+{
+    auto& sources = m_Graph.m_Nodes[m_Node].m_Sources;
+    if (input < 0 || input >= static_cast<int>(sources.size()))
+        return 0;
+
+    return static_cast<int>(sources[input].size());
+}
+
+const rt::Value* rt::ExecutionContext::GetInput(int input, int link) const
+{
+    auto& sources = m_Graph.m_Nodes[m_Node].m_Sources;
+    if (input < 0 || input >= static_cast<int>(sources.size()))
+        return nullptr;
+    if (link < 0 || link >= static_cast<int>(sources[input].size()))
+        return nullptr;
+
+    auto& source = sources[input][link];
+    return &m_Graph.m_Nodes[source.m_Node].m_Values[source.m_Slot];
+}
+
+int rt::ExecutionContext::GetOutputCount() const
+{
+    return static_cast<int>(m_Graph.m_Nodes[m_Node].m_Outputs.size());
+}
+
+rt::Value& rt::ExecutionContext::GetOutput(int output)
+{
+    auto& values = m_Graph.m_Nodes[m_Node].m_Values;
+    IM_ASSERT(output >= 0 && output < static_cast<int>(values.size()));
+    return values[output];
+}
+
+
+//------------------------------------------------------------------------------
+//
+// Graph
+//
+//------------------------------------------------------------------------------
+rt::Graph::Graph():
+    m_PendingSize(0),
+    m_IsCompiled(false)
+{
+}
+
+rt::Graph::~Graph()
+{
+}
+
+bool rt::Graph::AddNode(NodeId nodeId, Kernel kernel)
+{
+    if (m_NodeIndex.find(nodeId.Get()) != m_NodeIndex.end())
+        return false;
+
+    Node node;
+    node.m_ID           = nodeId;
+    node.m_Kernel       = std::move(kernel);
+    node.m_Predecessors = 0;
+    node.m_IsDirty      = true;
+
+    m_NodeIndex[nodeId.Get()] = static_cast<int>(m_Nodes.size());
+    m_Nodes.push_back(std::move(node));
+
+    Invalidate();
+    return true;
+}
+
+bool rt::Graph::AddPin(NodeId nodeId, PinId pinId, PinKind kind)
+{
+    auto nodeIt = m_NodeIndex.find(nodeId.Get());
+    if (nodeIt == m_NodeIndex.end() || m_Pins.find(pinId.Get()) != m_Pins.end())
+        return false;
+
+    auto& node = m_Nodes[nodeIt->second];
+
+    Pin pin;
+    pin.m_ID   = pinId;
+    pin.m_Kind = kind;
+    pin.m_Node = nodeIt->second;
+    if (kind == PinKind::Input)
+    {
+        pin.m_Slot = static_cast<int>(node.m_Inputs.size());
+        node.m_Inputs.push_back(pinId);
+    }
+    else
+    {
+        pin.m_Slot = static_cast<int>(node.m_Outputs.size());
+        node.m_Outputs.push_back(pinId);
+        node.m_Values.emplace_back();
+    }
+
+    m_Pins[pinId.Get()] = pin;
+
+    node.m_IsDirty = true;
+    Invalidate();
+    return true;
+}
+
+bool rt::Graph::AddLink(LinkId linkId, PinId startPinId, PinId endPinId)
+{
+    auto startPin = FindPin(startPinId);
+    auto endPin   = FindPin(endPinId);
+    if (!startPin || !endPin || startPin->m_Kind != PinKind::Output || endPin->m_Kind != PinKind::Input)
+        return false;
+
+    for (auto& link : m_Links)
+        if (link.m_ID == linkId)
+            return false;
+
+    m_Links.push_back({ linkId, startPinId, endPinId });
+
+    m_Nodes[endPin->m_Node].m_IsDirty = true;
+    Invalidate();
+    return true;
+}
+
+bool rt::Graph::RemoveNode(NodeId nodeId)
+{
+    auto nodeIt = m_NodeIndex.find(nodeId.Get());
+    if (nodeIt == m_NodeIndex.end())
+        return false;
+
+    const int index = nodeIt->second;
+
+    // Links are removed first, nodes they lead to have to be executed again.
+    m_Links.erase(std::remove_if(m_Links.begin(), m_Links.end(), [this, index](const Link& link)
+    {
+        auto startPin = FindPin(link.m_StartPin);
+        auto endPin   = FindPin(link.m_EndPin);
+        if (startPin->m_Node != index && endPin->m_Node != index)
+            return false;
+
+        m_Nodes[endPin->m_Node].m_IsDirty = true;
+        return true;
+    }), m_Links.end());
+
+    for (auto& pinId : m_Nodes[index].m_Inputs)
+        m_Pins.erase(pinId.Get());
+    for (auto& pinId : m_Nodes[index].m_Outputs)
+        m_Pins.erase(pinId.Get());
+
+    m_Nodes.erase(m_Nodes.begin() + index);
+
+    // Indices after removed node shifted by one.
+    m_NodeIndex.erase(nodeIt);
+    for (auto& entry : m_NodeIndex)
+        if (entry.second > index)
+            --entry.second;
+    for (auto& entry : m_Pins)
+        if (entry.second.m_Node > index)
+            --entry.second.m_Node;
+
+    Invalidate();
+    return true;
+}
+
+bool rt::Graph::RemoveLink(LinkId linkId)
+{
+    auto linkIt = std::find_if(m_Links.begin(), m_Links.end(), [linkId](const Link& link) { return link.m_ID == linkId; });
+    if (linkIt == m_Links.end())
+        return false;
+
+    if (auto endPin = FindPin(linkIt->m_EndPin))
+        m_Nodes[endPin->m_Node].m_IsDirty = true;
+
+    m_Links.erase(linkIt);
+
+    Invalidate();
+    return true;
+}
+
+void rt::Graph::Clear()
+{
+    m_Nodes.clear();
+    m_NodeIndex.clear();
+    m_Pins.clear();
+    m_Links.clear();
+    m_Order.clear();
+    m_OrderIds.clear();
+    m_CycleNodes.clear();
+    Invalidate();
+}
+
+const rt::Value* rt::Graph::GetValue(PinId pinId) const
+{
+    auto pin = FindPin(pinId);
+    if (!pin || pin->m_Kind != PinKind::Output)
+        return nullptr;
+
+    return &m_Nodes[pin->m_Node].m_Values[pin->m_Slot];
+}
+
+bool rt::Graph::Compile()
+{
+    if (m_IsCompiled)
+        return m_CycleNodes.empty();
+
+    const int nodeCount = static_cast<int>(m_Nodes.size());
+
+    for (auto& node : m_Nodes)
+    {
+        node.m_Sources.assign(node.m_Inputs.size(), {});
+        node.m_Successors.resize(0);
+        node.m_Predecessors = 0;
+    }
+
+    for (auto& link : m_Links)
+    {
+        auto startPin = FindPin(link.m_StartPin);
+        auto endPin   = FindPin(link.m_EndPin);
+
+        m_Nodes[endPin->m_Node].m_Sources[endPin->m_Slot].push_back({ startPin->m_Node, startPin->m_Slot });
+        m_Nodes[startPin->m_Node].m_Successors.push_back(endPin->m_Node);
+    }
+
+    // Multiple links between the same pair of nodes are a single dependency.
+    for (auto& node : m_Nodes)
+    {
+        std::sort(node.m_Successors.begin(), node.m_Successors.end());
+        node.m_Successors.erase(std::unique(node.m_Successors.begin(), node.m_Successors.end()), node.m_Successors.end());
+
+        for (auto successor : node.m_Successors)
+            ++m_Nodes[successor].m_Predecessors;
+    }
+
+    // Kahn's algorithm, nodes left with predecessors are part of a cycle.
+    std::vector<int> predecessors(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+        predecessors[i] = m_Nodes[i].m_Predecessors;
+
+    m_Order.resize(0);
+    m_Order.reserve(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+        if (predecessors[i] == 0)
+            m_Order.push_back(i);
+
+    for (size_t i = 0; i < m_Order.size(); ++i)
+    {
+        for (auto successor : m_Nodes[m_Order[i]].m_Successors)
+            if (--predecessors[successor] == 0)
+                m_Order.push_back(successor);
+    }
+
+    m_CycleNodes.resize(0);
+    for (int i = 0; i < nodeCount; ++i)
+        if (predecessors[i] > 0)
+            m_CycleNodes.push_back(m_Nodes[i].m_ID);
+
+    m_OrderIds.resize(0);
+    m_OrderIds.reserve(m_Order.size());
+    for (auto index : m_Order)
+        m_OrderIds.push_back(m_Nodes[index].m_ID);
+
+    if (m_PendingSize < nodeCount)
+    {
+        m_Pending     = std::make_unique<std::atomic<int>[]>(nodeCount);
+        m_PendingSize = nodeCount;
+    }
+
+    m_IsCompiled = true;
+
+    return m_CycleNodes.empty();
+}
+
+void rt::Graph::MarkDirty(NodeId nodeId)
+{
+    auto nodeIt = m_NodeIndex.find(nodeId.Get());
+    if (nodeIt != m_NodeIndex.end())
+        m_Nodes[nodeIt->second].m_IsDirty = true;
+}
+
+void rt::Graph::MarkAllDirty()
+{
+    for (auto& node : m_Nodes)
+        node.m_IsDirty = true;
+}
+
+bool rt::Graph::IsDirty(NodeId nodeId) const
+{
+    auto nodeIt = m_NodeIndex.find(nodeId.Get());
+    return nodeIt != m_NodeIndex.end() && m_Nodes[nodeIt->second].m_IsDirty;
+}
+
+int rt::Graph::Execute(ThreadPool* pool)
+{
+    if (!Compile())
+        return -1;
+
+    // Propagate dirty flag downstream. Order guarantees predecessors are visited first.
+    std::vector<int> nodes;
+    for (auto index : m_Order)
+    {
+        auto& node = m_Nodes[index];
+        if (!node.m_IsDirty)
+            continue;
+
+        nodes.push_back(index);
+        for (auto successor : node.m_Successors)
+            m_Nodes[successor].m_IsDirty = true;
+    }
+
+    if (nodes.empty())
+        return 0;
+
+    if (pool && pool->GetWorkerCount() > 0 && nodes.size() > 1)
+        RunParallel(*pool, nodes);
+    else
+    {
+        for (auto index : nodes)
+            RunNode(index);
+    }
+
+    for (auto index : nodes)
+        m_Nodes[index].m_IsDirty = false;
+
+    return static_cast<int>(nodes.size());
+}
+
+const rt::Graph::Pin* rt::Graph::FindPin(PinId pinId) const
+{
+    auto pinIt = m_Pins.find(pinId.Get());
+    return pinIt != m_Pins.end() ? &pinIt->second : nullptr;
+}
+
+void rt::Graph::RunNode(int index)
+{
+    auto& node = m_Nodes[index];
+    if (!node.m_Kernel)
+        return;
+
+    ExecutionContext context(*this, index);
+    node.m_Kernel(context);
+}
+
+void rt::Graph::RunParallel(ThreadPool& pool, const std::vector<int>& nodes)
+{
+    // Only dirty predecessors are waited for, clean ones hold valid outputs.
+    for (auto index : nodes)
+        m_Pending[index].store(0, std::memory_order_relaxed);
+    for (auto index : nodes)
+        for (auto successor : m_Nodes[index].m_Successors)
+            m_Pending[successor].fetch_add(1, std::memory_order_relaxed);
+
+    std::atomic<int>        remaining(static_cast<int>(nodes.size()));
+    std::mutex              doneMutex;
+    std::condition_variable done;
+    bool                    finished = false; // guarded by doneMutex, keeps locals alive until last task leaves
+
+    std::function<void(int)> run = [&](int index)
+    {
+        RunNode(index);
+
+        // Successors are submitted from the worker, so they land in its own
+        // queue and a chain of nodes tends to stay on one thread.
+        for (auto successor : m_Nodes[index].m_Successors)
+            if (m_Pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                pool.Submit([&run, successor] { run(successor); });
+
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            finished = true;
+            done.notify_all();
+        }
+    };
+
+    // Roots are collected first, once submitted they start releasing successors.
+    std::vector<int> roots;
+    for (auto index : nodes)
+        if (m_Pending[index].load(std::memory_order_relaxed) == 0)
+            roots.push_back(index);
+
+    for (auto index : roots)
+        pool.Submit([&run, index] { run(index); });
+
+    // Worker waiting for its own tasks would deadlock, help instead.
+    if (pool.IsWorkerThread())
+    {
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (finished)
+                    break;
+            }
+
+            if (!pool.RunPendingTask())
+                std::this_thread::yield();
+        }
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [&finished] { return finished; });
+    }
+}
@@ -0,0 +1,234 @@
+//------------------------------------------------------------------------------
+// LICENSE
+//   This software is dual-licensed to the public domain and under the following
+//   license: you are granted a perpetual, irrevocable license to copy, modify,
+//   publish, and distribute this file as you see fit.
+//------------------------------------------------------------------------------
+//
+// Dataflow execution of graphs authored with node editor.
+//
+// Graph is described with the same NodeId/PinId/LinkId identifiers used by
+// the editor. Links always flow from output pin to input pin. Each node owns
+// a kernel which reads values of connected outputs and writes its own outputs.
+// Execute() runs only dirty nodes and everything downstream of them, in
+// parallel on a ThreadPool where branches are independent.
+//
+//   Runtime::Graph graph;
+//   graph.AddNode(nodeId, [](Runtime::ExecutionContext& context)
+//   {
+//       auto a = context.GetInput(0);
+//       context.GetOutput(0) = a ? std::any_cast<float>(*a) * 2.0f : 0.0f;
+//   });
+//   graph.AddPin(nodeId, inputPinId,  PinKind::Input);
+//   graph.AddPin(nodeId, outputPinId, PinKind::Output);
+//   graph.AddLink(linkId, otherOutputPinId, inputPinId);
+//
+//   Runtime::ThreadPool pool;
+//   graph.Execute(&pool);
+//
+//------------------------------------------------------------------------------
+# ifndef __IMGUI_NODE_EDITOR_RUNTIME_H__
+# define __IMGUI_NODE_EDITOR_RUNTIME_H__
+# pragma once
+
+
+//------------------------------------------------------------------------------
+# include "imgui_node_editor.h"
+# include <any>
+# include <atomic>
+# include <condition_variable>
+# include <deque>
+# include <functional>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <unordered_map>
+# include <vector>
+
+
+//------------------------------------------------------------------------------
+namespace ax {
+namespace NodeEditor {
+namespace Runtime {
+
+
+//------------------------------------------------------------------------------
+struct Graph;
+struct ExecutionContext;
+
+using Value  = std::any;
+using Kernel = std::function<void(ExecutionContext& context)>;
+
+
+//------------------------------------------------------------------------------
+// Work stealing thread pool. Every worker owns a task queue, pops tasks from
+// its back and steals from the front of other queues when it runs dry.
+// Tasks submitted from a worker go to its own queue.
+struct ThreadPool
+{
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(int workerCount = 0); // 0 - one worker per hardware thread
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int  GetWorkerCount() const { return static_cast<int>(m_Workers.size()); }
+    bool IsWorkerThread() const;
+
+    void Submit(Task task);
+
+    // Runs one queued task on calling thread. Returns false if there was none.
+    bool RunPendingTask();
+
+private:
+    struct Worker
+    {
+        std::mutex       m_Mutex;
+        std::deque<Task> m_Tasks;
+        std::thread      m_Thread;
+    };
+
+    bool Pop(int index, Task& task);
+    bool Steal(int index, Task& task);
+    void WorkerMain(int index);
+
+    // Lock order is Worker::m_Mutex, then m_SleepMutex.
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+    std::mutex                           m_SleepMutex;
+    std::condition_variable              m_WakeUp;
+    int                                  m_PendingTasks; // tasks in all queues, guarded by m_SleepMutex
+    std::atomic<unsigned int>            m_NextQueue;
+    bool                                 m_Quit;
+};
+
+
+//------------------------------------------------------------------------------
+// Passed to node kernel. Inputs and outputs are indexed in order their pins
+// were added to the node.
+struct ExecutionContext
+{
+    NodeId GetNodeId() const;
+
+    int GetInputCount() const;
+    int GetInputLinkCount(int input) const;
+
+    // Value of output connected to input, nullptr if input is not connected.
+    const Value* GetInput(int input, int link = 0) const;
+
+    int    GetOutputCount() const;
+    Value& GetOutput(int output);
+
+private:
+    friend struct Graph;
+
+    ExecutionContext(Graph& graph, int node): m_Graph(graph), m_Node(node) {}
+
+    Graph& m_Graph;
+    int    m_Node;
+};
+
+
+//------------------------------------------------------------------------------
+struct Graph
+{
+    Graph();
+    ~Graph();
+
+    Graph(const Graph&) = delete;
+    Graph& operator=(const Graph&) = delete;
+
+    bool AddNode(NodeId nodeId, Kernel kernel);
+    bool AddPin(NodeId nodeId, PinId pinId, PinKind kind);
+    bool AddLink(LinkId linkId, PinId startPinId, PinId endPinId); // output -> input
+    bool RemoveNode(NodeId nodeId);
+    bool RemoveLink(LinkId linkId);
+    void Clear();
+
+    int GetNodeCount() const { return static_cast<int>(m_Nodes.size()); }
+    int GetLinkCount() const { return static_cast<int>(m_Links.size()); }
+
+    // Value written by node kernel to output pin, nullptr if pin is unknown or not an output.
+    const Value* GetValue(PinId pinId) const;
+
+    // Sorts nodes topologically. Returns false if graph contains a cycle,
+    // nodes forming cycles are reported by GetCycleNodes().
+    bool Compile();
+
+    const std::vector<NodeId>& GetOrder()      const { return m_OrderIds;   }
+    const std::vector<NodeId>& GetCycleNodes() const { return m_CycleNodes; }
+
+    // Marks node for execution. Nodes downstream are re-executed too.
+    void MarkDirty(NodeId nodeId);
+    void MarkAllDirty();
+    bool IsDirty(NodeId nodeId) const;
+
+    // Executes dirty nodes and their descendants. Without a pool, or with pool
+    // without workers, nodes run on calling thread in topological order.
+    // Returns number of executed nodes, -1 if graph contains a cycle.
+    int Execute(ThreadPool* pool = nullptr);
+
+private:
+    friend struct ExecutionContext;
+
+    struct Pin
+    {
+        PinId   m_ID;
+        PinKind m_Kind;
+        int     m_Node;
+        int     m_Slot;
+    };
+
+    struct OutputRef
+    {
+        int m_Node;
+        int m_Slot;
+    };
+
+    struct Node
+    {
+        NodeId                              m_ID;
+        Kernel                              m_Kernel;
+        std::vector<PinId>                  m_Inputs;
+        std::vector<PinId>                  m_Outputs;
+        std::vector<Value>                  m_Values;  // one per output
+        std::vector<std::vector<OutputRef>> m_Sources; // per input, rebuilt by Compile()
+        std::vector<int>                    m_Successors;
+        int                                 m_Predecessors;
+        bool                                m_IsDirty;
+    };
+
+    struct Link
+    {
+        LinkId m_ID;
+        PinId  m_StartPin;
+        PinId  m_EndPin;
+    };
+
+    const Pin* FindPin(PinId pinId) const;
+    void       Invalidate() { m_IsCompiled = false; }
+    void       RunNode(int index);
+    void       RunParallel(ThreadPool& pool, const std::vector<int>& nodes);
+
+    std::vector<Node>                       m_Nodes;
+    std::unordered_map<uintptr_t, int>      m_NodeIndex;
+    std::unordered_map<uintptr_t, Pin>      m_Pins;
+    std::vector<Link>                       m_Links;
+    std::vector<int>                        m_Order;
+    std::vector<NodeId>                     m_OrderIds;
+    std::vector<NodeId>                     m_CycleNodes;
+    std::unique_ptr<std::atomic<int>[]>     m_Pending;
+    int                                     m_PendingSize;
+    bool                                    m_IsCompiled;
+};
+
+
+//------------------------------------------------------------------------------
+} // namespace Runtime
+} // namespace NodeEditor
+} // namespace ax
+
+
+//------------------------------------------------------------------------------
+# endif // __IMGUI_NODE_EDITOR_RUNTIME_H__
@@ -210,6 +210,10 @@ void 应用::绘制UI() {
   ImGui::Begin(ICON_FA_BLENDER "窗口" ICON_FA_PEN "应用程序");
   ImGui::Text(ICON_FA_PEN " 帧率: %d FPS 每秒 (%.6f ms)", _时间->获取目标帧率(),
               _时间->获取无缩放帧间时长());
+  const auto 统计 = _资源管理器->获取资源统计();
+  ImGui::Text("纹理: %zu 个 %.1f MB (淘汰 %llu 个)", 统计.纹理.驻留数量,
+              统计.纹理.驻留字节 / (1024.0 * 1024.0),
+              static_cast<unsigned long long>(统计.纹理.淘汰数量));
 
   ImGui::End();
 
@@ -230,7 +234,11 @@ void 应用::绘制画面() {
 void 应用::运行() {
   _时间->更新();
   auto 帧间隔时长 = _时间->获取帧间时长();
+  // 上一帧已经绘制完毕，超出预算的资源在这里淘汰
+  _资源管理器->回收资源();
   更新逻辑(帧间隔时长);
+  // 上传后台解码完成的纹理，每帧有预算，避免卡顿
+  _资源管理器->处理纹理上传();
   更新UI();
   绘制画面();
 }
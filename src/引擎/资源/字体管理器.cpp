@@ -4,7 +4,7 @@
 
 namespace 引擎::资源 {
 
-字体管理器::字体管理器() {
+字体管理器::字体管理器(路径驻留表 &路径表) : _路径表(路径表) {
   if (!TTF_WasInit() && !TTF_Init()) {
     throw std::runtime_error("字体管理器 错误: TTF_Init 失败：" +
                              std::string(SDL_GetError()));
@@ -22,6 +22,16 @@ namespace 引擎::资源 {
 }
 
 TTF_Font *字体管理器::载入字体(std::string_view 路径, int 字号大小) {
+  return 载入字体(_路径表.驻留(路径), 字号大小);
+}
+
+TTF_Font *字体管理器::载入字体(资源句柄 句柄, int 字号大小) {
+  if (!_路径表.有效(句柄)) {
+    记录错误("无效的资源句柄: {}", 句柄.序号);
+    return nullptr;
+  }
+  const auto &路径 = _路径表.路径(句柄);
+
   // 检查点大小是否有效
   if (字号大小 <= 0) {
     记录错误("无法加载字体 '{}'：无效的点大小 {}。", 路径, 字号大小);
@@ -29,44 +39,60 @@ TTF_Font *字体管理器::载入字体(std::string_view 路径, int 字号大
   }
 
   // 创建映射表的键
-  FontKey key = {std::string(路径), 字号大小};
+  const 字体键 键{句柄, 字号大小};
 
   // 首先检查缓存
-  auto it = _字体池.find(key);
+  auto it = _字体池.find(键);
   if (it != _字体池.end()) {
-    return it->second.get();
+    _预算.使用(it->second.驻留);
+    return it->second.字体.get();
   }
 
   // 缓存中不存在，则加载字体
   记录调试("正在加载字体：{} ({}pt)", 路径, 字号大小);
-  TTF_Font *原始字体 = TTF_OpenFont(路径.data(), 字号大小);
+  TTF_Font *原始字体 = TTF_OpenFont(路径.c_str(), 字号大小);
   if (!原始字体) {
     记录错误("加载字体 '{}' ({}pt) 失败：{}", 路径, 字号大小, SDL_GetError());
     return nullptr;
   }
 
   // 使用 unique_ptr 存储到缓存中
-  _字体池.emplace(key, std::unique_ptr<TTF_Font, SDLFont删除器>(原始字体));
+  auto &项 = _字体池[键];
+  项.字体.reset(原始字体);
+  _预算.记录载入(项.驻留, 估算文件字节(路径));
   记录调试("成功加载并缓存字体：{} ({}pt)", 路径, 字号大小);
   return 原始字体;
 }
 
 TTF_Font *字体管理器::获取字体(std::string_view 路径, int 字号大小) {
-  FontKey key = {std::string(路径), 字号大小};
-  auto it = _字体池.find(key);
+  return 获取字体(_路径表.驻留(路径), 字号大小);
+}
+
+TTF_Font *字体管理器::获取字体(资源句柄 句柄, int 字号大小) {
+  auto it = _字体池.find(字体键{句柄, 字号大小});
   if (it != _字体池.end()) {
-    return it->second.get();
+    _预算.使用(it->second.驻留);
+    return it->second.字体.get();
   }
 
-  记录警告("字体 '{}' ({}pt) 不在缓存中，尝试加载。", 路径, 字号大小);
-  return 载入字体(路径, 字号大小);
+  if (_路径表.有效(句柄)) {
+    记录警告("字体 '{}' ({}pt) 不在缓存中，尝试加载。", _路径表.路径(句柄),
+             字号大小);
+  }
+  return 载入字体(句柄, 字号大小);
 }
 
 void 字体管理器::卸载字体(std::string_view 路径, int 字号大小) {
-  FontKey key = {std::string(路径), 字号大小};
-  auto it = _字体池.find(key);
+  // 只查找，不为从未载入过的路径分配句柄
+  auto it = _字体池.find(字体键{_路径表.查找(路径), 字号大小});
   if (it != _字体池.end()) {
+    if (it->second.驻留.引用计数 > 0) {
+      记录警告("无法卸载仍被引用的字体：{} ({}pt，引用计数 {})", 路径, 字号大小,
+               it->second.驻留.引用计数);
+      return;
+    }
     记录调试("卸载字体：{} ({}pt)", 路径, 字号大小);
+    _预算.记录卸载(it->second.驻留);
     _字体池.erase(it); // unique_ptr 会处理 TTF_CloseFont
   } else {
     记录警告("尝试卸载不存在的字体：{} ({}pt)", 路径, 字号大小);
@@ -78,6 +104,45 @@ void 字体管理器::清空字体池() {
     记录调试("正在清理所有 {} 个缓存的字体。", _字体池.size());
     _字体池.clear(); // unique_ptr 会处理删除
   }
+  _预算.清空();
+}
+
+bool 字体管理器::增加引用(资源句柄 句柄, int 字号大小) {
+  if (!载入字体(句柄, 字号大小)) {
+    return false;
+  }
+  _字体池[字体键{句柄, 字号大小}].驻留.引用计数 += 1;
+  return true;
 }
 
-} // namespace 引擎::资源
\ No newline at end of file
+void 字体管理器::减少引用(资源句柄 句柄, int 字号大小) {
+  auto it = _字体池.find(字体键{句柄, 字号大小});
+  if (it == _字体池.end() || it->second.驻留.引用计数 == 0) {
+    记录警告("释放未被引用的字体：{} ({}pt)", 句柄.序号, 字号大小);
+    return;
+  }
+  it->second.驻留.引用计数 -= 1;
+}
+
+void 字体管理器::回收() {
+  if (!_预算.超出预算()) {
+    return;
+  }
+
+  std::vector<std::pair<std::uint64_t, 字体键>> 候选;
+  for (const auto &[键, 项] : _字体池) {
+    if (项.驻留.引用计数 == 0) {
+      候选.emplace_back(项.驻留.最近使用, 键);
+    }
+  }
+  _预算.淘汰(
+      候选,
+      [this](const 字体键 &键) -> 驻留信息 & { return _字体池[键].驻留; },
+      [this](const 字体键 &键) { _字体池.erase(键); });
+}
+
+void 字体管理器::设置预算(std::size_t 字节数) { _预算.设置预算(字节数); }
+
+const 资源池统计 &字体管理器::获取统计() const { return _预算.获取统计(); }
+
+} // namespace 引擎::资源
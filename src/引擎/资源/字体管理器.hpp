@@ -1,29 +1,39 @@
 #pragma once
 #include <SDL3_ttf/SDL_ttf.h> // SDL_ttf 主头文件
-#include <functional>         // 用于 std::hash
+#include <cstdint>            // 用于 std::uint64_t
 #include <memory>             // 用于 std::unique_ptr
 #include <stdexcept>          // 用于 std::runtime_error
 #include <string>             // 用于 std::string
 #include <string_view>        // 用于 std::string_view
 #include <unordered_map>      // 用于 std::unordered_map
-#include <utility>            // 用于 std::pair
+
+#include "资源句柄.hpp"
+#include "资源预算.hpp"
 
 namespace 引擎::资源 {
 
-// 定义字体键类型（路径 + 大小）
-using FontKey = std::pair<std::string, int>;
-// std::pair是标准库中的一个类模板，用于将两个值组合成一个单元
-
-// FontKey 的自定义哈希函数（std::pair<std::string, int>），用于
-// std::unordered_map
-struct FontKeyHash {
-  std::size_t operator()(const FontKey &key) const {
-    std::hash<std::string> string_hasher;
-    std::hash<int> int_hasher;
-    return string_hasher(key.first) ^
-           int_hasher(
-               key.second); // 异或运算符 ^
-                            // 按位计算，每一位的两个值不同为1，相同为0，这是合并两个哈希值的简单方法
+// 字体键（路径句柄 + 字号大小），不再包含字符串
+struct 字体键 {
+  资源句柄 路径;
+  int 字号大小 = 0;
+
+  bool operator==(const 字体键 &) const = default;
+};
+
+// 字体键 的哈希函数，用于 std::unordered_map
+// 两个 32 位值拼成一个 64 位整数再充分混合，避免异或合并时
+// 相同字号、相近句柄互相抵消造成的冲突
+struct 字体键哈希 {
+  std::size_t operator()(const 字体键 &键) const noexcept {
+    std::uint64_t 值 = (static_cast<std::uint64_t>(键.路径.序号) << 32) |
+                      static_cast<std::uint32_t>(键.字号大小);
+    // splitmix64 的末尾混合步骤
+    值 ^= 值 >> 30;
+    值 *= 0xbf58476d1ce4e5b9ull;
+    值 ^= 值 >> 27;
+    值 *= 0x94d049bb133111ebull;
+    值 ^= 值 >> 31;
+    return static_cast<std::size_t>(值);
   }
 };
 
@@ -46,19 +56,28 @@ private:
     }
   };
 
-  // 字体存储（FontKey -> TTF_Font）。
+  struct 字体项 {
+    std::unique_ptr<TTF_Font, SDLFont删除器> 字体;
+    驻留信息 驻留;
+  };
+
+  // 字体存储（字体键 -> TTF_Font）。
   // unordered_map 的键需要能转换为哈希值，对于基础数据类型，系统会自动转换
   // 但是对于对于自定义类型（系统无法自动转化），则需要提供自定义哈希函数（第三个模版参数）
-  std::unordered_map<FontKey, std::unique_ptr<TTF_Font, SDLFont删除器>,
-                     FontKeyHash>
-      _字体池;
+  std::unordered_map<字体键, 字体项, 字体键哈希> _字体池;
+
+  // 字形缓存无法查询，按字体文件大小估算
+  资源预算 _预算{64 * 1024 * 1024};
+
+  路径驻留表 &_路径表; // 由 资源管理器 持有，各管理器共享
 
 public:
   /**
    * @brief 构造函数。初始化 SDL_ttf。
+   * @param 路径表 共享的路径驻留表，生命周期必须长于字体管理器。
    * @throws std::runtime_error 如果 SDL_ttf 初始化失败。
    */
-  字体管理器();
+  explicit 字体管理器(路径驻留表 &路径表);
 
   ~字体管理器(); // 需要手动添加析构函数，清理资源并关闭 SDL_ttf。
 
@@ -77,6 +96,18 @@ private: // 仅由 ResourceManager（和内部）访问的方法
   void 卸载字体(std::string_view, int 字号大小);
 
   void 清空字体池(); // 清空所有缓存的字体
+
+  // 按句柄访问，不对路径求哈希
+  TTF_Font *载入字体(资源句柄 句柄, int 字号大小);
+  TTF_Font *获取字体(资源句柄 句柄, int 字号大小);
+
+  // 引用计数大于 0 的字体不会被淘汰，跨帧持有 TTF_Font 时应当保持引用
+  bool 增加引用(资源句柄 句柄, int 字号大小);
+  void 减少引用(资源句柄 句柄, int 字号大小);
+  // 超出预算时按最久未使用淘汰未被引用的字体
+  void 回收();
+  void 设置预算(std::size_t 字节数);
+  const 资源池统计 &获取统计() const;
 };
 
 } // namespace 引擎::资源
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include "glm/ext/vector_float2.hpp"
+#include <cstdint>
+
+struct SDL_Texture;
+
+namespace 引擎::资源 {
+
+/**
+ * @brief 异步载入纹理返回的句柄。
+ *
+ * 同一路径总是得到同一个句柄。载入完成前解析为占位纹理，
+ * 值为 0 表示无效句柄。
+ */
+struct 异步纹理句柄 {
+  std::uint32_t 序号 = 0;
+
+  explicit operator bool() const { return 序号 != 0; }
+};
+
+/**
+ * @brief 图集中一张图片的句柄。
+ *
+ * 图集重排后图片所在的页和位置会改变，句柄不变，
+ * 每次绘制前通过句柄取得当前的 图集区域。值为 0 表示无效句柄。
+ */
+struct 图集句柄 {
+  std::uint32_t 序号 = 0;
+
+  explicit operator bool() const { return 序号 != 0; }
+};
+
+/**
+ * @brief 图片在图集中的位置，可直接用于 ImGui::Image 或 SDL_RenderTexture。
+ */
+struct 图集区域 {
+  SDL_Texture *纹理 = nullptr; // 所在页的纹理，无效句柄时为空
+  glm::vec2 UV最小{0.0f};
+  glm::vec2 UV最大{0.0f};
+  glm::vec2 位置{0.0f}; // 页内像素坐标，用于 SDL_RenderTexture 的源矩形
+  glm::vec2 尺寸{0.0f}; // 图片的像素尺寸
+};
+
+} // namespace 引擎::资源
@@ -0,0 +1,326 @@
+#include "纹理图集.hpp"
+#include "SDL3_image/SDL_image.h"
+#include "日志.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace 引擎::资源 {
+
+// --- 天际线装箱 ---
+
+天际线装箱::天际线装箱(int 宽, int 高) : _宽(宽), _高(高) { 清空(); }
+
+void 天际线装箱::清空() {
+  _天际线.clear();
+  _天际线.push_back({0, 0, _宽});
+}
+
+int 天际线装箱::适配(std::size_t i, int 宽, int 高) const {
+  const int x = _天际线[i].x;
+  if (x + 宽 > _宽) {
+    return -1;
+  }
+
+  // 矩形跨过的节点中最高的一个决定放置高度
+  int y = _天际线[i].y;
+  int 剩余宽度 = 宽;
+  while (剩余宽度 > 0) {
+    y = std::max(y, _天际线[i].y);
+    if (y + 高 > _高) {
+      return -1;
+    }
+    剩余宽度 -= _天际线[i].宽;
+    ++i;
+  }
+  return y;
+}
+
+bool 天际线装箱::插入(int 宽, int 高, int &x, int &y) {
+  // 左下优先：底边最低，其次所在节点最窄
+  std::size_t 最佳 = _天际线.size();
+  int 最佳底边 = _高 + 1;
+  int 最佳宽度 = _宽 + 1;
+  for (std::size_t i = 0; i < _天际线.size(); ++i) {
+    const int 顶边 = 适配(i, 宽, 高);
+    if (顶边 < 0) {
+      continue;
+    }
+    if (顶边 + 高 < 最佳底边 ||
+        (顶边 + 高 == 最佳底边 && _天际线[i].宽 < 最佳宽度)) {
+      最佳 = i;
+      最佳底边 = 顶边 + 高;
+      最佳宽度 = _天际线[i].宽;
+    }
+  }
+  if (最佳 == _天际线.size()) {
+    return false;
+  }
+
+  x = _天际线[最佳].x;
+  y = 最佳底边 - 高;
+  _天际线.insert(_天际线.begin() + 最佳, {x, 最佳底边, 宽});
+
+  // 被新节点遮住的部分从后续节点中去掉
+  for (std::size_t i = 最佳 + 1; i < _天际线.size();) {
+    const auto &前 = _天际线[i - 1];
+    auto &当前 = _天际线[i];
+    const int 重叠 = 前.x + 前.宽 - 当前.x;
+    if (重叠 <= 0) {
+      break;
+    }
+    当前.x += 重叠;
+    当前.宽 -= 重叠;
+    if (当前.宽 > 0) {
+      break;
+    }
+    _天际线.erase(_天际线.begin() + i);
+  }
+
+  // 合并高度相同的相邻节点
+  for (std::size_t i = 0; i + 1 < _天际线.size();) {
+    if (_天际线[i].y == _天际线[i + 1].y) {
+      _天际线[i].宽 += _天际线[i + 1].宽;
+      _天际线.erase(_天际线.begin() + i + 1);
+    } else {
+      ++i;
+    }
+  }
+  return true;
+}
+
+// --- 纹理图集 ---
+
+纹理图集::纹理图集(SDL_Renderer *渲染器) : _渲染器(渲染器) {
+  if (!_渲染器) {
+    throw std::runtime_error("纹理图集初始化失败，渲染器为空");
+  }
+  记录跟踪("纹理图集初始化成功");
+}
+
+图集句柄 纹理图集::载入图片(std::string_view 路径) {
+  if (路径.empty()) {
+    记录错误("图片路径为空");
+    return {};
+  }
+
+  auto it = _图片序号.find(路径);
+  if (it != _图片序号.end() && _图片[it->second - 1].像素) {
+    return {it->second};
+  }
+
+  SDL_Surface *原始 = IMG_Load(std::string(路径).c_str());
+  if (!原始) {
+    记录错误("加载图片失败: {} (原因: {})", 路径, SDL_GetError());
+    return {};
+  }
+
+  // 统一为 RGBA32，便于复制出血像素和重排时重新上传
+  std::unique_ptr<SDL_Surface, SDLSurface删除器> 像素(
+      SDL_ConvertSurface(原始, SDL_PIXELFORMAT_RGBA32));
+  SDL_DestroySurface(原始);
+  if (!像素) {
+    记录错误("转换图片格式失败: {} (原因: {})", 路径, SDL_GetError());
+    return {};
+  }
+
+  if (像素->w + 2 * 出血 + 间距 > 页尺寸 ||
+      像素->h + 2 * 出血 + 间距 > 页尺寸) {
+    记录错误("图片 {} ({}x{}) 超过图集页尺寸，请使用 载入纹理", 路径, 像素->w,
+             像素->h);
+    return {};
+  }
+
+  std::uint32_t 序号 = 0;
+  if (it != _图片序号.end()) {
+    序号 = it->second;
+  } else {
+    _图片.emplace_back().路径 = 路径;
+    序号 = static_cast<std::uint32_t>(_图片.size());
+    _图片序号.emplace(路径, 序号);
+  }
+
+  auto &目标 = _图片[序号 - 1];
+  目标.像素 = std::move(像素);
+  if (!放置(目标)) {
+    记录错误("无法把图片放入图集: {}", 路径);
+    目标.像素.reset();
+    return {};
+  }
+
+  记录跟踪("图片放入图集: {} (页 {})", 路径, 目标.页号);
+  return {序号};
+}
+
+图集区域 纹理图集::获取区域(图集句柄 句柄) const {
+  if (!句柄 || 句柄.序号 > _图片.size()) {
+    记录错误("无效的图集句柄: {}", 句柄.序号);
+    return {};
+  }
+
+  const auto &目标 = _图片[句柄.序号 - 1];
+  if (!目标.像素) {
+    return {};
+  }
+
+  const float 页宽 = static_cast<float>(页尺寸);
+  图集区域 区域;
+  区域.纹理 = _页[目标.页号].纹理.get();
+  区域.位置 = glm::vec2(static_cast<float>(目标.位置.x),
+                       static_cast<float>(目标.位置.y));
+  区域.尺寸 = glm::vec2(static_cast<float>(目标.位置.w),
+                       static_cast<float>(目标.位置.h));
+  区域.UV最小 = glm::vec2(区域.位置.x / 页宽, 区域.位置.y / 页宽);
+  区域.UV最大 = glm::vec2((区域.位置.x + 区域.尺寸.x) / 页宽,
+                         (区域.位置.y + 区域.尺寸.y) / 页宽);
+  return 区域;
+}
+
+void 纹理图集::卸载图片(std::string_view 路径) {
+  auto it = _图片序号.find(路径);
+  if (it == _图片序号.end() || !_图片[it->second - 1].像素) {
+    记录警告("尝试卸载不存在的图集图片: {}", 路径);
+    return;
+  }
+
+  auto &目标 = _图片[it->second - 1];
+  _页[目标.页号].存活面积 -=
+      static_cast<std::int64_t>(目标.位置.w + 2 * 出血 + 间距) *
+      (目标.位置.h + 2 * 出血 + 间距);
+  目标.像素.reset();
+  记录调试("卸载图集图片: {}", 路径);
+
+  if (碎片率() > 重排阈值) {
+    整理();
+  }
+}
+
+void 纹理图集::整理() {
+  std::vector<图片 *> 存活;
+  for (auto &目标 : _图片) {
+    if (目标.像素) {
+      存活.push_back(&目标);
+    }
+  }
+
+  // 从高到低放置，天际线更平整
+  std::stable_sort(存活.begin(), 存活.end(), [](const 图片 *a, const 图片 *b) {
+    return a->位置.h > b->位置.h;
+  });
+
+  for (auto &当前页 : _页) {
+    当前页.装箱.清空();
+    当前页.已分配面积 = 0;
+    当前页.存活面积 = 0;
+  }
+
+  for (auto *目标 : 存活) {
+    if (!放置(*目标)) {
+      记录错误("重排图集时无法放置图片: {}", 目标->路径);
+      目标->像素.reset();
+    }
+  }
+
+  // 释放重排后空出来的页
+  const auto 页数 = _页.size();
+  while (!_页.empty() && _页.back().已分配面积 == 0) {
+    _页.pop_back();
+  }
+
+  记录调试("图集重排完成: {} 张图片，{} 页 -> {} 页", 存活.size(), 页数,
+           _页.size());
+}
+
+void 纹理图集::清空() {
+  if (!_页.empty()) {
+    记录调试("正在清除 {} 个图集页。", _页.size());
+  }
+  _页.clear();
+  // 句柄槽位保留，同一路径再次载入时得到相同句柄
+  for (auto &目标 : _图片) {
+    目标.像素.reset();
+  }
+}
+
+float 纹理图集::碎片率() const {
+  std::int64_t 已分配 = 0, 存活 = 0;
+  for (const auto &当前页 : _页) {
+    已分配 += 当前页.已分配面积;
+    存活 += 当前页.存活面积;
+  }
+  if (已分配 == 0) {
+    return 0.0f;
+  }
+  return static_cast<float>(已分配 - 存活) / static_cast<float>(已分配);
+}
+
+bool 纹理图集::放置(图片 &目标) {
+  const int 宽 = 目标.像素->w + 2 * 出血 + 间距;
+  const int 高 = 目标.像素->h + 2 * 出血 + 间距;
+
+  int x = 0, y = 0;
+  std::size_t 页号 = 0;
+  while (页号 < _页.size() && !_页[页号].装箱.插入(宽, 高, x, y)) {
+    ++页号;
+  }
+  if (页号 == _页.size()) {
+    if (!新建页() || !_页.back().装箱.插入(宽, 高, x, y)) {
+      return false;
+    }
+  }
+
+  const std::int64_t 面积 = static_cast<std::int64_t>(宽) * 高;
+  _页[页号].已分配面积 += 面积;
+  _页[页号].存活面积 += 面积;
+
+  目标.页号 = 页号;
+  目标.位置 = {x + 出血, y + 出血, 目标.像素->w, 目标.像素->h};
+  上传(目标);
+  return true;
+}
+
+bool 纹理图集::新建页() {
+  SDL_Texture *纹理 = SDL_CreateTexture(_渲染器, SDL_PIXELFORMAT_RGBA32,
+                                        SDL_TEXTUREACCESS_STATIC, 页尺寸,
+                                        页尺寸);
+  if (!纹理) {
+    记录错误("创建图集页失败: {}", SDL_GetError());
+    return false;
+  }
+  if (!SDL_SetTextureScaleMode(纹理, SDL_SCALEMODE_NEAREST)) {
+    记录警告("无法设置纹理缩放模式: {}", SDL_GetError());
+  }
+  SDL_SetTextureBlendMode(纹理, SDL_BLENDMODE_BLEND);
+
+  _页.push_back({std::unique_ptr<SDL_Texture, SDLTexture删除器>(纹理),
+                 天际线装箱(页尺寸, 页尺寸)});
+  记录调试("新建图集页，当前共 {} 页", _页.size());
+  return true;
+}
+
+void 纹理图集::上传(const 图片 &目标) {
+  const SDL_Surface *源 = 目标.像素.get();
+  const int 宽 = 源->w + 2 * 出血;
+  const int 高 = 源->h + 2 * 出血;
+
+  // 中心是原图，四周各 出血 像素取最近的边缘像素
+  std::vector<std::uint32_t> 缓冲(static_cast<std::size_t>(宽) * 高);
+  for (int dy = 0; dy < 高; ++dy) {
+    const int sy = std::clamp(dy - 出血, 0, 源->h - 1);
+    const auto *源行 = static_cast<const Uint8 *>(源->pixels) +
+                       static_cast<std::size_t>(sy) * 源->pitch;
+    for (int dx = 0; dx < 宽; ++dx) {
+      const int sx = std::clamp(dx - 出血, 0, 源->w - 1);
+      std::memcpy(&缓冲[static_cast<std::size_t>(dy) * 宽 + dx], 源行 + sx * 4,
+                  4);
+    }
+  }
+
+  const SDL_Rect 区域{目标.位置.x - 出血, 目标.位置.y - 出血, 宽, 高};
+  if (!SDL_UpdateTexture(_页[目标.页号].纹理.get(), &区域, 缓冲.data(),
+                         宽 * 4)) {
+    记录错误("上传图集图片失败: {} (原因: {})", 目标.路径, SDL_GetError());
+  }
+}
+
+} // namespace 引擎::资源
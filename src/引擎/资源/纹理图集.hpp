@@ -0,0 +1,119 @@
+#pragma once
+#include "SDL3/SDL.h"
+#include "纹理句柄.hpp"
+#include "资源句柄.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace 引擎::资源 {
+
+/**
+ * @brief 天际线装箱算法，在固定大小的页上按左下优先放置矩形。
+ *
+ * 只记录每一列已占用的最高位置，插入是增量的。释放的矩形无法单独回收，
+ * 由 纹理图集 统计碎片并在需要时整页重排。
+ */
+class 天际线装箱 final {
+private:
+  struct 节点 {
+    int x;
+    int y;
+    int 宽;
+  };
+
+  int _宽;
+  int _高;
+  std::vector<节点> _天际线;
+
+public:
+  天际线装箱(int 宽, int 高);
+
+  // 成功时写入左上角坐标
+  bool 插入(int 宽, int 高, int &x, int &y);
+  void 清空();
+
+private:
+  // 矩形放在第 i 个节点起始处时的 y，放不下返回 -1
+  int 适配(std::size_t i, int 宽, int 高) const;
+};
+
+/**
+ * @brief 把小图片合并到少量大纹理页中，减少纹理切换和绘制批次。
+ *
+ * 图片以 RGBA32 保存在内存中，周围留出间距并向外复制边缘像素（出血），
+ * 避免采样时混入相邻图片。页满时新建一页。卸载造成的空洞超过阈值时，
+ * 所有图片按高度重新装箱并上传，句柄保持不变。
+ * 仅供 资源管理器 内部使用，构造失败会抛出异常。
+ */
+class 纹理图集 final {
+  friend class 资源管理器;
+
+private:
+  struct SDLTexture删除器 {
+    void operator()(SDL_Texture *纹理) const {
+      if (纹理) {
+        SDL_DestroyTexture(纹理);
+      }
+    }
+  };
+
+  struct SDLSurface删除器 {
+    void operator()(SDL_Surface *表面) const {
+      if (表面) {
+        SDL_DestroySurface(表面);
+      }
+    }
+  };
+
+  struct 页 {
+    std::unique_ptr<SDL_Texture, SDLTexture删除器> 纹理;
+    天际线装箱 装箱;
+    std::int64_t 已分配面积 = 0; // 包括已卸载图片留下的空洞
+    std::int64_t 存活面积 = 0;
+  };
+
+  struct 图片 {
+    std::string 路径;
+    std::unique_ptr<SDL_Surface, SDLSurface删除器> 像素; // 为空表示已卸载
+    std::size_t 页号 = 0;
+    SDL_Rect 位置{}; // 不含间距和出血
+  };
+
+  SDL_Renderer *_渲染器;
+
+  std::vector<页> _页;
+  // 句柄序号减一即为下标，卸载后槽位保留给同一路径
+  std::vector<图片> _图片;
+  字符串映射<std::uint32_t> _图片序号;
+
+  static constexpr int 页尺寸 = 2048;
+  static constexpr int 间距 = 1; // 相邻图片之间留空的像素
+  static constexpr int 出血 = 1; // 向外复制边缘像素的宽度
+  // 空洞占已分配面积的比例超过此值时重排
+  static constexpr double 重排阈值 = 0.5;
+
+public:
+  explicit 纹理图集(SDL_Renderer *渲染器);
+
+  纹理图集(纹理图集 &&) = delete;
+  纹理图集(const 纹理图集 &) = delete;
+  纹理图集 &operator=(纹理图集 &&) = delete;
+  纹理图集 &operator=(const 纹理图集 &) = delete;
+
+private:
+  图集句柄 载入图片(std::string_view 路径);
+  图集区域 获取区域(图集句柄 句柄) const;
+  void 卸载图片(std::string_view 路径);
+  void 整理();
+  void 清空();
+  float 碎片率() const;
+
+  // 在现有页或新页中为图片分配位置并上传
+  bool 放置(图片 &目标);
+  bool 新建页();
+  void 上传(const 图片 &目标);
+};
+} // namespace 引擎::资源
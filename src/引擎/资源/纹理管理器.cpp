@@ -2,61 +2,151 @@
 #include "SDL3/SDL_render.h"
 #include "SDL3_image/SDL_image.h"
 #include "日志.hpp"
+#include <algorithm>
+#include <stdexcept>
 
 namespace 引擎::资源 {
+namespace {
+// 纹理显存占用的估算值
+std::size_t 估算纹理字节(const SDL_Texture *纹理) {
+  return static_cast<std::size_t>(纹理->w) * 纹理->h *
+         SDL_BYTESPERPIXEL(纹理->format);
+}
+} // namespace
 
-纹理管理器::纹理管理器(SDL_Renderer *渲染器) : _渲染器(渲染器) {
+纹理管理器::纹理管理器(SDL_Renderer *渲染器, 路径驻留表 &路径表)
+    : _路径表(路径表), _渲染器(渲染器) {
   if (!_渲染器) {
     throw std::runtime_error("纹理管理器初始化失败，渲染器为空");
   }
-  记录跟踪("纹理管理器初始化成功");
+
+  // 2x2 灰色棋盘格，载入完成前代替纹理显示
+  _占位纹理.reset(SDL_CreateTexture(_渲染器, SDL_PIXELFORMAT_RGBA32,
+                                    SDL_TEXTUREACCESS_STATIC, 2, 2));
+  if (!_占位纹理) {
+    throw std::runtime_error(std::string("纹理管理器初始化失败，无法创建占位纹理: ") +
+                             SDL_GetError());
+  }
+  const Uint8 像素[] = {0x80, 0x80, 0x80, 0xFF, 0xC0, 0xC0, 0xC0, 0xFF,
+                        0xC0, 0xC0, 0xC0, 0xFF, 0x80, 0x80, 0x80, 0xFF};
+  SDL_UpdateTexture(_占位纹理.get(), nullptr, 像素, 2 * 4);
+  SDL_SetTextureScaleMode(_占位纹理.get(), SDL_SCALEMODE_NEAREST);
+
+  // 解码线程数，留出核心给主线程和音频
+  const unsigned 线程数 =
+      std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+  for (unsigned i = 0; i < 线程数; ++i) {
+    _工作线程.emplace_back(&纹理管理器::工作线程循环, this);
+  }
+
+  记录跟踪("纹理管理器初始化成功，解码线程数: {}", 线程数);
 }
+
+纹理管理器::~纹理管理器() { 停止工作线程(); }
 SDL_Texture *纹理管理器::载入纹理(std::string_view 路径) {
   // 1. 检查路径有效性
   if (路径.empty()) {
     记录错误("纹理路径为空");
     return nullptr;
   }
+  return 载入纹理(_路径表.驻留(路径));
+}
+SDL_Texture *纹理管理器::获取纹理(std::string_view 路径) {
+  if (路径.empty()) {
+    记录错误("纹理路径为空");
+    return nullptr;
+  }
+  return 获取纹理(_路径表.驻留(路径));
+}
+
+glm::vec2 纹理管理器::获取纹理尺寸(std::string_view 路径) {
+  if (路径.empty()) {
+    记录错误("纹理路径为空");
+    return glm::vec2(0);
+  }
+  return 获取纹理尺寸(_路径表.驻留(路径));
+}
+void 纹理管理器::卸载纹理(std::string_view 路径) {
+  // 只查找，不为从未载入过的路径分配句柄
+  const auto 句柄 = _路径表.查找(路径);
+  if (句柄 && 句柄.序号 <= _纹理池.size() && _纹理池[句柄.序号 - 1].纹理) {
+    auto &项 = _纹理池[句柄.序号 - 1];
+    if (项.驻留.引用计数 > 0) {
+      记录警告("无法卸载仍被引用的纹理: {} (引用计数 {})", 路径,
+               项.驻留.引用计数);
+      return;
+    }
+    记录调试("卸载纹理: {}", 路径);
+    _预算.记录卸载(项.驻留);
+    // unique_ptr 通过自定义删除器处理删除，仍在解码的图片到达后被丢弃
+    项 = {};
+  } else {
+    记录警告("尝试卸载不存在的纹理: {}", 路径);
+  }
+}
+void 纹理管理器::清空纹理池() {
+  const auto 数量 = std::count_if(_纹理池.begin(), _纹理池.end(),
+                                  [](const 纹理项 &项) { return 项.纹理 != nullptr; });
+  if (数量 > 0) {
+    记录调试("正在清除所有 {} 个缓存的纹理。", 数量);
+  }
+  // 句柄仍然有效，回到未载入状态
+  _纹理池.clear(); // unique_ptr 处理所有元素的删除
+  _预算.清空();
+}
+
+SDL_Texture *纹理管理器::载入纹理(资源句柄 句柄) {
+  if (!_路径表.有效(句柄)) {
+    记录错误("无效的资源句柄: {}", 句柄.序号);
+    return nullptr;
+  }
 
-  // 3. 检查是否已缓存
-  auto it = _纹理池.find(std::string(路径));
-  if (it != _纹理池.end()) {
-    return it->second.get();
+  // 检查是否已缓存
+  auto &项 = 槽位(句柄);
+  if (项.纹理) {
+    _预算.使用(项.驻留);
+    return 项.纹理.get();
   }
 
-  // 4. 加载纹理
-  SDL_Texture *纹理 = IMG_LoadTexture(_渲染器, 路径.data());
+  // 加载纹理
+  const auto &路径 = _路径表.路径(句柄);
+  SDL_Texture *纹理 = IMG_LoadTexture(_渲染器, 路径.c_str());
   if (!纹理) {
     记录错误("加载纹理失败: {} (原因: {})", 路径, SDL_GetError());
     return nullptr;
   }
 
-  // 5. 设置纹理参数
+  // 设置纹理参数
   if (!SDL_SetTextureScaleMode(纹理, SDL_SCALEMODE_NEAREST)) {
     记录警告("无法设置纹理缩放模式: {}", SDL_GetError());
   }
 
-  // 6. 存入缓存
-  _纹理池.emplace(路径, std::unique_ptr<SDL_Texture, SDLTexture删除器>(纹理));
+  // 存入缓存
+  项.纹理.reset(纹理);
+  _预算.记录载入(项.驻留, 估算纹理字节(纹理));
 
   记录跟踪("成功加载并缓存纹理: {}", 路径);
   return 纹理;
 }
-SDL_Texture *纹理管理器::获取纹理(std::string_view 路径) {
-  if (路径.empty()) {
-    记录错误("纹理路径为空");
-    return nullptr;
-  }
 
-  // 查找现有纹理
-  auto it = _纹理池.find(std::string(路径));
-  if (it != _纹理池.end()) {
-    return it->second.get();
+SDL_Texture *纹理管理器::获取纹理(资源句柄 句柄) {
+  // 热路径：已载入时只是一次数组下标
+  if (句柄 && 句柄.序号 <= _纹理池.size()) {
+    auto &项 = _纹理池[句柄.序号 - 1];
+    if (项.纹理) {
+      _预算.使用(项.驻留);
+      return 项.纹理.get();
+    }
+  }
+  if (!_路径表.有效(句柄)) {
+    记录错误("无效的资源句柄: {}", 句柄.序号);
+    return nullptr;
   }
 
   // 如果未找到，尝试加载它
+  const auto &路径 = _路径表.路径(句柄);
   记录警告("纹理 '{}' 未找到缓存，尝试加载。", 路径);
-  auto 纹理 = 载入纹理(路径);
+  auto 纹理 = 载入纹理(句柄);
 
   // 检查加载是否成功
   if (!纹理) {
@@ -67,33 +157,243 @@ SDL_Texture *纹理管理器::获取纹理(std::string_view 路径) {
   return 纹理;
 }
 
-glm::vec2 纹理管理器::获取纹理尺寸(std::string_view 路径) {
+glm::vec2 纹理管理器::获取纹理尺寸(资源句柄 句柄) {
   // 获取纹理
-  SDL_Texture *纹理 = 获取纹理(路径);
+  SDL_Texture *纹理 = 获取纹理(句柄);
   if (!纹理) {
-    记录错误("无法获取纹理: {}", 路径);
+    记录错误("无法获取纹理: {}", 句柄.序号);
     return glm::vec2(0);
   }
 
-  // 2. 获取尺寸（正确用法）
+  // 获取尺寸
   float 宽度 = 0, 高度 = 0;
   SDL_GetTextureSize(纹理, &宽度, &高度);
 
   return glm::vec2(宽度, 高度);
 }
-void 纹理管理器::卸载纹理(std::string_view 路径) {
-  auto it = _纹理池.find(std::string(路径));
-  if (it != _纹理池.end()) {
-    记录调试("卸载纹理: {}", 路径);
-    _纹理池.erase(it); // unique_ptr 通过自定义删除器处理删除
-  } else {
-    记录警告("尝试卸载不存在的纹理: {}", 路径);
+
+异步纹理句柄 纹理管理器::异步载入纹理(std::string_view 路径) {
+  if (路径.empty()) {
+    记录错误("纹理路径为空");
+    return {};
   }
+
+  // 同一路径复用同一个句柄
+  const auto 句柄 = _路径表.驻留(路径);
+  排队解码(句柄);
+  return {句柄.序号};
 }
-void 纹理管理器::清空纹理池() {
-  if (!_纹理池.empty()) {
-    记录调试("正在清除所有 {} 个缓存的纹理。", _纹理池.size());
-    _纹理池.clear(); // unique_ptr 处理所有元素的删除
+
+SDL_Texture *纹理管理器::获取纹理(异步纹理句柄 句柄) {
+  if (!_路径表.有效(资源句柄{句柄.序号})) {
+    记录错误("无效的纹理句柄: {}", 句柄.序号);
+    return nullptr;
+  }
+
+  // 同步载入的纹理同样可用
+  const 资源句柄 路径句柄{句柄.序号};
+  auto &项 = 槽位(路径句柄);
+  if (项.纹理) {
+    _预算.使用(项.驻留);
+    return 项.纹理.get();
+  }
+
+  // 被淘汰或卸载后再次使用时重新载入
+  if (项.异步状态 == 载入状态::未载入) {
+    排队解码(路径句柄);
+  }
+  return _占位纹理.get();
+}
+
+glm::vec2 纹理管理器::获取纹理尺寸(异步纹理句柄 句柄) {
+  SDL_Texture *纹理 = 获取纹理(句柄);
+  if (!纹理) {
+    return glm::vec2(0);
+  }
+
+  float 宽度 = 0, 高度 = 0;
+  SDL_GetTextureSize(纹理, &宽度, &高度);
+
+  return glm::vec2(宽度, 高度);
+}
+
+bool 纹理管理器::纹理是否就绪(异步纹理句柄 句柄) const {
+  return 句柄 && 句柄.序号 <= _纹理池.size() &&
+         _纹理池[句柄.序号 - 1].纹理 != nullptr;
+}
+
+void 纹理管理器::处理上传() {
+  std::size_t 已上传字节 = 0;
+  while (已上传字节 < _每帧上传预算) {
+    解码结果 结果;
+    {
+      std::lock_guard 锁(_队列互斥);
+      if (_上传队列.empty()) {
+        break;
+      }
+      结果 = _上传队列.front();
+      _上传队列.pop_front();
+    }
+    _上传队列未满.notify_one();
+
+    const 资源句柄 句柄{结果.序号};
+    auto &项 = 槽位(句柄);
+
+    // 解码期间纹理被卸载，或者已经被同步载入
+    if (项.异步状态 != 载入状态::排队中 || 项.纹理) {
+      项.异步状态 = 载入状态::未载入;
+      SDL_DestroySurface(结果.表面);
+      continue;
+    }
+
+    if (!结果.表面) {
+      项.异步状态 = 载入状态::失败;
+      continue;
+    }
+
+    已上传字节 += static_cast<std::size_t>(结果.表面->pitch) * 结果.表面->h;
+
+    SDL_Texture *纹理 = SDL_CreateTextureFromSurface(_渲染器, 结果.表面);
+    SDL_DestroySurface(结果.表面);
+    if (!纹理) {
+      记录错误("上传纹理失败: {} (原因: {})", _路径表.路径(句柄),
+               SDL_GetError());
+      项.异步状态 = 载入状态::失败;
+      continue;
+    }
+    if (!SDL_SetTextureScaleMode(纹理, SDL_SCALEMODE_NEAREST)) {
+      记录警告("无法设置纹理缩放模式: {}", SDL_GetError());
+    }
+
+    项.纹理.reset(纹理);
+    项.异步状态 = 载入状态::未载入;
+    _预算.记录载入(项.驻留, 估算纹理字节(纹理));
+    记录跟踪("成功异步加载并缓存纹理: {}", _路径表.路径(句柄));
+  }
+}
+
+void 纹理管理器::设置每帧上传预算(std::size_t 字节数) {
+  _每帧上传预算 = 字节数;
+}
+
+bool 纹理管理器::增加引用(资源句柄 句柄) {
+  if (!载入纹理(句柄)) {
+    return false;
+  }
+  槽位(句柄).驻留.引用计数 += 1;
+  return true;
+}
+
+void 纹理管理器::减少引用(资源句柄 句柄) {
+  if (!句柄 || 句柄.序号 > _纹理池.size() ||
+      _纹理池[句柄.序号 - 1].驻留.引用计数 == 0) {
+    记录警告("释放未被引用的纹理: {}", 句柄.序号);
+    return;
+  }
+  _纹理池[句柄.序号 - 1].驻留.引用计数 -= 1;
+}
+
+void 纹理管理器::回收() {
+  if (!_预算.超出预算()) {
+    return;
+  }
+
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> 候选;
+  for (std::uint32_t i = 0; i < _纹理池.size(); ++i) {
+    const auto &项 = _纹理池[i];
+    if (项.纹理 && 项.驻留.引用计数 == 0) {
+      候选.emplace_back(项.驻留.最近使用, i);
+    }
+  }
+
+  const auto 淘汰前 = _预算.获取统计().淘汰数量;
+  _预算.淘汰(
+      候选, [this](std::uint32_t i) -> 驻留信息 & { return _纹理池[i].驻留; },
+      [this](std::uint32_t i) { _纹理池[i].纹理.reset(); });
+  if (const auto 数量 = _预算.获取统计().淘汰数量 - 淘汰前; 数量 > 0) {
+    记录调试("纹理超出预算，淘汰 {} 个，驻留 {} 字节", 数量,
+             _预算.获取统计().驻留字节);
+  }
+}
+
+void 纹理管理器::设置预算(std::size_t 字节数) { _预算.设置预算(字节数); }
+
+const 资源池统计 &纹理管理器::获取统计() const { return _预算.获取统计(); }
+
+void 纹理管理器::排队解码(资源句柄 句柄) {
+  auto &项 = 槽位(句柄);
+  if (项.纹理 || 项.异步状态 == 载入状态::排队中) {
+    return;
+  }
+
+  项.异步状态 = 载入状态::排队中;
+  {
+    std::lock_guard 锁(_队列互斥);
+    _解码队列.push_back({句柄.序号, _路径表.路径(句柄)});
+  }
+  _有解码任务.notify_one();
+
+  记录跟踪("纹理加入解码队列: {}", _路径表.路径(句柄));
+}
+
+void 纹理管理器::工作线程循环() {
+  while (true) {
+    解码任务 任务;
+    {
+      std::unique_lock 锁(_队列互斥);
+      _有解码任务.wait(锁, [this] { return _停止 || !_解码队列.empty(); });
+      if (_停止) {
+        return;
+      }
+      任务 = std::move(_解码队列.front());
+      _解码队列.pop_front();
+    }
+
+    // 只解码到内存，纹理必须在主线程创建
+    SDL_Surface *表面 = IMG_Load(任务.路径.c_str());
+    if (!表面) {
+      记录错误("解码纹理失败: {} (原因: {})", 任务.路径, SDL_GetError());
+    }
+
+    // 上传队列已满时等待，避免解码结果在内存中堆积
+    std::unique_lock 锁(_队列互斥);
+    _上传队列未满.wait(
+        锁, [this] { return _停止 || _上传队列.size() < 上传队列容量; });
+    if (_停止) {
+      SDL_DestroySurface(表面);
+      return;
+    }
+    _上传队列.push_back({任务.序号, 表面});
+  }
+}
+
+void 纹理管理器::停止工作线程() {
+  {
+    std::lock_guard 锁(_队列互斥);
+    _停止 = true;
+  }
+  _有解码任务.notify_all();
+  _上传队列未满.notify_all();
+
+  for (auto &线程 : _工作线程) {
+    if (线程.joinable()) {
+      线程.join();
+    }
+  }
+  _工作线程.clear();
+
+  // 释放尚未上传的解码结果
+  for (auto &结果 : _上传队列) {
+    SDL_DestroySurface(结果.表面);
+  }
+  _上传队列.clear();
+  _解码队列.clear();
+}
+
+纹理管理器::纹理项 &纹理管理器::槽位(资源句柄 句柄) {
+  if (句柄.序号 > _纹理池.size()) {
+    _纹理池.resize(句柄.序号);
   }
+  return _纹理池[句柄.序号 - 1];
 }
-} // namespace 引擎::资源
\ No newline at end of file
+} // namespace 引擎::资源
@@ -1,14 +1,29 @@
+#pragma once
 #include "SDL3/SDL.h"
 #include "glm/ext/vector_float2.hpp"
+#include "纹理句柄.hpp"
+#include "资源句柄.hpp"
+#include "资源预算.hpp"
 #include "日志.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace 引擎::资源 {
+
 /**
  * @brief 管理 SDL_Texture 资源的加载、存储和检索。
  *
  * 在构造时初始化。使用文件路径作为键，确保纹理只加载一次并正确释放。
  * 依赖于一个有效的 SDL_Renderer，构造失败会抛出异常。
+ *
+ * 异步载入时，图片在工作线程中解码为 SDL_Surface，放入有界的上传队列，
+ * 再由主线程在 处理上传() 中按每帧预算创建纹理，解码不会阻塞渲染帧。
  */
 class 纹理管理器 final {
   friend class 资源管理器;
@@ -22,16 +37,55 @@ private:
       }
     }
   };
-  // 存储文件路径和指向管理纹理的 unique_ptr
-  // 的映射。(容器的键不可使用std::string_view)
-  std::unordered_map<std::string,
-                     std::unique_ptr<SDL_Texture, SDLTexture删除器>>
-      _纹理池;
+
+  enum class 载入状态 : std::uint8_t { 未载入, 排队中, 失败 };
+
+  struct 纹理项 {
+    std::unique_ptr<SDL_Texture, SDLTexture删除器> 纹理;
+    载入状态 异步状态 = 载入状态::未载入; // 只在主线程访问
+    驻留信息 驻留;
+  };
+
+  struct 解码任务 {
+    std::uint32_t 序号 = 0;
+    std::string 路径;
+  };
+
+  struct 解码结果 {
+    std::uint32_t 序号 = 0;
+    SDL_Surface *表面 = nullptr; // 解码失败时为空
+  };
+
+  // 按 资源句柄 存储纹理，句柄序号减一即为下标，按需扩展
+  std::vector<纹理项> _纹理池;
+  路径驻留表 &_路径表; // 由 资源管理器 持有，各管理器共享
 
   SDL_Renderer *_渲染器; // 指向主渲染器
 
+  // 载入完成前显示的纹理
+  std::unique_ptr<SDL_Texture, SDLTexture删除器> _占位纹理;
+
+  // 驻留字节按 宽 × 高 × 每像素字节数 估算
+  资源预算 _预算{512 * 1024 * 1024};
+
+  // 工作线程共享的队列，由 _队列互斥 保护
+  std::mutex _队列互斥;
+  std::condition_variable _有解码任务;
+  std::condition_variable _上传队列未满;
+  std::deque<解码任务> _解码队列;
+  std::deque<解码结果> _上传队列;
+  bool _停止 = false;
+
+  std::vector<std::thread> _工作线程;
+
+  // 上传队列容量，限制同时驻留在内存中的已解码图片数量
+  static constexpr std::size_t 上传队列容量 = 32;
+  // 每帧最多上传的像素字节数，至少上传一张
+  std::size_t _每帧上传预算 = 8 * 1024 * 1024;
+
 public:
-  explicit 纹理管理器(SDL_Renderer *渲染器);
+  纹理管理器(SDL_Renderer *渲染器, 路径驻留表 &路径表);
+  ~纹理管理器();
 
   纹理管理器(纹理管理器 &&) = delete;
   纹理管理器(const 纹理管理器 &) = delete;
@@ -45,5 +99,31 @@ private:
   glm::vec2 获取纹理尺寸(std::string_view);
   void 卸载纹理(std::string_view);
   void 清空纹理池();
+
+  // 按句柄访问，只做数组下标
+  SDL_Texture *载入纹理(资源句柄);
+  SDL_Texture *获取纹理(资源句柄);
+  glm::vec2 获取纹理尺寸(资源句柄);
+
+  // 异步载入，句柄与路径的 资源句柄 序号相同
+  异步纹理句柄 异步载入纹理(std::string_view);
+  SDL_Texture *获取纹理(异步纹理句柄);
+  glm::vec2 获取纹理尺寸(异步纹理句柄);
+  bool 纹理是否就绪(异步纹理句柄) const;
+  void 处理上传();
+  void 设置每帧上传预算(std::size_t 字节数);
+
+  // 引用计数大于 0 的纹理不会被淘汰，未载入时先载入
+  bool 增加引用(资源句柄);
+  void 减少引用(资源句柄);
+  // 超出预算时按最久未使用淘汰未被引用的纹理
+  void 回收();
+  void 设置预算(std::size_t 字节数);
+  const 资源池统计 &获取统计() const;
+
+  void 排队解码(资源句柄 句柄);
+  void 工作线程循环();
+  void 停止工作线程();
+  纹理项 &槽位(资源句柄 句柄);
 };
 } // namespace 引擎::资源
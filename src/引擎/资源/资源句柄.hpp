@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <functional>    // 用于 std::hash, std::equal_to
+#include <string>        // 用于 std::string
+#include <string_view>   // 用于 std::string_view
+#include <unordered_map> // 用于 std::unordered_map
+#include <vector>        // 用于 std::vector
+
+namespace 引擎::资源 {
+
+/**
+ * @brief 支持用 std::string_view 直接查找的字符串哈希。
+ *
+ * 配合 std::equal_to<> 使用时，unordered_map::find 不需要先构造
+ * std::string，查找不会分配内存。
+ */
+struct 字符串哈希 {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view 文本) const noexcept {
+    return std::hash<std::string_view>{}(文本);
+  }
+};
+
+// 以路径为键、可用 std::string_view 查找的映射
+template <typename 值>
+using 字符串映射 =
+    std::unordered_map<std::string, 值, 字符串哈希, std::equal_to<>>;
+
+/**
+ * @brief 驻留后的资源路径，32 位下标。
+ *
+ * 由 路径驻留表 为每个路径生成一次，之后各管理器用它直接索引
+ * 密集数组，不再对完整路径求哈希。值为 0 表示无效句柄。
+ */
+struct 资源句柄 {
+  std::uint32_t 序号 = 0;
+
+  explicit operator bool() const { return 序号 != 0; }
+  bool operator==(const 资源句柄 &) const = default;
+};
+
+/**
+ * @brief 把路径映射为 资源句柄，同一路径总是得到同一个句柄。
+ *
+ * 句柄在表的生命周期内一直有效，路径不会被移除。只在主线程访问。
+ */
+class 路径驻留表 final {
+private:
+  std::vector<std::string> _路径; // 句柄序号减一即为下标
+  字符串映射<std::uint32_t> _序号;
+
+public:
+  // 返回路径的句柄，第一次出现时分配新句柄
+  资源句柄 驻留(std::string_view 路径) {
+    auto it = _序号.find(路径);
+    if (it != _序号.end()) {
+      return {it->second};
+    }
+    _路径.emplace_back(路径);
+    const auto 序号 = static_cast<std::uint32_t>(_路径.size());
+    _序号.emplace(路径, 序号);
+    return {序号};
+  }
+
+  // 只查找不分配，路径未出现过时返回无效句柄
+  资源句柄 查找(std::string_view 路径) const {
+    auto it = _序号.find(路径);
+    return it != _序号.end() ? 资源句柄{it->second} : 资源句柄{};
+  }
+
+  // 句柄对应的路径，以空字符结尾，可直接传给 SDL
+  const std::string &路径(资源句柄 句柄) const { return _路径[句柄.序号 - 1]; }
+
+  bool 有效(资源句柄 句柄) const {
+    return 句柄 && 句柄.序号 <= _路径.size();
+  }
+
+  std::size_t 数量() const { return _路径.size(); }
+};
+
+} // namespace 引擎::资源
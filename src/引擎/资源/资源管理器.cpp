@@ -1,6 +1,7 @@
 #include "资源管理器.hpp"
 #include "字体管理器.hpp"
 #include "日志.hpp"
+#include "纹理图集.hpp"
 #include "纹理管理器.hpp"
 #include "音频管理器.hpp"
 #include <SDL3_mixer/SDL_mixer.h>
@@ -14,9 +15,10 @@ namespace 引擎::资源 {
 
 资源管理器::资源管理器(SDL_Renderer *渲染器) {
   // --- 初始化各个子系统 --- (如果出现错误会抛出异常，由上层捕获)
-  _纹理管理器 = std::make_unique<纹理管理器>(渲染器);
-  _音频管理器 = std::make_unique<音频管理器>();
-  _字体管理器 = std::make_unique<字体管理器>();
+  _纹理管理器 = std::make_unique<纹理管理器>(渲染器, _路径表);
+  _纹理图集 = std::make_unique<纹理图集>(渲染器);
+  _音频管理器 = std::make_unique<音频管理器>(_路径表);
+  _字体管理器 = std::make_unique<字体管理器>(_路径表);
 
   记录跟踪("资源管理器 构造成功。");
   // RAII:
@@ -27,9 +29,42 @@ void 资源管理器::清空资源() {
   _字体管理器->清空字体池();
   // _音频管理器->清空音频池();
   _纹理管理器->清空纹理池();
+  _纹理图集->清空();
   记录跟踪("资源管理器 中的资源通过 clear() 清空。");
 }
 
+void 资源管理器::回收资源() {
+  _纹理管理器->回收();
+  _音频管理器->回收();
+  _字体管理器->回收();
+}
+
+void 资源管理器::设置内存预算(资源池 池, std::size_t 字节数) {
+  switch (池) {
+  case 资源池::纹理:
+    _纹理管理器->设置预算(字节数);
+    break;
+  case 资源池::音效:
+    _音频管理器->设置音效预算(字节数);
+    break;
+  case 资源池::音乐:
+    _音频管理器->设置音乐预算(字节数);
+    break;
+  case 资源池::字体:
+    _字体管理器->设置预算(字节数);
+    break;
+  }
+}
+
+资源统计 资源管理器::获取资源统计() const {
+  return {_纹理管理器->获取统计(), _音频管理器->获取音效统计(),
+          _音频管理器->获取音乐统计(), _字体管理器->获取统计()};
+}
+
+资源句柄 资源管理器::获取句柄(std::string_view 文件路径) {
+  return _路径表.驻留(文件路径);
+}
+
 // --- 纹理接口实现 ---
 SDL_Texture *资源管理器::载入纹理(std::string_view 文件路径) {
   // 构造函数已经确保了 _纹理管理器
@@ -51,6 +86,60 @@ void 资源管理器::卸载纹理(std::string_view 文件路径) {
 
 void 资源管理器::清空纹理池() { _纹理管理器->清空纹理池(); }
 
+SDL_Texture *资源管理器::获取纹理(资源句柄 句柄) {
+  return _纹理管理器->获取纹理(句柄);
+}
+
+glm::vec2 资源管理器::获取纹理尺寸(资源句柄 句柄) {
+  return _纹理管理器->获取纹理尺寸(句柄);
+}
+
+资源句柄 资源管理器::持有纹理(std::string_view 文件路径) {
+  const auto 句柄 = _路径表.驻留(文件路径);
+  return _纹理管理器->增加引用(句柄) ? 句柄 : 资源句柄{};
+}
+
+void 资源管理器::释放纹理(资源句柄 句柄) { _纹理管理器->减少引用(句柄); }
+
+异步纹理句柄 资源管理器::异步载入纹理(std::string_view 文件路径) {
+  return _纹理管理器->异步载入纹理(文件路径);
+}
+
+SDL_Texture *资源管理器::获取纹理(异步纹理句柄 句柄) {
+  return _纹理管理器->获取纹理(句柄);
+}
+
+glm::vec2 资源管理器::获取纹理尺寸(异步纹理句柄 句柄) {
+  return _纹理管理器->获取纹理尺寸(句柄);
+}
+
+bool 资源管理器::纹理是否就绪(异步纹理句柄 句柄) const {
+  return _纹理管理器->纹理是否就绪(句柄);
+}
+
+void 资源管理器::处理纹理上传() { _纹理管理器->处理上传(); }
+
+void 资源管理器::设置每帧纹理上传预算(std::size_t 字节数) {
+  _纹理管理器->设置每帧上传预算(字节数);
+}
+
+// --- 图集接口实现 ---
+图集句柄 资源管理器::载入图集图片(std::string_view 文件路径) {
+  return _纹理图集->载入图片(文件路径);
+}
+
+图集区域 资源管理器::获取图集区域(图集句柄 句柄) const {
+  return _纹理图集->获取区域(句柄);
+}
+
+void 资源管理器::卸载图集图片(std::string_view 文件路径) {
+  _纹理图集->卸载图片(文件路径);
+}
+
+void 资源管理器::整理图集() { _纹理图集->整理(); }
+
+void 资源管理器::清空图集() { _纹理图集->清空(); }
+
 // --- 音频接口实现 ---
 Mix_Chunk *资源管理器::载入音效(std::string_view 文件路径) {
   return _音频管理器->载入音效(文件路径);
@@ -66,6 +155,17 @@ void 资源管理器::卸载音效(std::string_view 文件路径) {
 
 void 资源管理器::清空音效池() { _音频管理器->清空音效池(); }
 
+Mix_Chunk *资源管理器::获取音效(资源句柄 句柄) {
+  return _音频管理器->获取音效(句柄);
+}
+
+资源句柄 资源管理器::持有音效(std::string_view 文件路径) {
+  const auto 句柄 = _路径表.驻留(文件路径);
+  return _音频管理器->增加音效引用(句柄) ? 句柄 : 资源句柄{};
+}
+
+void 资源管理器::释放音效(资源句柄 句柄) { _音频管理器->减少音效引用(句柄); }
+
 Mix_Music *资源管理器::载入音乐(std::string_view 文件路径) {
   return _音频管理器->载入音乐(文件路径);
 }
@@ -80,6 +180,21 @@ void 资源管理器::卸载音乐(std::string_view 文件路径) {
 
 void 资源管理器::清空音乐池() { _音频管理器->清空音乐池(); }
 
+Mix_Music *资源管理器::获取音乐(资源句柄 句柄) {
+  return _音频管理器->获取音乐(句柄);
+}
+
+资源句柄 资源管理器::持有音乐(std::string_view 文件路径) {
+  const auto 句柄 = _路径表.驻留(文件路径);
+  return _音频管理器->增加音乐引用(句柄) ? 句柄 : 资源句柄{};
+}
+
+void 资源管理器::释放音乐(资源句柄 句柄) { _音频管理器->减少音乐引用(句柄); }
+
+bool 资源管理器::播放音乐(std::string_view 文件路径, int 循环次数) {
+  return _音频管理器->播放音乐(_路径表.驻留(文件路径), 循环次数);
+}
+
 // --- 字体接口实现 ---
 TTF_Font *资源管理器::载入字体(std::string_view 文件路径, int 字号大小) {
   return _字体管理器->载入字体(文件路径, 字号大小);
@@ -95,4 +210,17 @@ void 资源管理器::卸载字体(std::string_view 文件路径, int 字号大
 
 void 资源管理器::清空字体池() { _字体管理器->清空字体池(); }
 
+TTF_Font *资源管理器::获取字体(资源句柄 句柄, int 字号大小) {
+  return _字体管理器->获取字体(句柄, 字号大小);
+}
+
+资源句柄 资源管理器::持有字体(std::string_view 文件路径, int 字号大小) {
+  const auto 句柄 = _路径表.驻留(文件路径);
+  return _字体管理器->增加引用(句柄, 字号大小) ? 句柄 : 资源句柄{};
+}
+
+void 资源管理器::释放字体(资源句柄 句柄, int 字号大小) {
+  _字体管理器->减少引用(句柄, 字号大小);
+}
+
 } // namespace 引擎::资源
\ No newline at end of file
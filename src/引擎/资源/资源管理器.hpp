@@ -1,4 +1,8 @@
 #include "glm/ext/vector_float2.hpp"
+#include "纹理句柄.hpp"
+#include "资源句柄.hpp"
+#include "资源预算.hpp"
+#include <cstddef>
 #include <string_view>
 // #include "glm/glm.hpp"
 #include <memory>
@@ -13,6 +17,7 @@ struct TTF_Font;
 namespace 引擎::资源 {
 // 前向声明内部管理器
 class 纹理管理器;
+class 纹理图集;
 class 音频管理器;
 class 字体管理器;
 
@@ -22,7 +27,10 @@ class 字体管理器;
  */
 class 资源管理器 {
 private:
+  // 所有子管理器共享，必须最先构造、最后销毁
+  路径驻留表 _路径表;
   std::unique_ptr<纹理管理器> _纹理管理器;
+  std::unique_ptr<纹理图集> _纹理图集;
   std::unique_ptr<音频管理器> _音频管理器;
   std::unique_ptr<字体管理器> _字体管理器;
 
@@ -34,6 +42,12 @@ public:
 
   void 清空资源(); // 清空所有资源
 
+  // 每帧开始时调用一次，超出预算的资源池按最久未使用淘汰未被持有的资源。
+  // 上一帧取得的裸指针此时已经绘制完毕；需要跨帧使用的资源请先持有。
+  void 回收资源();
+  void 设置内存预算(资源池 池, std::size_t 字节数); // 0 表示不限制
+  资源统计 获取资源统计() const;
+
   资源管理器(const 资源管理器 &) = delete;
   资源管理器 &operator=(const 资源管理器 &) = delete;
   资源管理器(资源管理器 &&) = delete;
@@ -41,30 +55,65 @@ public:
 
   // 统一资源访问
 
+  // 为路径生成句柄（每个路径只生成一次），之后按句柄访问只需数组下标
+  资源句柄 获取句柄(std::string_view 文件路径);
+
   // 获取纹理
   SDL_Texture *载入纹理(std::string_view 文件路径);
   SDL_Texture *获取纹理(std::string_view 文件路径);
   void 卸载纹理(std::string_view 文件路径);
   glm::vec2 获取纹理尺寸(std::string_view 文件路径);
   void 清空纹理池();
+  SDL_Texture *获取纹理(资源句柄 句柄);
+  glm::vec2 获取纹理尺寸(资源句柄 句柄);
+  // 载入并增加引用计数，被持有的纹理不会被淘汰，也不能被卸载，失败时返回无效句柄
+  资源句柄 持有纹理(std::string_view 文件路径);
+  void 释放纹理(资源句柄 句柄);
+
+  // 异步载入纹理，立即返回句柄，完成前获取到的是占位纹理
+  异步纹理句柄 异步载入纹理(std::string_view 文件路径);
+  SDL_Texture *获取纹理(异步纹理句柄 句柄);
+  glm::vec2 获取纹理尺寸(异步纹理句柄 句柄);
+  bool 纹理是否就绪(异步纹理句柄 句柄) const;
+  // 在主线程每帧调用，把解码完成的图片按预算上传为纹理
+  void 处理纹理上传();
+  void 设置每帧纹理上传预算(std::size_t 字节数);
+
+  // 图集：小图片合并到共享的纹理页中，绘制时通过句柄取得纹理和 UV
+  图集句柄 载入图集图片(std::string_view 文件路径);
+  图集区域 获取图集区域(图集句柄 句柄) const;
+  void 卸载图集图片(std::string_view 文件路径);
+  void 整理图集(); // 立即重排，去掉卸载留下的空洞
+  void 清空图集();
 
   // 获取音效
   Mix_Chunk *载入音效(std::string_view 文件路径);
   Mix_Chunk *获取音效(std::string_view 文件路径);
   void 卸载音效(std::string_view 文件路径);
   void 清空音效池();
+  Mix_Chunk *获取音效(资源句柄 句柄);
+  资源句柄 持有音效(std::string_view 文件路径);
+  void 释放音效(资源句柄 句柄);
 
   // 获取音乐
   Mix_Music *载入音乐(std::string_view 文件路径);
   Mix_Music *获取音乐(std::string_view 文件路径);
   void 卸载音乐(std::string_view 文件路径);
   void 清空音乐池();
+  Mix_Music *获取音乐(资源句柄 句柄);
+  资源句柄 持有音乐(std::string_view 文件路径); // 播放期间应当持有
+  void 释放音乐(资源句柄 句柄);
+  // 经此播放的音乐在播放期间不会被回收
+  bool 播放音乐(std::string_view 文件路径, int 循环次数 = -1);
 
   // 获取字体
   TTF_Font *载入字体(std::string_view 文件路径, int 字体大小);
   TTF_Font *获取字体(std::string_view 文件路径, int 字体大小);
   void 卸载字体(std::string_view 文件路径, int 字体大小);
   void 清空字体池();
+  TTF_Font *获取字体(资源句柄 句柄, int 字体大小);
+  资源句柄 持有字体(std::string_view 文件路径, int 字体大小);
+  void 释放字体(资源句柄 句柄, int 字体大小);
 };
 
 } // namespace 引擎::资源
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "资源预算.hpp"
+#include "SDL3/SDL.h"
+
+namespace 引擎::资源 {
+
+void 资源预算::记录载入(驻留信息 &信息, std::size_t 字节数) {
+  信息.字节数 = 字节数;
+  _统计.驻留字节 += 字节数;
+  _统计.驻留数量 += 1;
+  使用(信息);
+}
+
+void 资源预算::记录卸载(驻留信息 &信息) {
+  _统计.驻留字节 -= 信息.字节数;
+  _统计.驻留数量 -= 1;
+  // 引用计数属于持有者，不随资源一起清除
+  信息.字节数 = 0;
+  信息.最近使用 = 0;
+}
+
+void 资源预算::清空() {
+  // 淘汰统计保留，反映整个运行期间的情况
+  _统计.驻留字节 = 0;
+  _统计.驻留数量 = 0;
+}
+
+std::size_t 估算文件字节(const std::string &路径) {
+  SDL_PathInfo 信息;
+  if (!SDL_GetPathInfo(路径.c_str(), &信息)) {
+    return 0;
+  }
+  return static_cast<std::size_t>(信息.size);
+}
+
+} // namespace 引擎::资源
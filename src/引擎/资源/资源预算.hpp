@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm> // 用于 std::sort
+#include <cstddef>   // 用于 std::size_t
+#include <cstdint>   // 用于 std::uint32_t, std::uint64_t
+#include <string>    // 用于 std::string
+#include <utility>   // 用于 std::pair
+#include <vector>    // 用于 std::vector
+
+namespace 引擎::资源 {
+
+// 可以分别设置预算的资源池
+enum class 资源池 { 纹理, 音效, 音乐, 字体 };
+
+/**
+ * @brief 一个资源池的内存占用统计。
+ */
+struct 资源池统计 {
+  std::size_t 驻留字节 = 0; // 估算值，见各管理器
+  std::size_t 驻留数量 = 0;
+  std::size_t 预算字节 = 0; // 0 表示不限制
+  std::uint64_t 淘汰数量 = 0;
+  std::uint64_t 淘汰字节 = 0;
+};
+
+// 所有资源池的统计
+struct 资源统计 {
+  资源池统计 纹理;
+  资源池统计 音效;
+  资源池统计 音乐;
+  资源池统计 字体;
+};
+
+// 每个已载入资源的记账信息，和资源存放在同一个槽位中
+struct 驻留信息 {
+  std::size_t 字节数 = 0;
+  std::uint32_t 引用计数 = 0; // 大于 0 时不会被淘汰
+  std::uint64_t 最近使用 = 0; // 资源预算 内部时钟，越大越新
+};
+
+/**
+ * @brief 记录一个资源池的驻留字节和最近使用顺序，超出预算时按 LRU 淘汰。
+ *
+ * 只负责记账和选出淘汰对象，释放资源由所属管理器完成。
+ * 淘汰只在 回收() 中进行，由 资源管理器 每帧调用一次，
+ * 因此同一帧内取得的裸指针在绘制结束前一直有效。
+ */
+class 资源预算 final {
+private:
+  资源池统计 _统计;
+  std::uint64_t _时钟 = 0;
+
+public:
+  explicit 资源预算(std::size_t 预算字节) { _统计.预算字节 = 预算字节; }
+
+  void 设置预算(std::size_t 预算字节) { _统计.预算字节 = 预算字节; }
+  const 资源池统计 &获取统计() const { return _统计; }
+
+  bool 超出预算() const {
+    return _统计.预算字节 != 0 && _统计.驻留字节 > _统计.预算字节;
+  }
+
+  void 使用(驻留信息 &信息) { 信息.最近使用 = ++_时钟; }
+  void 记录载入(驻留信息 &信息, std::size_t 字节数);
+  // 资源被显式卸载或清空时调用，不计入淘汰，引用计数保持不变
+  void 记录卸载(驻留信息 &信息);
+  void 清空();
+
+  /**
+   * @brief 从候选中按最久未使用的顺序淘汰，直到回到预算以内。
+   * @param 候选 (最近使用, 键) 列表，只应包含引用计数为 0 的资源。
+   * @param 查找信息 返回键对应的 驻留信息。
+   * @param 淘汰一个 释放键对应的资源，调用前已经完成记账。
+   */
+  template <typename 键, typename 查找函数, typename 淘汰函数>
+  void 淘汰(std::vector<std::pair<std::uint64_t, 键>> &候选,
+            查找函数 &&查找信息, 淘汰函数 &&淘汰一个) {
+    std::sort(候选.begin(), 候选.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (const auto &[最近使用, 当前键] : 候选) {
+      if (!超出预算()) {
+        break;
+      }
+      auto &信息 = 查找信息(当前键);
+      _统计.淘汰数量 += 1;
+      _统计.淘汰字节 += 信息.字节数;
+      记录卸载(信息);
+      淘汰一个(当前键);
+    }
+  }
+};
+
+// 文件大小，用于估算无法直接查询内存占用的资源（音乐、字体）
+std::size_t 估算文件字节(const std::string &路径);
+
+} // namespace 引擎::资源
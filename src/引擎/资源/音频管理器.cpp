@@ -1,9 +1,76 @@
 #include "音频管理器.hpp"
 #include "SDL3_mixer/SDL_mixer.h"
 #include "日志.hpp"
+#include <algorithm>
 
 namespace 引擎::资源 {
-音频管理器::音频管理器() {
+namespace {
+// 池中按句柄取得槽位，不够时扩展
+template <typename 项>
+项 &取槽位(std::vector<项> &池, 资源句柄 句柄) {
+  if (句柄.序号 > 池.size()) {
+    池.resize(句柄.序号);
+  }
+  return 池[句柄.序号 - 1];
+}
+
+// 句柄无效或未载入时返回空
+template <typename 项> 项 *已载入槽位(std::vector<项> &池, 资源句柄 句柄) {
+  if (!句柄 || 句柄.序号 > 池.size() || !池[句柄.序号 - 1].资源) {
+    return nullptr;
+  }
+  return &池[句柄.序号 - 1];
+}
+
+// 显式卸载，仍被引用的资源保留，返回是否已卸载
+template <typename 项>
+bool 卸载槽位(项 &槽位, 资源预算 &预算, std::string_view 路径) {
+  if (槽位.驻留.引用计数 > 0) {
+    记录警告("无法卸载仍被引用的音频: {} (引用计数 {})", 路径,
+             槽位.驻留.引用计数);
+    return false;
+  }
+  记录调试("卸载音频: {}", 路径);
+  预算.记录卸载(槽位.驻留);
+  槽位.资源.reset();
+  return true;
+}
+
+template <typename 项> void 减少引用(std::vector<项> &池, 资源句柄 句柄) {
+  auto *槽位 = 已载入槽位(池, 句柄);
+  if (!槽位 || 槽位->驻留.引用计数 == 0) {
+    记录警告("释放未被引用的音频: {}", 句柄.序号);
+    return;
+  }
+  槽位->驻留.引用计数 -= 1;
+}
+
+// 超出预算时按最久未使用淘汰未被引用且没有在播放的资源
+template <typename 项, typename 资源类型>
+void 回收池(std::vector<项> &池, 资源预算 &预算,
+            const std::vector<资源类型 *> &播放中) {
+  if (!预算.超出预算()) {
+    return;
+  }
+
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> 候选;
+  for (std::uint32_t i = 0; i < 池.size(); ++i) {
+    if (!池[i].资源 || 池[i].驻留.引用计数 > 0) {
+      continue;
+    }
+    if (std::find(播放中.begin(), 播放中.end(), 池[i].资源.get()) !=
+        播放中.end()) {
+      continue;
+    }
+    候选.emplace_back(池[i].驻留.最近使用, i);
+  }
+  预算.淘汰(
+      候选, [&池](std::uint32_t i) -> 驻留信息 & { return 池[i].驻留; },
+      [&池](std::uint32_t i) { 池[i].资源.reset(); });
+}
+} // namespace
+
+音频管理器::音频管理器(路径驻留表 &路径表) : _路径表(路径表) {
   // 使用所需的格式初始化SDL_mixer（推荐OGG、MP3）
   MIX_InitFlags 标志 = MIX_INIT_OGG | MIX_INIT_MP3;
   if ((Mix_Init(标志) & 标志) != 标志) {
@@ -40,99 +107,210 @@ namespace 引擎::资源 {
 
 // --- 音效管理 ---
 Mix_Chunk *音频管理器::载入音效(std::string_view 路径) {
+  return 载入音效(_路径表.驻留(路径));
+}
+
+Mix_Chunk *音频管理器::载入音效(资源句柄 句柄) {
+  if (!_路径表.有效(句柄)) {
+    记录错误("无效的资源句柄: {}", 句柄.序号);
+    return nullptr;
+  }
+
   // 首先检查缓存
-  auto it = _音效池.find(std::string(路径));
-  if (it != _音效池.end()) {
-    return it->second.get();
+  auto &槽位 = 取槽位(_音效池, 句柄);
+  if (槽位.资源) {
+    _音效预算.使用(槽位.驻留);
+    return 槽位.资源.get();
   }
 
   // 加载音效块
-  auto 原始音效 = Mix_LoadWAV(路径.data());
+  const auto &路径 = _路径表.路径(句柄);
+  auto 原始音效 = Mix_LoadWAV(路径.c_str());
   if (!原始音效) {
     记录错误("加载音效失败: '{}': {}", 路径, SDL_GetError());
     return nullptr;
   }
 
   // 使用unique_ptr存储在缓存中
-  _音效池.emplace(路径,
-                  std::unique_ptr<Mix_Chunk, SDLMixChunk删除器>(原始音效));
+  槽位.资源.reset(原始音效);
+  _音效预算.记录载入(槽位.驻留, 原始音效->alen);
   记录调试("成功加载并缓存音效: {}", 路径);
   return 原始音效;
 }
 
 Mix_Chunk *音频管理器::获取音效(std::string_view 路径) {
-  auto it = _音效池.find(std::string(路径));
-  if (it != _音效池.end()) {
-    return it->second.get();
+  return 获取音效(_路径表.驻留(路径));
+}
+
+Mix_Chunk *音频管理器::获取音效(资源句柄 句柄) {
+  if (auto *槽位 = 已载入槽位(_音效池, 句柄)) {
+    _音效预算.使用(槽位->驻留);
+    return 槽位->资源.get();
   }
-  记录警告("音效 '{}' 未找到缓存，尝试加载。", 路径);
-  return 载入音效(路径);
+  if (_路径表.有效(句柄)) {
+    记录警告("音效 '{}' 未找到缓存，尝试加载。", _路径表.路径(句柄));
+  }
+  return 载入音效(句柄);
 }
 
 void 音频管理器::卸载音效(std::string_view 路径) {
-  auto it = _音效池.find(std::string(路径));
-  if (it != _音效池.end()) {
-    记录调试("卸载音效: {}", 路径);
-    _音效池.erase(it); // unique_ptr处理Mix_FreeChunk
+  // 只查找，不为从未载入过的路径分配句柄
+  if (auto *槽位 = 已载入槽位(_音效池, _路径表.查找(路径))) {
+    卸载槽位(*槽位, _音效预算, 路径); // unique_ptr处理Mix_FreeChunk
   } else {
     记录警告("尝试卸载不存在的音效: {}", 路径);
   }
 }
 
 void 音频管理器::清空音效池() {
-  if (!_音效池.empty()) {
-    记录调试("正在清除所有 {} 个缓存的音效。", _音效池.size());
-    _音效池.clear(); // unique_ptr处理删除
+  if (const auto 数量 = _音效预算.获取统计().驻留数量; 数量 > 0) {
+    记录调试("正在清除所有 {} 个缓存的音效。", 数量);
   }
+  _音效池.clear(); // unique_ptr处理删除
+  _音效预算.清空();
 }
 
+bool 音频管理器::增加音效引用(资源句柄 句柄) {
+  if (!载入音效(句柄)) {
+    return false;
+  }
+  取槽位(_音效池, 句柄).驻留.引用计数 += 1;
+  return true;
+}
+
+void 音频管理器::减少音效引用(资源句柄 句柄) { 减少引用(_音效池, 句柄); }
+
 // --- 音乐管理 ---
 Mix_Music *音频管理器::载入音乐(std::string_view 路径) {
+  return 载入音乐(_路径表.驻留(路径));
+}
+
+Mix_Music *音频管理器::载入音乐(资源句柄 句柄) {
+  if (!_路径表.有效(句柄)) {
+    记录错误("无效的资源句柄: {}", 句柄.序号);
+    return nullptr;
+  }
+
   // 首先检查缓存
-  auto it = _音乐池.find(std::string(路径));
-  if (it != _音乐池.end()) {
-    return it->second.get();
+  auto &槽位 = 取槽位(_音乐池, 句柄);
+  if (槽位.资源) {
+    _音乐预算.使用(槽位.驻留);
+    return 槽位.资源.get();
   }
 
   // 加载音乐
+  const auto &路径 = _路径表.路径(句柄);
   记录调试("加载音乐: {}", 路径);
-  Mix_Music *原始音乐 = Mix_LoadMUS(路径.data());
+  Mix_Music *原始音乐 = Mix_LoadMUS(路径.c_str());
   if (!原始音乐) {
     记录错误("加载音乐失败: '{}': {}", 路径, SDL_GetError());
     return nullptr;
   }
 
   // 使用unique_ptr存储在缓存中
-  _音乐池.emplace(路径,
-                  std::unique_ptr<Mix_Music, SDLMixMusic删除器>(原始音乐));
+  槽位.资源.reset(原始音乐);
+  _音乐预算.记录载入(槽位.驻留, 估算文件字节(路径));
   记录调试("成功加载并缓存音乐: {}", 路径);
   return 原始音乐;
 }
 
 Mix_Music *音频管理器::获取音乐(std::string_view 路径) {
-  auto it = _音乐池.find(std::string(路径));
-  if (it != _音乐池.end()) {
-    return it->second.get();
+  return 获取音乐(_路径表.驻留(路径));
+}
+
+Mix_Music *音频管理器::获取音乐(资源句柄 句柄) {
+  if (auto *槽位 = 已载入槽位(_音乐池, 句柄)) {
+    _音乐预算.使用(槽位->驻留);
+    return 槽位->资源.get();
+  }
+  if (_路径表.有效(句柄)) {
+    记录警告("音乐 '{}' 未找到缓存，尝试加载。", _路径表.路径(句柄));
   }
-  记录警告("音乐 '{}' 未找到缓存，尝试加载。", 路径);
-  return 载入音乐(路径);
+  return 载入音乐(句柄);
 }
 
 void 音频管理器::卸载音乐(std::string_view 路径) {
-  auto it = _音乐池.find(std::string(路径));
-  if (it != _音乐池.end()) {
-    记录调试("卸载音乐: {}", 路径);
-    _音乐池.erase(it); // unique_ptr处理Mix_FreeMusic
+  if (auto *槽位 = 已载入槽位(_音乐池, _路径表.查找(路径))) {
+    auto *音乐 = 槽位->资源.get();
+    if (卸载槽位(*槽位, _音乐预算, 路径) && 音乐 == _播放中音乐) { // unique_ptr处理Mix_FreeMusic
+      _播放中音乐 = nullptr;
+    }
   } else {
     记录警告("尝试卸载不存在的音乐: {}", 路径);
   }
 }
 
 void 音频管理器::清空音乐池() {
-  if (!_音乐池.empty()) {
-    记录调试("正在清除所有 {} 个缓存的音乐曲目。", _音乐池.size());
-    _音乐池.clear(); // unique_ptr处理删除
+  if (const auto 数量 = _音乐预算.获取统计().驻留数量; 数量 > 0) {
+    记录调试("正在清除所有 {} 个缓存的音乐曲目。", 数量);
+  }
+  _音乐池.clear(); // unique_ptr处理删除
+  _播放中音乐 = nullptr;
+  _音乐预算.清空();
+}
+
+bool 音频管理器::增加音乐引用(资源句柄 句柄) {
+  if (!载入音乐(句柄)) {
+    return false;
+  }
+  取槽位(_音乐池, 句柄).驻留.引用计数 += 1;
+  return true;
+}
+
+void 音频管理器::减少音乐引用(资源句柄 句柄) { 减少引用(_音乐池, 句柄); }
+
+bool 音频管理器::播放音乐(资源句柄 句柄, int 循环次数) {
+  auto *音乐 = 获取音乐(句柄);
+  if (!音乐) {
+    return false;
   }
+  if (!Mix_PlayMusic(音乐, 循环次数)) {
+    记录错误("播放音乐失败: {} (原因: {})", _路径表.路径(句柄), SDL_GetError());
+    return false;
+  }
+  _播放中音乐 = 音乐;
+  return true;
+}
+
+// --- 预算 ---
+void 音频管理器::回收() {
+  // 正在播放的音效由通道取得，释放它们会让通道读到已释放的采样
+  std::vector<Mix_Chunk *> 播放中音效;
+  if (_音效预算.超出预算()) {
+    const int 通道数 = Mix_AllocateChannels(-1);
+    for (int 通道 = 0; 通道 < 通道数; ++通道) {
+      if (Mix_Playing(通道)) {
+        播放中音效.push_back(Mix_GetChunk(通道));
+      }
+    }
+  }
+  回收池(_音效池, _音效预算, 播放中音效);
+
+  // SDL_mixer 无法查询当前音乐，只能保护经 播放音乐() 开始播放的那一首
+  if (_播放中音乐 && !Mix_PlayingMusic()) {
+    _播放中音乐 = nullptr;
+  }
+  std::vector<Mix_Music *> 播放中音乐;
+  if (_播放中音乐) {
+    播放中音乐.push_back(_播放中音乐);
+  }
+  回收池(_音乐池, _音乐预算, 播放中音乐);
+}
+
+void 音频管理器::设置音效预算(std::size_t 字节数) {
+  _音效预算.设置预算(字节数);
+}
+
+void 音频管理器::设置音乐预算(std::size_t 字节数) {
+  _音乐预算.设置预算(字节数);
+}
+
+const 资源池统计 &音频管理器::获取音效统计() const {
+  return _音效预算.获取统计();
+}
+
+const 资源池统计 &音频管理器::获取音乐统计() const {
+  return _音乐预算.获取统计();
 }
 
 void 音频管理器::清空音频池() {
@@ -3,7 +3,10 @@
 #include <stdexcept>     // 用于 std::runtime_error
 #include <string>        // 用于 std::string
 #include <string_view>   // 用于 std::string_view 路径
-#include <unordered_map> // 用于 std::unordered_map
+#include <vector>        // 用于 std::vector
+
+#include "资源句柄.hpp"
+#include "资源预算.hpp"
 
 #include <SDL3_mixer/SDL_mixer.h> // SDL_mixer 主头文件
 
@@ -37,19 +40,33 @@ private:
     }
   };
 
-  // 音效存储 (文件路径 -> Mix_Chunk)
-  std::unordered_map<std::string, std::unique_ptr<Mix_Chunk, SDLMixChunk删除器>>
-      _音效池;
-  // 音乐存储 (文件路径 -> Mix_Music)
-  std::unordered_map<std::string, std::unique_ptr<Mix_Music, SDLMixMusic删除器>>
-      _音乐池;
+  // 池中的一项：资源和它的记账信息
+  template <typename 资源类型, typename 删除器> struct 池项 {
+    std::unique_ptr<资源类型, 删除器> 资源;
+    驻留信息 驻留;
+  };
+  using 音效项 = 池项<Mix_Chunk, SDLMixChunk删除器>;
+  using 音乐项 = 池项<Mix_Music, SDLMixMusic删除器>;
+
+  // 音效存储 (资源句柄 -> Mix_Chunk)，句柄序号减一即为下标
+  std::vector<音效项> _音效池;
+  // 音乐存储 (资源句柄 -> Mix_Music)
+  std::vector<音乐项> _音乐池;
+
+  // 音效按解码后的采样字节数计算，音乐是流式播放，按文件大小估算
+  资源预算 _音效预算{128 * 1024 * 1024};
+  资源预算 _音乐预算{64 * 1024 * 1024};
+  // 最近一次经 播放音乐() 开始播放的音乐
+  Mix_Music *_播放中音乐 = nullptr;
+
+  路径驻留表 &_路径表; // 由 资源管理器 持有，各管理器共享
 
 public:
   /**
    * @brief 构造函数。初始化 SDL_mixer 并打开音频设备。
    * @throws std::runtime_error 如果 SDL_mixer 初始化或打开音频设备失败。
    */
-  音频管理器();
+  explicit 音频管理器(路径驻留表 &路径表);
 
   ~音频管理器(); //  需要手动添加析构函数，清理资源并关闭 SDL_mixer。
 
@@ -73,6 +90,28 @@ private: // 仅供 资源管理器 访问的方法
   void 清空音乐池();                    // 清空所有音乐资源
 
   void 清空音频池(); // 清空所有音频资源
+
+  // 按句柄访问，已载入时只做数组下标
+  Mix_Chunk *载入音效(资源句柄 句柄);
+  Mix_Chunk *获取音效(资源句柄 句柄);
+  Mix_Music *载入音乐(资源句柄 句柄);
+  Mix_Music *获取音乐(资源句柄 句柄);
+
+  // 引用计数大于 0 的资源不会被淘汰，正在播放的音乐应当保持引用
+  bool 增加音效引用(资源句柄 句柄);
+  void 减少音效引用(资源句柄 句柄);
+  bool 增加音乐引用(资源句柄 句柄);
+  void 减少音乐引用(资源句柄 句柄);
+
+  // 播放并记下这首音乐，回收() 不会淘汰正在播放的音乐
+  bool 播放音乐(资源句柄 句柄, int 循环次数);
+
+  // 超出预算时按最久未使用淘汰未被引用的音效和音乐，跳过正在播放的
+  void 回收();
+  void 设置音效预算(std::size_t 字节数);
+  void 设置音乐预算(std::size_t 字节数);
+  const 资源池统计 &获取音效统计() const;
+  const 资源池统计 &获取音乐统计() const;
 };
 
 } // namespace 引擎::资源
\ No newline at end of file